@@ -0,0 +1,58 @@
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#include <simgrid/s4u.hpp>
+#include <xbt/string.hpp>
+
+/* This example shows how to use simgrid::s4u::Engine::run_sweep() to run several variants of a simulation on the same
+ * platform, that is only loaded once. Each variant runs in its own process, forked once the platform is loaded: it
+ * applies its configuration changes, creates its actors and runs, before sending a report back to the main process.
+ *
+ * Here, the variants differ by the latency factor of the network model and by the size of the message sent.
+ * Note that the options that are used when the platform is created (such as the network model or its bandwidth
+ * factor) cannot be changed in the variants.
+ */
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_engine_sweep, "Messages specific for this s4u example");
+
+static double received_at = -1; // In the process of each variant
+
+static void sender(double size)
+{
+  simgrid::s4u::Mailbox::by_name("mailbox")->put(new double(size), static_cast<uint64_t>(size));
+}
+
+static void receiver()
+{
+  delete static_cast<double*>(simgrid::s4u::Mailbox::by_name("mailbox")->get());
+  received_at = simgrid::s4u::Engine::get_clock();
+}
+
+int main(int argc, char* argv[])
+{
+  simgrid::s4u::Engine e(&argc, argv);
+  xbt_assert(argc == 2, "Usage: %s platform_file\n\tExample: %s msg_platform.xml\n", argv[0], argv[0]);
+  e.load_platform(argv[1]);
+
+  const std::vector<double> sizes = {1e3, 1e6};
+  std::vector<std::vector<std::string>> variants;
+  for (const char* factor : {"1", "10"})
+    for (unsigned int i = 0; i < sizes.size(); i++)
+      variants.push_back({std::string("network/latency-factor:") + factor});
+
+  std::vector<std::string> reports = e.run_sweep(
+      variants,
+      [&sizes](unsigned int variant) {
+        simgrid::s4u::Actor::create("sender", simgrid::s4u::Host::by_name("Tremblay"), sender,
+                                    sizes[variant % sizes.size()]);
+        simgrid::s4u::Actor::create("receiver", simgrid::s4u::Host::by_name("Jupiter"), receiver);
+      },
+      [](unsigned int) { return simgrid::xbt::string_printf("received at %f", received_at); });
+
+  for (unsigned int variant = 0; variant < variants.size(); variant++)
+    XBT_INFO("%s, %g bytes: %s", variants[variant][0].c_str(), sizes[variant % sizes.size()],
+             reports[variant].c_str());
+  return 0;
+}
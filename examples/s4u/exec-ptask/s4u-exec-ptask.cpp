@@ -8,6 +8,7 @@
  *   - a vector of hosts on which the task will execute
  *   - a vector of values, the amount of computation for each of the hosts (in flops)
  *   - a matrix of values, the amount of communication between each pair of hosts (in bytes)
+ *     (or only its non-empty cells, as a vector of transfers, when most of the pairs do not communicate)
  *
  * Each of these operation will be processed at the same relative speed.
  * This means that at some point in time, all sub-executions and all sub-communications will be at 20% of completion.
@@ -71,6 +72,15 @@ static void runner()
   communication_amounts.clear();
   simgrid::s4u::this_actor::parallel_execute(hosts, computation_amounts, communication_amounts);
 
+  /* ------[ test 5 ]----------------- */
+  XBT_INFO("Finally, build the first parallel task again, giving only the pairs of hosts that communicate");
+  computation_amounts.assign(hosts_count, 1e9 /*1Gflop*/);
+  std::vector<simgrid::s4u::ParallelTransfer> transfers;
+  for (size_t i = 0; i < hosts_count; i++)
+    for (size_t j = i + 1; j < hosts_count; j++)
+      transfers.push_back({i, j, 1e7}); // 10 MB
+  simgrid::s4u::this_actor::parallel_execute(hosts, computation_amounts, transfers);
+
   XBT_INFO("Goodbye now!");
 }
 
@@ -135,6 +135,7 @@ namespace resource {
 class Action;
 class Cpu;
 class Model;
+struct ModelStatistics;
 class Resource;
 class CpuModel;
 class NetworkModel;
@@ -146,6 +147,7 @@ class StorageModel;
 }
 namespace routing {
 class ClusterCreationArgs;
+class ClusterZone;
 class LinkCreationArgs;
 class NetPoint;
 class NetZoneImpl;
@@ -6,13 +6,19 @@
 #ifndef SIMGRID_KERNEL_RESOURCE_ACTION_HPP
 #define SIMGRID_KERNEL_RESOURCE_ACTION_HPP
 
+#include <simgrid/config.h>
 #include <simgrid/forward.h>
 #include <xbt/signal.hpp>
 #include <xbt/utility.hpp>
 
+#include <boost/intrusive/list.hpp>
+#if !SIMGRID_HAVE_DARY_HEAP
 #include <boost/heap/pairing_heap.hpp>
 #include <boost/optional.hpp>
+#endif
+#include <limits>
 #include <string>
+#include <vector>
 
 static constexpr int NO_MAX_DURATION = -1.0;
 
@@ -20,13 +26,19 @@ namespace simgrid {
 namespace kernel {
 namespace resource {
 
+#if !SIMGRID_HAVE_DARY_HEAP
 typedef std::pair<double, simgrid::kernel::resource::Action*> heap_element_type;
 typedef boost::heap::pairing_heap<heap_element_type, boost::heap::constant_time_size<false>, boost::heap::stable<true>,
                                   boost::heap::compare<simgrid::xbt::HeapComparator<heap_element_type>>>
     heap_type;
+#endif
 
-typedef std::pair<double, simgrid::kernel::resource::Action*> heap_element_type;
-class XBT_PUBLIC ActionHeap : public heap_type {
+/** @brief The actions of a lazy model, sorted by the date of their next event
+ *
+ * Actions of the same date are sorted by the order of their insertion (or of their last update), so that the
+ * simulation does not depend on the heap implementation selected at configure time (see enable_dary_heap).
+ */
+class XBT_PUBLIC ActionHeap {
   friend Action;
 
 public:
@@ -37,11 +49,33 @@ public:
     unset
   };
 
+  bool empty() const { return heap_.empty(); }
   double top_date() const;
   void insert(Action* action, double date, ActionHeap::Type type);
   void update(Action* action, double date, ActionHeap::Type type);
   void remove(Action* action);
   Action* pop();
+
+private:
+#if SIMGRID_HAVE_DARY_HEAP
+  static constexpr std::size_t arity   = 4;
+  static constexpr std::size_t no_slot = std::numeric_limits<std::size_t>::max();
+  struct Entry {
+    double date;
+    unsigned long long rank; /* insertion order, to break the ties between actions of the same date */
+    Action* action;
+  };
+  static bool before(const Entry& a, const Entry& b) { return a.date < b.date || (a.date == b.date && a.rank < b.rank); }
+  void place(std::size_t slot, const Entry& entry);
+  void sift_up(std::size_t slot);
+  void sift_down(std::size_t slot);
+  void erase(std::size_t slot);
+
+  std::vector<Entry> heap_;
+  unsigned long long rank_ = 0;
+#else
+  heap_type heap_;
+#endif
 };
 
 /** @details An action is a consumption on a resource (e.g.: a communication for the network).
@@ -103,6 +137,13 @@ public:
 
   virtual ~Action();
 
+  /** @brief Allocate an action in the arena of its model (see Model::get_action_arena()): `new (model) MyAction(...)` */
+  static void* operator new(size_t size, Model* model);
+  /** The arena of the model is not thread-safe, so every action must be allocated with `new (model)` */
+  static void* operator new(size_t size) = delete;
+  static void operator delete(void* ptr);
+  static void operator delete(void* ptr, Model*) { operator delete(ptr); }
+
   /**
    * @brief Mark that the action is now finished
    *
@@ -151,7 +192,7 @@ public:
   virtual void update_remains_lazy(double now) = 0;
 
   /** @brief Set the remaining time of the current action */
-  void set_remains(double value) { remains_ = value; }
+  void set_remains(double value);
 
   /** @brief Get the remaining time of the current action after updating the resource */
   virtual double get_remains();
@@ -224,7 +265,11 @@ private:
   kernel::lmm::Variable* variable_                   = nullptr;
 
   ActionHeap::Type type_                              = ActionHeap::Type::unset;
-  boost::optional<ActionHeap::handle_type> heap_hook_ = boost::none;
+#if SIMGRID_HAVE_DARY_HEAP
+  std::size_t heap_slot_                              = ActionHeap::no_slot;
+#else
+  boost::optional<heap_type::handle_type> heap_hook_  = boost::none;
+#endif
 
 public:
   ActionHeap::Type get_type() const { return type_; }
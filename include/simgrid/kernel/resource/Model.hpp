@@ -8,11 +8,34 @@
 
 #include <memory>
 #include <simgrid/kernel/resource/Action.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+#include <xbt/slab_arena.hpp>
 
 namespace simgrid {
 namespace kernel {
 namespace resource {
 
+/** @brief Activity counters of a model and of its sharing system (see s4u::Engine::get_model_statistics()) */
+struct ModelStatistics {
+  std::string name;                        /**< Type of the model */
+  unsigned long long solves           = 0; /**< Solves of the sharing system */
+  unsigned long long rounds           = 0; /**< Saturation rounds of these solves */
+  unsigned long long constraints      = 0; /**< Constraints handed to these solves */
+  unsigned long long elements_visited = 0; /**< Elements (constraint/variable pairs) visited while saturating */
+  double solve_time                   = 0; /**< Seconds spent in these solves */
+  unsigned long long next_event_calls = 0; /**< Calls to Model::next_occuring_event() */
+  double next_event_time              = 0; /**< Seconds spent in Model::next_occuring_event() (solves included) */
+  unsigned long long update_calls     = 0; /**< Calls to Model::update_actions_state() */
+  double update_time                  = 0; /**< Seconds spent in Model::update_actions_state() */
+  unsigned long long next_event_skips = 0; /**< Polls answered without calling Model::next_occuring_event() */
+  unsigned long long update_skips     = 0; /**< Updates skipped because the model had no action to update */
+  unsigned long long route_cache_hits   = 0; /**< Routes found in the route cache of the engine */
+  unsigned long long route_cache_misses = 0; /**< Routes that had to be computed (and cached) */
+  unsigned long long analytic_communications = 0; /**< Communications simulated without the sharing system */
+};
+
 /** @ingroup SURF_interface
  * @brief SURF model interface class
  * @details A model is an object which handle the interactions between its Resources and its Actions
@@ -64,6 +87,9 @@ public:
   /** @brief Get Action heap */
   ActionHeap& get_action_heap() { return action_heap_; }
 
+  /** @brief Get the arena where the [actions](@ref Action) of this model are allocated */
+  xbt::SlabArena& get_action_arena() { return action_arena_; }
+
   /**
    * @brief Share the resources between the actions
    *
@@ -98,7 +124,48 @@ public:
    */
   virtual bool next_occuring_event_is_idempotent() { return true; }
 
+  /** @brief Returns whether next_occuring_event() and update_actions_state() only depend on the actions, the action
+   * heap and the sharing system of the model
+   *
+   * The next event of such a model is only recomputed when one of them changed since the previous computation, and
+   * the model is not updated at all while it has no started action.
+   */
+  virtual bool next_occuring_event_is_cacheable() { return false; }
+
+  /** @brief Get the delay until the next event of the model, calling next_occuring_event() only when it may have
+   * changed since the previous poll */
+  double poll_next_occuring_event(double now);
+  /** @brief Call update_actions_state() unless the model has nothing to update */
+  void poll_update_actions_state(double now, double delta);
+  /** @brief Notify the model that one of its actions changed, so that its next event gets recomputed */
+  void invalidate_next_event() { next_event_valid_ = false; }
+
+  /** @brief Returns whether next_occuring_event() and update_actions_state() only touch the actions, the action heap
+   * and the sharing system of the model, so that they can run on a worker thread (see surf/model-threads).
+   *
+   * The log categories of such models must be checked by the models_debug_enabled() function of surf_interface.cpp */
+  virtual bool is_independent() { return false; }
+
+  /** @brief Delay the state changes of the actions that finish until apply_deferred_state_changes()
+   *
+   * This is used while the model runs on a worker thread, as these state changes fire signals.
+   */
+  void defer_state_changes() { defer_state_changes_ = true; }
+  bool is_deferring_state_changes() const { return defer_state_changes_; }
+  void defer_state_change(Action* action, Action::State state) { deferred_state_changes_.emplace_back(action, state); }
+  /** @brief Apply the delayed state changes, in the order in which they were requested */
+  void apply_deferred_state_changes();
+
+  /** @brief Call next_occuring_event(), and account for it in the statistics of the model */
+  double timed_next_occuring_event(double now);
+  /** @brief Call update_actions_state(), and account for it in the statistics of the model */
+  void timed_update_actions_state(double now, double delta);
+
+  /** @brief Get the activity counters of the model and of its sharing system */
+  virtual ModelStatistics get_statistics() const;
+
 private:
+  xbt::SlabArena action_arena_{"actions"}; // first, so that it is destroyed after the actions of the model
   std::unique_ptr<lmm::System> maxmin_system_;
   const UpdateAlgo update_algorithm_;
   Action::StateSet inited_action_set_;   /**< Created not started */
@@ -108,6 +175,19 @@ private:
   Action::StateSet ignored_action_set_;  /**< not considered (failure detectors?) */
 
   ActionHeap action_heap_;
+
+  unsigned long long next_event_calls_ = 0;
+  double next_event_time_              = 0;
+  unsigned long long update_calls_     = 0;
+  double update_time_                  = 0;
+  unsigned long long next_event_skips_ = 0;
+  unsigned long long update_skips_     = 0;
+
+  bool next_event_valid_   = false; // whether next_event_delay_ is up to date (FULL models only)
+  double next_event_delay_ = -1.0;
+
+  bool defer_state_changes_ = false;
+  std::vector<std::pair<Action*, Action::State>> deferred_state_changes_;
 };
 
 } // namespace resource
@@ -7,8 +7,12 @@
 #define SIMGRID_ROUTING_CLUSTER_HPP_
 
 #include <simgrid/kernel/routing/NetZoneImpl.hpp>
+#include <xbt/asserts.h>
 
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace simgrid {
 namespace kernel {
@@ -68,7 +72,14 @@ namespace routing {
 class ClusterZone : public NetZoneImpl {
 public:
   explicit ClusterZone(NetZoneImpl* father, const std::string& name, resource::NetworkModel* netmodel);
+  ClusterZone(const ClusterZone&) = delete;
+  ClusterZone& operator=(const ClusterZone&) = delete;
+  ~ClusterZone() override;
 
+  int add_component(NetPoint* elm) override;
+  /** @brief Returns the hosts of the cluster, after creating its lazy nodes */
+  std::vector<s4u::Host*> get_all_hosts() override;
+  int get_host_count() override;
   void get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArgs* into, double* latency) override;
   void get_graph(xbt_graph_t graph, std::map<std::string, xbt_node_t>* nodes,
                  std::map<std::string, xbt_edge_t>* edges) override;
@@ -79,9 +90,37 @@ public:
     /* this routing method does not require any specific argument */
   }
 
-  /* We use a map instead of a std::vector here because that's a sparse vector. Some values may not exist */
-  /* The pair is {link_up, link_down} */
-  std::unordered_map<unsigned int, std::pair<kernel::resource::LinkImpl*, kernel::resource::LinkImpl*>> private_links_;
+  /** @brief Sets the private links {link_up, link_down} at that position, unless some are already set there */
+  void add_private_link_at(unsigned int position,
+                           std::pair<kernel::resource::LinkImpl*, kernel::resource::LinkImpl*> link);
+  bool private_link_exists_at(unsigned int position) const
+  {
+    return position < private_links_.size() && private_links_[position].first != nullptr;
+  }
+  /** @brief Returns the private links {link_up, link_down} at that position, that must exist */
+  const std::pair<kernel::resource::LinkImpl*, kernel::resource::LinkImpl*>&
+  get_private_link_at(unsigned int position) const
+  {
+    xbt_assert(private_link_exists_at(position), "No private link at position %u of the cluster %s", position,
+               get_cname());
+    return private_links_[position];
+  }
+
+  /** @brief Delays the creation of the nodes of the cluster until they are used (see routing/lazy-clusters)
+   *
+   * The ids of the nodes are reserved, so that each node gets the id of its rank in the cluster once created.
+   */
+  void set_lazy_nodes(const ClusterCreationArgs* cluster);
+  /** @brief Creates the node named so, if it is a node of the cluster that is not created yet. Returns whether it was
+   * created */
+  bool create_lazy_host(const std::string& name);
+  /** @brief Creates the node owning the private link named so, if it is not created yet. Returns whether it was
+   * created */
+  bool create_lazy_link(const std::string& name);
+  /** @brief Creates all the nodes of the cluster that are not created yet */
+  void create_all_lazy_nodes();
+  /** @brief Amount of nodes of the cluster that are not created yet */
+  unsigned int get_lazy_node_count() const { return lazy_count_; }
 
   unsigned int node_pos(int id) { return id * num_links_per_node_; }
   unsigned int node_pos_with_loopback(int id) { return node_pos(id) + (has_loopback_ ? 1 : 0); }
@@ -93,6 +132,21 @@ public:
   bool has_limiter_                = false;
   bool has_loopback_               = false;
   unsigned int num_links_per_node_ = 1; /* may be 1 (if only a private link), 2 or 3 (if limiter and loopback) */
+
+private:
+  /* The private links of the nodes, indexed by position (see node_pos()). The pair is {link_up, link_down}, with two
+   * nullptr at the positions without link. */
+  std::vector<std::pair<kernel::resource::LinkImpl*, kernel::resource::LinkImpl*>> private_links_;
+
+  /* The description of the nodes that are not created yet (see set_lazy_nodes()) */
+  ClusterCreationArgs* lazy_args_ = nullptr;
+  std::vector<bool> lazy_created_;                   // by rank
+  unsigned int lazy_count_ = 0;                      // amount of nodes not created yet
+  std::unordered_map<int, unsigned int> lazy_ranks_; // radical -> rank, only if the radicals are not increasing
+  int creating_rank_ = -1;                           // rank of the node being created, that gets it as id
+
+  bool find_lazy_rank(const std::string& radical, unsigned int* rank) const;
+  bool create_lazy_node(unsigned int rank);
 };
 } // namespace routing
 } // namespace kernel
@@ -8,10 +8,18 @@
 
 #include <simgrid/kernel/routing/RoutedZone.hpp>
 
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace simgrid {
 namespace kernel {
 namespace routing {
+class PairTable;
 
 /** @ingroup ROUTING_API
  *  @brief NetZone with an explicit routing computed on need with Dijsktra
@@ -21,6 +29,9 @@ namespace routing {
  *
  *  This result in rather small platform file, very fast initialization, and very low memory requirements, but somehow
  * long path resolution times.
+ *
+ *  The graph is stored as compressed sparse rows once the zone is sealed. With routing/dijkstra-precompute, the paths
+ *  from every source are computed at that time, in a table of predecessors.
  */
 class XBT_PRIVATE DijkstraZone : public RoutedZone {
 public:
@@ -31,9 +42,12 @@ public:
   ~DijkstraZone() override;
 
 private:
-  xbt_node_t route_graph_new_node(int id);
-  xbt_node_t node_map_search(int id);
+  unsigned int node_of(int netpoint_id);
   void new_edge(int src_id, int dst_id, RouteCreationArgs* e_route);
+  /** Computes the shortest paths from that node, as the (1 + index of the) edge leading to each node, or 0 */
+  void compute_predecessors(unsigned int src_node, std::uint32_t* pred_edges) const;
+  /** Returns the predecessors computed from that node, from the precomputed table or from the cache */
+  const std::uint32_t* get_predecessors(unsigned int src_node);
 
 public:
   /* For each vertex (node) already in the graph,
@@ -52,10 +66,29 @@ public:
   void add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, NetPoint* gw_dst,
                  std::vector<resource::LinkImpl*>& link_list, bool symmetrical) override;
 
-  xbt_graph_t route_graph_ = nullptr;          /* xbt_graph */
-  std::map<int, xbt_node_t> graph_node_map_;   /* map */
-  bool cached_;                                /* cache mode */
-  std::map<int, std::vector<int>> route_cache_; /* use in cache mode */
+private:
+  struct Edge {
+    unsigned int src;
+    unsigned int dst;
+    std::unique_ptr<RouteCreationArgs> route;
+  };
+  std::map<int, unsigned int> graph_node_map_;            /* netpoint id -> node, in order of appearance */
+  std::vector<Edge> edges_;                               /* in order of creation */
+  std::set<std::pair<unsigned int, unsigned int>> edge_set_; /* to detect the duplicated edges */
+
+  /* Compressed sparse rows of the graph: the edges leaving node i are at positions [edge_offsets_[i],
+   * edge_offsets_[i+1]) of the other arrays, in order of creation */
+  std::vector<unsigned int> edge_offsets_;
+  std::vector<unsigned int> edge_ids_;     /* index in edges_ */
+  std::vector<unsigned int> edge_targets_;
+  std::vector<unsigned int> edge_costs_;   /* count of links, old model assume 1 */
+
+  bool cached_;                           /* cache mode */
+  std::unique_ptr<PairTable> pred_table_; /* with routing/dijkstra-precompute */
+  /* The paths computed from each source in cache mode, the most recently used first */
+  std::list<std::pair<unsigned int, std::vector<std::uint32_t>>> route_cache_;
+  std::unordered_map<unsigned int, decltype(route_cache_)::iterator> route_cache_index_;
+  std::vector<std::uint32_t> pred_buffer_; /* without cache */
 };
 } // namespace routing
 } // namespace kernel
@@ -13,18 +13,6 @@ namespace simgrid {
 namespace kernel {
 namespace routing {
 
-class DragonflyRouter {
-public:
-  unsigned int group_;
-  unsigned int chassis_;
-  unsigned int blade_;
-  resource::LinkImpl* blue_link_ = nullptr;
-  std::vector<resource::LinkImpl*> black_links_;
-  std::vector<resource::LinkImpl*> green_links_;
-  std::vector<resource::LinkImpl*> my_nodes_;
-  DragonflyRouter(unsigned group, unsigned chassis, unsigned blade) : group_(group), chassis_(chassis), blade_(blade) {}
-};
-
 /** @ingroup ROUTING_API
  * @brief NetZone using a Dragonfly topology
  *
@@ -68,7 +56,11 @@ public:
   void rankId_to_coords(int rank_id, unsigned int coords[4]);
 
 private:
-  void generate_routers();
+  /** Index of the router of the given coordinates, where all links of this router are found */
+  unsigned int router_id(unsigned int group, unsigned int chassis, unsigned int blade) const
+  {
+    return (group * num_chassis_per_group_ + chassis) * num_blades_per_chassis_ + blade;
+  }
   void generate_links();
   void create_link(const std::string& id, int numlinks, resource::LinkImpl** linkup, resource::LinkImpl** linkdown);
 
@@ -84,7 +76,11 @@ private:
   unsigned int num_links_black_        = 0;
   unsigned int num_links_blue_         = 0;
   unsigned int num_links_per_link_     = 1; // splitduplex -> 2, only for local link
-  std::vector<DragonflyRouter> routers_;
+  /* The links of each router, in dense arrays indexed by router_id() */
+  std::vector<resource::LinkImpl*> node_links_;  // num_links_per_link_ per node of the blade (up first)
+  std::vector<resource::LinkImpl*> green_links_; // one per other blade of the chassis
+  std::vector<resource::LinkImpl*> black_links_; // one per other chassis of the group
+  std::vector<resource::LinkImpl*> blue_links_;  // only on the routers connected to another group
 };
 } // namespace routing
 } // namespace kernel
@@ -126,7 +126,7 @@ private:
   std::vector<unsigned int> num_parents_per_node_;  // number of parents by node
   std::vector<unsigned int> num_port_lower_level_;  // ports between each level l and l-1
 
-  std::map<int, FatTreeNode*> compute_nodes_;
+  std::vector<FatTreeNode*> compute_nodes_; // indexed by the id of their netpoint
   std::vector<FatTreeNode*> nodes_;
   std::vector<FatTreeLink*> links_;
   std::vector<unsigned int> nodes_by_level_;
@@ -138,7 +138,6 @@ private:
   void generate_labels();
   void generate_switches();
   int connect_node_to_parents(FatTreeNode* node);
-  bool are_related(FatTreeNode* parent, FatTreeNode* child);
   bool is_in_sub_tree(FatTreeNode* root, FatTreeNode* node);
 };
 } // namespace routing
@@ -8,9 +8,13 @@
 
 #include <simgrid/kernel/routing/RoutedZone.hpp>
 
+#include <memory>
+
 namespace simgrid {
 namespace kernel {
 namespace routing {
+class PairTable;
+class RouteStore;
 
 /** @ingroup ROUTING_API
  *  @brief NetZone with an explicit routing computed at initialization with Floyd-Warshal
@@ -20,6 +24,7 @@ namespace routing {
  *
  *  This result in rather small platform file, slow initialization time,  and intermediate memory requirements
  *  (somewhere between the one of @{DijkstraZone} and the one of @{FullZone}).
+ *  Only the predecessors and the 1-hop routes are kept after the initialization, in compact tables.
  */
 class XBT_PRIVATE FloydZone : public RoutedZone {
 public:
@@ -34,10 +39,11 @@ public:
   void seal() override;
 
 private:
+  void init_tables();
+
   /* vars to compute the Floyd algorithm. */
-  int* predecessor_table_;
-  double* cost_table_;
-  RouteCreationArgs** link_table_;
+  std::unique_ptr<PairTable> predecessor_table_; // 1 + predecessor of each pair, or 0
+  std::unique_ptr<RouteStore> link_table_;       // 1-hop routes
 };
 } // namespace routing
 } // namespace kernel
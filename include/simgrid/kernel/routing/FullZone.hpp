@@ -8,15 +8,19 @@
 
 #include <simgrid/kernel/routing/RoutedZone.hpp>
 
+#include <memory>
+
 namespace simgrid {
 namespace kernel {
 namespace routing {
+class RouteStore;
 
 /** @ingroup ROUTING_API
  *  @brief NetZone with an explicit routing provided by the user
  *
  *  The full communication matrix is provided at creation, so this model has the highest expressive power and the lowest
  *  computational requirements, but also the highest memory requirements (both in platform file and in memory).
+ *  The routes that go through the same links share their storage.
  */
 class XBT_PRIVATE FullZone : public RoutedZone {
 public:
@@ -31,7 +35,7 @@ public:
                  std::vector<resource::LinkImpl*>& link_list, bool symmetrical) override;
 
 private:
-  RouteCreationArgs** routing_table_ = nullptr;
+  std::unique_ptr<RouteStore> routes_;
 };
 } // namespace routing
 } // namespace kernel
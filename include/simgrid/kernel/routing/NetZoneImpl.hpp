@@ -17,6 +17,7 @@ namespace simgrid {
 namespace kernel {
 namespace routing {
 class BypassRoute;
+class RouteMemo;
 
 /** @ingroup ROUTING_API
  *  @brief Private implementation of the Networking Zones
@@ -87,6 +88,10 @@ protected:
   /* returns whether we found a bypass path */
   bool get_bypass_route(routing::NetPoint* src, routing::NetPoint* dst,
                         /* OUT */ std::vector<resource::LinkImpl*>& links, double* latency);
+  /** @brief Reserves the ids of components that get created later, with add_component_at() */
+  void reserve_components(unsigned int count) { vertices_.resize(vertices_.size() + count, nullptr); }
+  /** @brief Adds a component with an id that was reserved by reserve_components() */
+  int add_component_at(kernel::routing::NetPoint* elm, unsigned int id);
 
 public:
   resource::NetworkModel* network_model_;
@@ -98,6 +103,8 @@ private:
   std::vector<kernel::routing::NetPoint*> vertices_;
 
   NetZoneImpl* father_ = nullptr;
+  unsigned int depth_  = 0;             // distance to the root netzone
+  std::vector<NetZoneImpl*> ancestors_; // the ancestor at distance 2^i is ancestors_[i]
 
   std::vector<NetZoneImpl*> children_; // sub-netzones
 
@@ -106,6 +113,10 @@ public:
   std::vector<kernel::routing::NetPoint*> get_vertices() { return vertices_; }
 
   NetZoneImpl* get_father();
+  /** @brief Distance between this netzone and the root netzone */
+  unsigned int get_depth() const { return depth_; }
+  /** @brief Returns the ancestor at the given distance (the father at distance 1), in logarithmic time */
+  NetZoneImpl* get_ancestor(unsigned int distance);
 
   std::vector<NetZoneImpl*>* get_children(); // Sub netzones
 
@@ -119,8 +130,8 @@ public:
   /** @brief Retrieves the name of that netzone as a C string */
   const char* get_cname() const;
 
-  std::vector<s4u::Host*> get_all_hosts();
-  int get_host_count();
+  virtual std::vector<s4u::Host*> get_all_hosts();
+  virtual int get_host_count();
 
   /* @brief get the route between two nodes in the full platform
    *
@@ -131,6 +142,15 @@ public:
    */
   static void get_global_route(routing::NetPoint* src, routing::NetPoint* dst,
                                /* OUT */ std::vector<resource::LinkImpl*>& links, double* latency);
+  /** @brief The cache of the routes of the engine (see network/route-cache) */
+  static RouteMemo& get_route_memo();
+
+private:
+  friend RouteMemo;
+  static void compute_global_route(routing::NetPoint* src, routing::NetPoint* dst,
+                                   /* OUT */ std::vector<resource::LinkImpl*>& links, double* latency);
+
+public:
 
   virtual void get_graph(xbt_graph_t graph, std::map<std::string, xbt_node_t>* nodes,
                          std::map<std::string, xbt_edge_t>* edges) = 0;
@@ -312,6 +312,17 @@ public:
 #endif
 };
 
+/** \rst
+ * An entry of the sparse communication matrix of a :ref:`parallel execution <API_s4u_parallel_execute>`: ``bytes`` are
+ * sent from ``hosts[src]`` to ``hosts[dst]``.
+ * \endrst
+ */
+struct ParallelTransfer {
+  size_t src;
+  size_t dst;
+  double bytes;
+};
+
 /** @ingroup s4u_api
  *  @brief Static methods working on the current actor (see @ref s4u::Actor) */
 namespace this_actor {
@@ -385,6 +396,12 @@ XBT_PUBLIC void execute(double flop, double priority);
  * - From host1 to host0: 2 bytes are exchanged
  * - From host1 to host1: 3 bytes are exchanged
  *
+ * When most hosts do not communicate with each other, the communications are better given as a sparse matrix: a vector
+ * of :cpp:class:`ParallelTransfer`, only listing the pairs of hosts that exchange data. This is equivalent to the dense
+ * matrix, but it takes a time and a memory proportional to the amount of transfers instead of the square of the
+ * amount of hosts. The transfers between the same pair of hosts (that may appear several times in the list) share
+ * their route.
+ *
  * In a parallel execution, all parts (all executions on each hosts, all communications) progress exactly at the
  * same pace, so they all terminate at the exact same pace. If one part is slow because of a slow resource or
  * because of contention, this slows down the parallel execution as a whole.
@@ -406,6 +423,13 @@ XBT_PUBLIC void parallel_execute(const std::vector<s4u::Host*>& hosts, const std
 XBT_PUBLIC void parallel_execute(const std::vector<s4u::Host*>& hosts, const std::vector<double>& flops_amounts,
                                  const std::vector<double>& bytes_amounts, double timeout);
 
+/** \rst
+ * Block the current actor until the built :ref:`parallel execution <API_s4u_parallel_execute>` completes, or until the
+ * timeout (if positive). Its communications are given as a sparse matrix. \endrst
+ */
+XBT_PUBLIC void parallel_execute(const std::vector<s4u::Host*>& hosts, const std::vector<double>& flops_amounts,
+                                 const std::vector<ParallelTransfer>& transfers, double timeout = -1);
+
 #ifndef DOXYGEN
 XBT_ATTRIB_DEPRECATED_v325("Please use std::vectors as parameters") XBT_PUBLIC
     void parallel_execute(int host_nb, s4u::Host* const* host_list, const double* flops_amount,
@@ -418,6 +442,8 @@ XBT_ATTRIB_DEPRECATED_v325("Please use std::vectors as parameters") XBT_PUBLIC
 XBT_PUBLIC ExecPtr exec_init(double flops_amounts);
 XBT_PUBLIC ExecPtr exec_init(const std::vector<s4u::Host*>& hosts, const std::vector<double>& flops_amounts,
                              const std::vector<double>& bytes_amounts);
+XBT_PUBLIC ExecPtr exec_init(const std::vector<s4u::Host*>& hosts, const std::vector<double>& flops_amounts,
+                             const std::vector<ParallelTransfer>& transfers);
 
 XBT_PUBLIC ExecPtr exec_async(double flops_amounts);
 
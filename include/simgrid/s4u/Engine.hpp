@@ -39,6 +39,20 @@ public:
   /** @brief Run the simulation */
   void run();
 
+  /** @brief Run a simulation in a separate process for each variant, sharing the platform that is already loaded
+   *
+   * Each variant is a list of configuration changes such as "network/latency-factor:1.5". The process of a variant
+   * applies them, calls deploy(variant) to create the actors, runs the simulation, and sends the string returned by
+   * report(variant) back to this process. At most max_workers processes run at the same time (by default, one per
+   * core). No actor may exist yet, and no simulation may have run in this process: its pools of worker threads would
+   * not survive fork().
+   *
+   * @return the reports, in the order of the variants (empty for the variants whose process failed)
+   */
+  std::vector<std::string> run_sweep(const std::vector<std::vector<std::string>>& variants,
+                                     const std::function<void(unsigned int)>& deploy,
+                                     const std::function<std::string(unsigned int)>& report, int max_workers = 0);
+
   /** @brief Retrieve the simulation time (in seconds) */
   static double get_clock();
   /** @brief Retrieve the engine singleton */
@@ -88,6 +102,7 @@ protected:
   friend Host;
   friend Link;
   friend Storage;
+  friend kernel::routing::ClusterZone;
   friend kernel::routing::NetPoint;
   friend kernel::routing::NetZoneImpl;
   friend kernel::resource::LinkImpl;
@@ -142,6 +157,12 @@ public:
     return res;
   }
 
+  /** @brief Retrieves the activity counters of every resource model
+   *
+   * See kernel::resource::ModelStatistics (in simgrid/kernel/resource/Model.hpp) for the meaning of the counters.
+   */
+  std::vector<kernel::resource::ModelStatistics> get_model_statistics();
+
   /** Returns whether SimGrid was initialized yet -- mostly for internal use */
   static bool is_initialized();
   /** @brief set a configuration variable
@@ -155,6 +176,8 @@ public:
   void set_config(const std::string& str);
 
 private:
+  void create_all_lazy_nodes();
+
   kernel::EngineImpl* const pimpl;
   static Engine* instance_;
 };
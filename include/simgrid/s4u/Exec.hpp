@@ -93,8 +93,11 @@ class XBT_PUBLIC ExecPar : public Exec {
   std::vector<s4u::Host*> hosts_;
   std::vector<double> flops_amounts_;
   std::vector<double> bytes_amounts_;
+  std::vector<ParallelTransfer> transfers_;
   explicit ExecPar(const std::vector<s4u::Host*>& hosts, const std::vector<double>& flops_amounts,
                    const std::vector<double>& bytes_amounts);
+  explicit ExecPar(const std::vector<s4u::Host*>& hosts, const std::vector<double>& flops_amounts,
+                   const std::vector<ParallelTransfer>& transfers);
   ExecPtr set_host(Host*) override { /* parallel exec cannot be moved */ THROW_UNIMPLEMENTED; }
 
 public:
@@ -102,6 +105,9 @@ public:
   friend XBT_PUBLIC ExecPtr this_actor::exec_init(const std::vector<s4u::Host*>& hosts,
                                                   const std::vector<double>& flops_amounts,
                                                   const std::vector<double>& bytes_amounts);
+  friend XBT_PUBLIC ExecPtr this_actor::exec_init(const std::vector<s4u::Host*>& hosts,
+                                                  const std::vector<double>& flops_amounts,
+                                                  const std::vector<ParallelTransfer>& transfers);
   double get_remaining() override;
   double get_remaining_ratio() override;
   Exec* start() override;
@@ -0,0 +1,95 @@
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#ifndef SIMGRID_XBT_SLAB_ARENA_HPP
+#define SIMGRID_XBT_SLAB_ARENA_HPP
+
+#include <xbt/base.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace simgrid {
+namespace xbt {
+
+/** @brief Occupancy counters of a SlabArena */
+struct ArenaOccupancy {
+  std::size_t slabs    = 0; /**< Amount of slabs obtained from the system */
+  std::size_t bytes    = 0; /**< Memory held by these slabs */
+  std::size_t capacity = 0; /**< Amount of blocks that fit in these slabs */
+  std::size_t used     = 0; /**< Amount of blocks of the slabs that are currently handed out */
+  std::size_t peak     = 0; /**< Highest amount of blocks of the slabs handed out at the same time */
+  std::size_t outside  = 0; /**< Amount of blocks currently allocated outside of the slabs (too large, or model-checking) */
+};
+
+/** @brief Slab allocator for objects of a handful of sizes
+ *
+ * The blocks are carved out of large slabs and recycled through a free list per block size, so that allocating or
+ * releasing an object boils down to a couple of pointer moves. Each new slab of a given size is as large as all the
+ * previous ones together, so that the memory follows the observed peak of allocated blocks. Slabs are only given back
+ * to the system when the arena is destroyed.
+ *
+ * Every block is preceded by a small header pointing to the free list it comes from, so that deallocate() neither
+ * needs the arena nor the size of the block. Like the mallocators, the arena is bypassed when model-checking.
+ */
+class XBT_PUBLIC SlabArena {
+public:
+  /** Blocks larger than that are directly obtained from the system */
+  static constexpr std::size_t max_block_size = 4096;
+
+  /** @param name used in the debug messages
+   *  @param initial_blocks amount of blocks in the first slab of each block size */
+  explicit SlabArena(const std::string& name, std::size_t initial_blocks = 64);
+  SlabArena(const SlabArena&) = delete;
+  SlabArena& operator=(const SlabArena&) = delete;
+  ~SlabArena();
+
+  /** @brief Get a block of (at least) the given size, aligned as std::max_align_t */
+  void* allocate(std::size_t size);
+  /** @brief Give back a block obtained from allocate(), whatever the arena it comes from */
+  static void deallocate(void* block);
+
+  const std::string& get_name() const { return name_; }
+  ArenaOccupancy get_occupancy() const;
+
+private:
+  class SizeClass;
+  friend SizeClass;
+
+  std::string name_;
+  std::size_t initial_blocks_;
+  std::vector<std::unique_ptr<SizeClass>> size_classes_; // indexed by block size, created on need
+  std::unique_ptr<SizeClass> outside_;                   // blocks that are not carved out of the slabs
+  ArenaOccupancy occupancy_;
+};
+
+/** @brief Allocator of the standard library, getting its memory from a SlabArena
+ *
+ * The allocated arrays are not resized in place: it is mainly useful to containers of a fixed capacity.
+ */
+template <class T> class ArenaAllocator {
+  static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types cannot be allocated in a SlabArena");
+  SlabArena* arena_;
+
+public:
+  using value_type = T;
+
+  explicit ArenaAllocator(SlabArena& arena) noexcept : arena_(&arena) {}
+  template <class U> ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.get_arena()) {}
+
+  T* allocate(std::size_t n) { return static_cast<T*>(arena_->allocate(n * sizeof(T))); }
+  void deallocate(T* p, std::size_t) noexcept { SlabArena::deallocate(p); }
+
+  SlabArena* get_arena() const { return arena_; }
+  template <class U> bool operator==(const ArenaAllocator<U>& other) const { return arena_ == other.get_arena(); }
+  template <class U> bool operator!=(const ArenaAllocator<U>& other) const { return arena_ != other.get_arena(); }
+};
+
+} // namespace xbt
+} // namespace simgrid
+
+#endif
@@ -242,6 +242,8 @@ static void instr_host_on_speed_change(simgrid::s4u::Host const& host)
 static void instr_action_on_state_change(simgrid::kernel::resource::Action const& action,
                                          simgrid::kernel::resource::Action::State /* previous */)
 {
+  if (action.get_variable() == nullptr) // analytic communications do not use the bandwidth of the links
+    return;
   int n = action.get_variable()->get_number_of_constraint();
 
   for (int i = 0; i < n; i++) {
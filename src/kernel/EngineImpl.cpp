@@ -4,12 +4,15 @@
  * under the terms of the license (GNU LGPL) which comes with this package. */
 
 #include "src/kernel/EngineImpl.hpp"
+#include "simgrid/kernel/routing/ClusterZone.hpp"
 #include "simgrid/kernel/routing/NetPoint.hpp"
 #include "simgrid/kernel/routing/NetZoneImpl.hpp"
 #include "simgrid/s4u/Host.hpp"
 #include "src/surf/StorageImpl.hpp"
 #include "src/surf/network_interface.hpp"
 
+#include <algorithm>
+
 namespace simgrid {
 namespace kernel {
 
@@ -34,5 +37,31 @@ EngineImpl::~EngineImpl()
     if (kv.second)
       kv.second->get_impl()->destroy();
 }
+
+bool EngineImpl::create_lazy_host(const std::string& name)
+{
+  return std::any_of(lazy_clusters_.begin(), lazy_clusters_.end(),
+                     [&name](routing::ClusterZone* cluster) { return cluster->create_lazy_host(name); });
+}
+
+bool EngineImpl::create_lazy_link(const std::string& name)
+{
+  return std::any_of(lazy_clusters_.begin(), lazy_clusters_.end(),
+                     [&name](routing::ClusterZone* cluster) { return cluster->create_lazy_link(name); });
+}
+
+void EngineImpl::create_all_lazy_nodes()
+{
+  for (auto const& cluster : lazy_clusters_)
+    cluster->create_all_lazy_nodes();
+}
+
+size_t EngineImpl::get_lazy_node_count() const
+{
+  size_t count = 0;
+  for (auto const& cluster : lazy_clusters_)
+    count += cluster->get_lazy_node_count();
+  return count;
+}
 }
 }
@@ -5,9 +5,12 @@
 
 #include <simgrid/s4u/NetZone.hpp>
 
+#include "src/kernel/routing/RouteMemo.hpp"
+
 #include <map>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace simgrid {
 namespace kernel {
@@ -26,6 +29,17 @@ public:
   EngineImpl& operator=(const EngineImpl&) = delete;
   virtual ~EngineImpl();
   routing::NetZoneImpl* netzone_root_ = nullptr;
+  routing::RouteMemo route_memo_; // see network/route-cache
+  std::vector<routing::ClusterZone*> lazy_clusters_; // see routing/lazy-clusters
+
+  /** @brief Creates the lazy cluster node of that name, if any. Returns whether it was created */
+  bool create_lazy_host(const std::string& name);
+  /** @brief Creates the lazy cluster node owning the link of that name, if any. Returns whether it was created */
+  bool create_lazy_link(const std::string& name);
+  /** @brief Creates all the nodes of the lazy clusters that are not created yet */
+  void create_all_lazy_nodes();
+  /** @brief Amount of nodes of the lazy clusters that are not created yet */
+  size_t get_lazy_node_count() const;
 };
 
 } // namespace kernel
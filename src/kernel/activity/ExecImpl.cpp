@@ -135,6 +135,12 @@ ExecImpl& ExecImpl::set_bytes_amounts(const std::vector<double>& bytes_amounts)
   return *this;
 }
 
+ExecImpl& ExecImpl::set_transfers(const std::vector<s4u::ParallelTransfer>& transfers)
+{
+  transfers_ = transfers;
+  return *this;
+}
+
 ExecImpl* ExecImpl::start()
 {
   state_ = SIMIX_RUNNING;
@@ -146,6 +152,8 @@ ExecImpl* ExecImpl::start()
 
       if (bound_ > 0)
         surf_action_->set_bound(bound_);
+    } else if (not transfers_.empty()) {
+      surf_action_ = surf_host_model->execute_parallel(hosts_, flops_amounts_.data(), transfers_, -1);
     } else {
       surf_action_ = surf_host_model->execute_parallel(hosts_, flops_amounts_.data(), bytes_amounts_.data(), -1);
     }
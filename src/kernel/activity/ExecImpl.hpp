@@ -6,6 +6,7 @@
 #ifndef SIMIX_SYNCHRO_EXEC_HPP
 #define SIMIX_SYNCHRO_EXEC_HPP
 
+#include "simgrid/s4u/Actor.hpp"
 #include "src/kernel/activity/ActivityImpl.hpp"
 #include "src/kernel/context/Context.hpp"
 #include "surf/surf.hpp"
@@ -21,6 +22,7 @@ class XBT_PUBLIC ExecImpl : public ActivityImpl_T<ExecImpl> {
   std::vector<s4u::Host*> hosts_;
   std::vector<double> flops_amounts_;
   std::vector<double> bytes_amounts_;
+  std::vector<s4u::ParallelTransfer> transfers_; // sparse alternative to bytes_amounts_
   ~ExecImpl();
 
 public:
@@ -34,6 +36,7 @@ public:
 
   ExecImpl& set_flops_amounts(const std::vector<double>& flops_amounts);
   ExecImpl& set_bytes_amounts(const std::vector<double>& bytes_amounts);
+  ExecImpl& set_transfers(const std::vector<s4u::ParallelTransfer>& transfers);
   ExecImpl& set_hosts(const std::vector<s4u::Host*>& hosts);
 
   unsigned int get_host_number() const { return hosts_.size(); }
@@ -0,0 +1,379 @@
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#include "src/kernel/lmm/maxmin.hpp"
+#include "src/surf/surf_interface.hpp"
+#include "xbt/xbt_os_time.h"
+
+#include <algorithm>
+
+XBT_LOG_EXTERNAL_DEFAULT_CATEGORY(surf_maxmin);
+
+namespace simgrid {
+namespace kernel {
+namespace lmm {
+
+void CompactSystem::compact_solve()
+{
+  if (modified_) {
+    XBT_IN("(sys=%p)", this);
+    double start = xbt_os_time();
+    if (selective_update_active)
+      compact_solve(modified_constraint_set);
+    else
+      compact_solve(active_constraint_set);
+    statistics_.solves++;
+    statistics_.solve_time += xbt_os_time() - start;
+    XBT_OUT();
+  }
+}
+
+void CompactSystem::release(Variable* var)
+{
+  int slot = var->compact_index_;
+  if (slot < 0)
+    return;
+  size_t capacity = var->cnsts_.capacity();
+  std::fill(begin(elem_row_) + var_elem_begin_[slot], begin(elem_row_) + var_elem_begin_[slot] + capacity, -1);
+  var_[slot] = nullptr;
+  if (free_var_slots_.size() <= capacity)
+    free_var_slots_.resize(capacity + 1);
+  free_var_slots_[capacity].push_back(slot);
+  var->compact_index_ = -1;
+}
+
+void CompactSystem::release(Constraint* cnst)
+{
+  int row = cnst->compact_index_;
+  if (row < 0)
+    return;
+  row_cnst_[row] = nullptr;
+  row_used_ -= row_size_[row];
+  row_size_[row] = 0;
+  free_rows_.push_back(row);
+  cnst->compact_index_ = -1;
+}
+
+/* Returns the slot of the variable, after giving it one if needed */
+int CompactSystem::variable_slot(Variable* var)
+{
+  if (var->compact_index_ >= 0)
+    return var->compact_index_;
+
+  size_t capacity = var->cnsts_.capacity();
+  int slot;
+  if (capacity < free_var_slots_.size() && not free_var_slots_[capacity].empty()) {
+    slot = free_var_slots_[capacity].back();
+    free_var_slots_[capacity].pop_back();
+  } else {
+    slot = var_.size();
+    var_.push_back(nullptr);
+    var_elem_begin_.push_back(elem_var_.size());
+    var_elem_end_.push_back(elem_var_.size());
+    var_penalty_.push_back(0.0);
+    var_bound_.push_back(0.0);
+    var_value_.push_back(0.0);
+    var_saturated_.push_back(0);
+    var_solve_.push_back(0);
+    elem_var_.resize(elem_var_.size() + capacity, slot);
+    elem_row_.resize(elem_var_.size(), -1);
+    elem_weight_.resize(elem_var_.size(), 0.0);
+    elem_active_.resize(elem_var_.size(), 0);
+  }
+  var_[slot]          = var;
+  var->compact_index_ = slot;
+  return slot;
+}
+
+/* Copies the enabled elements of the constraint of that row into the row, moving the row if it does not fit anymore */
+void CompactSystem::rebuild_row(int row)
+{
+  const Constraint* cnst = row_cnst_[row];
+  int size               = cnst->enabled_element_set_.size();
+  if (size > row_capacity_[row]) {
+    row_begin_[row]    = row_elems_.size();
+    row_capacity_[row] = std::max(2 * size, 4);
+    row_elems_.resize(row_elems_.size() + row_capacity_[row]);
+  }
+  row_used_ += size - row_size_[row];
+  row_size_[row]    = size;
+  row_version_[row] = cnst->elements_version_;
+
+  int pos = row_begin_[row];
+  for (Element const& elem : cnst->enabled_element_set_) {
+    Variable* var       = elem.variable;
+    int slot            = variable_slot(var);
+    int index           = var_elem_begin_[slot] + (&elem - var->cnsts_.data());
+    elem_row_[index]    = row;
+    elem_weight_[index] = elem.consumption_weight;
+    row_elems_[pos++]   = index;
+  }
+}
+
+/* Moves the rows next to each other again, once most of row_elems_ was left behind by the rows that moved */
+void CompactSystem::compact_rows()
+{
+  std::vector<int> elems;
+  elems.reserve(2 * row_used_ + 4 * row_cnst_.size());
+  for (unsigned row = 0; row < row_cnst_.size(); row++) {
+    auto first         = begin(row_elems_) + row_begin_[row];
+    row_begin_[row]    = elems.size();
+    row_capacity_[row] = row_cnst_[row] ? std::max(2 * row_size_[row], 4) : 0;
+    elems.insert(end(elems), first, first + row_size_[row]);
+    elems.resize(row_begin_[row] + row_capacity_[row]);
+  }
+  row_elems_.swap(elems);
+}
+
+/* Add the active variables of the constraints to saturate to the saturated variables. Active elements are visited in
+ * the order of Constraint::active_element_set_ (i.e., reverse activation order) to fix the variables in the very same
+ * order as System::lmm_solve() does. */
+void CompactSystem::saturated_variable_set_update()
+{
+  for (int const& light : saturated_constraints_) {
+    int row = cnst_row_[light_cnst_[light]];
+    for (int pos = row_begin_[row] + row_size_[row] - 1; pos >= row_begin_[row]; pos--) {
+      int elem = row_elems_[pos];
+      int var  = elem_var_[elem];
+      if (elem_active_[elem] && elem_weight_[elem] > 0 && not var_saturated_[var]) {
+        var_saturated_[var] = 1;
+        saturated_variables_.push_back(var);
+      }
+    }
+  }
+}
+
+template <class CnstList> void CompactSystem::compact_solve(CnstList& cnst_list)
+{
+  XBT_DEBUG("Active constraints : %zu", cnst_list.size());
+  double start = xbt_os_time();
+
+  /* Bring the rows of the constraints to solve up to date */
+  cnst_row_.clear();
+  cnst_bound_.clear();
+  cnst_remaining_.clear();
+  cnst_usage_.clear();
+  cnst_fatpipe_.clear();
+  for (Constraint& cnst : cnst_list) {
+    if (cnst.compact_index_ < 0) {
+      if (free_rows_.empty()) {
+        cnst.compact_index_ = row_cnst_.size();
+        row_cnst_.push_back(nullptr);
+        row_version_.push_back(0);
+        row_begin_.push_back(row_elems_.size());
+        row_size_.push_back(0);
+        row_capacity_.push_back(0);
+        row_position_.push_back(-1);
+      } else {
+        cnst.compact_index_ = free_rows_.back();
+        free_rows_.pop_back();
+      }
+      row_cnst_[cnst.compact_index_] = &cnst;
+      rebuild_row(cnst.compact_index_);
+    } else if (row_version_[cnst.compact_index_] != cnst.elements_version_) {
+      rebuild_row(cnst.compact_index_);
+    }
+    row_position_[cnst.compact_index_] = cnst_row_.size();
+    cnst_row_.push_back(cnst.compact_index_);
+    cnst_bound_.push_back(cnst.bound_);
+    cnst_remaining_.push_back(cnst.bound_);
+    cnst_usage_.push_back(cnst.usage_);
+    cnst_fatpipe_.push_back(cnst.sharing_policy_ == s4u::Link::SharingPolicy::FATPIPE);
+  }
+  if (row_elems_.size() > 4 * row_used_ + 1024)
+    compact_rows();
+
+  /* Gather the variables of these constraints. The elements of a variable lying in a constraint that is not solved
+   * (there should be none) have no position and are ignored. */
+  solve_counter_++;
+  solved_vars_.clear();
+  for (int const& row : cnst_row_) {
+    for (int pos = row_begin_[row]; pos < row_begin_[row] + row_size_[row]; pos++) {
+      int elem           = row_elems_[pos];
+      int var            = elem_var_[elem];
+      elem_active_[elem] = 0;
+      if (var_solve_[var] != solve_counter_) {
+        const Variable* variable = var_[var];
+        xbt_assert(variable->sharing_penalty_ > 0.0);
+        var_solve_[var]     = solve_counter_;
+        var_elem_end_[var]  = var_elem_begin_[var] + variable->cnsts_.size();
+        var_penalty_[var]   = variable->sharing_penalty_;
+        var_bound_[var]     = variable->bound_;
+        var_value_[var]     = 0.0;
+        var_saturated_[var] = 0;
+        solved_vars_.push_back(var);
+      }
+    }
+  }
+  statistics_.conversion_time += xbt_os_time() - start;
+
+  int cnst_amount = cnst_row_.size();
+  statistics_.constraints += cnst_amount;
+  cnst_light_index_.assign(cnst_amount, -1);
+  cnst_active_amount_.assign(cnst_amount, 0);
+
+  light_cnst_.clear();
+  light_remaining_over_usage_.clear();
+  light_heap_.clear();
+  light_heap_.reserve(cnst_amount);
+  saturated_constraints_.clear();
+  saturated_variables_.clear();
+
+  auto remove_light = [this](int cnst) {
+    int index = cnst_light_index_[cnst];
+    if (index < 0)
+      return;
+    light_cnst_[index]                    = light_cnst_.back();
+    light_remaining_over_usage_[index]    = light_remaining_over_usage_.back();
+    cnst_light_index_[light_cnst_[index]] = index;
+    light_cnst_.pop_back();
+    light_remaining_over_usage_.pop_back();
+    cnst_light_index_[cnst] = -1;
+    light_heap_.remove(index);
+  };
+  auto make_inactive = [this](int cnst, int elem) {
+    if (elem_active_[elem]) {
+      elem_active_[elem] = 0;
+      cnst_active_amount_[cnst]--;
+    }
+  };
+  auto find_saturated_constraints = [this]() {
+    double min_usage = light_heap_.get_minimums(saturated_constraints_);
+    for (int const& pos : saturated_constraints_)
+      xbt_assert(cnst_active_amount_[light_cnst_[pos]] > 0,
+                 "Cannot saturate more a constraint that has no active element! You may want to change the maxmin "
+                 "precision (--cfg=maxmin/precision:<new_value>) because of possible rounding effects.");
+    return min_usage;
+  };
+
+  /* INIT: Collect constraints that actually need to be saturated (i.e remaining and usage are strictly positive) */
+  for (int cnst = 0; cnst < cnst_amount; cnst++) {
+    if (not double_positive(cnst_remaining_[cnst], cnst_bound_[cnst] * sg_maxmin_precision))
+      continue;
+    double usage = 0;
+    int row = cnst_row_[cnst];
+    statistics_.elements_visited += row_size_[row];
+    for (int pos = row_begin_[row]; pos < row_begin_[row] + row_size_[row]; pos++) {
+      int elem = row_elems_[pos];
+      if (elem_weight_[elem] > 0) {
+        double share = elem_weight_[elem] / var_penalty_[elem_var_[elem]];
+        if (not cnst_fatpipe_[cnst])
+          usage += share;
+        else if (usage < share)
+          usage = share;
+
+        elem_active_[elem] = 1;
+        cnst_active_amount_[cnst]++;
+        resource::Action* action = static_cast<resource::Action*>(var_[elem_var_[elem]]->id_);
+        if (modified_set_ && not action->is_within_modified_set())
+          modified_set_->push_back(*action);
+      }
+    }
+    cnst_usage_[cnst] = usage;
+    if (usage > 0) {
+      cnst_light_index_[cnst] = light_cnst_.size();
+      light_cnst_.push_back(cnst);
+      light_remaining_over_usage_.push_back(cnst_remaining_[cnst] / usage);
+      light_heap_.push(light_remaining_over_usage_.back());
+    }
+  }
+
+  double min_usage = find_saturated_constraints();
+  double min_bound = -1;
+  saturated_variable_set_update();
+
+  /* Saturated variables update */
+  do {
+    statistics_.rounds++;
+    /* First check if some of these variables could reach their upper bound and update min_bound accordingly. */
+    for (int const& var : saturated_variables_) {
+      double bound = var_bound_[var] * var_penalty_[var];
+      if (var_bound_[var] > 0 && bound < min_usage)
+        min_bound = (min_bound < 0) ? bound : std::min(min_bound, bound);
+    }
+
+    /* Fix the variables that have to be */
+    for (int const& var : saturated_variables_) {
+      var_saturated_[var] = 0;
+      if (min_bound < 0) {
+        var_value_[var] = min_usage / var_penalty_[var];
+      } else if (double_equals(min_bound, var_bound_[var] * var_penalty_[var], sg_maxmin_precision)) {
+        var_value_[var] = var_bound_[var];
+      } else {
+        // Variables which bound is different are not considered for this cycle, but they will be afterwards.
+        continue;
+      }
+
+      /* Update the usage of contraints where this variable is involved */
+      statistics_.elements_visited += var_elem_end_[var] - var_elem_begin_[var];
+      for (int elem = var_elem_begin_[var]; elem < var_elem_end_[var]; elem++) {
+        int cnst = elem_row_[elem] < 0 ? -1 : row_position_[elem_row_[elem]];
+        if (cnst < 0)
+          continue;
+        if (not cnst_fatpipe_[cnst]) {
+          // Remember: shared constraints require that sum(elem.value * var.value) < cnst->bound
+          double_update(&cnst_remaining_[cnst], elem_weight_[elem] * var_value_[var],
+                        cnst_bound_[cnst] * sg_maxmin_precision);
+          double_update(&cnst_usage_[cnst], elem_weight_[elem] / var_penalty_[var], sg_maxmin_precision);
+          make_inactive(cnst, elem);
+        } else {
+          // Remember: non-shared constraints only require that max(elem.value * var.value) < cnst->bound
+          make_inactive(cnst, elem);
+          double usage = 0.0;
+          int row = cnst_row_[cnst];
+          statistics_.elements_visited += row_size_[row];
+          for (int pos = row_begin_[row]; pos < row_begin_[row] + row_size_[row]; pos++) {
+            int elem2 = row_elems_[pos];
+            if (var_value_[elem_var_[elem2]] > 0)
+              continue;
+            if (elem_weight_[elem2] > 0)
+              usage = std::max(usage, elem_weight_[elem2] / var_penalty_[elem_var_[elem2]]);
+          }
+          cnst_usage_[cnst] = usage;
+        }
+        // If the constraint is saturated, remove it from the set of active constraints (light table)
+        if (not double_positive(cnst_usage_[cnst], sg_maxmin_precision) ||
+            not double_positive(cnst_remaining_[cnst], cnst_bound_[cnst] * sg_maxmin_precision)) {
+          remove_light(cnst);
+        } else if (cnst_light_index_[cnst] >= 0) {
+          light_remaining_over_usage_[cnst_light_index_[cnst]] = cnst_remaining_[cnst] / cnst_usage_[cnst];
+          light_heap_.update(cnst_light_index_[cnst], light_remaining_over_usage_[cnst_light_index_[cnst]]);
+          xbt_assert(not cnst_fatpipe_[cnst] || cnst_active_amount_[cnst] > 0,
+                     "Should not keep a maximum constraint that has no active element! You want to check the maxmin "
+                     "precision and possible rounding effects.");
+        }
+      }
+    }
+    saturated_variables_.clear();
+
+    /* Find out which variables reach the maximum */
+    min_usage = find_saturated_constraints();
+    min_bound = -1;
+    saturated_variable_set_update();
+  } while (not light_cnst_.empty());
+
+  /* Copy the results back */
+  for (int const& var : solved_vars_)
+    var_[var]->value_ = var_value_[var];
+  for (int cnst = 0; cnst < cnst_amount; cnst++) {
+    int row                    = cnst_row_[cnst];
+    row_cnst_[row]->remaining_ = cnst_remaining_[cnst];
+    row_cnst_[row]->usage_     = cnst_usage_[cnst];
+    row_position_[row]         = -1;
+  }
+
+  modified_ = false;
+  if (selective_update_active)
+    remove_all_modified_set();
+
+  if (XBT_LOG_ISENABLED(surf_maxmin, xbt_log_priority_debug)) {
+    print();
+  }
+
+  check_concurrency();
+}
+}
+}
+}
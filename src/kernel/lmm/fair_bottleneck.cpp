@@ -6,6 +6,7 @@
 #include "src/kernel/lmm/maxmin.hpp"
 #include "src/surf/surf_interface.hpp"
 #include "xbt/sysdep.h"
+#include "xbt/xbt_os_time.h"
 
 #include <algorithm>
 #include <cfloat>
@@ -20,35 +21,66 @@ simgrid::kernel::lmm::System* simgrid::kernel::lmm::make_new_fair_bottleneck_sys
   return new simgrid::kernel::lmm::FairBottleneck(selective_update);
 }
 
+/* Account for a variable that stopped growing: its last increment keeps being consumed on its constraints */
+void simgrid::kernel::lmm::FairBottleneck::freeze_variable(const Variable& var)
+{
+  statistics_.elements_visited += var.cnsts_.size();
+  for (Element const& elem : var.cnsts_) {
+    BottleneckState& state = cnst_state_[elem.constraint->compact_index_];
+    double consumption     = elem.consumption_weight * var.mu_;
+    if (elem.consumption_weight > 0)
+      state.nb_variables--;
+    state.stale_sum += consumption;
+    state.stale_min = std::min(state.stale_min, consumption);
+  }
+}
+
 void simgrid::kernel::lmm::FairBottleneck::bottleneck_solve()
 {
   if (not modified_)
     return;
+  double start = xbt_os_time();
+
+  XBT_DEBUG("Active constraints : %zu", active_constraint_set.size());
+  statistics_.constraints += active_constraint_set.size();
+  cnst_state_.clear();
+  for (Constraint& cnst : active_constraint_set) {
+    saturated_constraint_set.push_back(cnst);
+    cnst.remaining_     = cnst.bound_;
+    cnst.usage_         = 0.0;
+    cnst.compact_index_ = cnst_state_.size();
+    cnst_state_.push_back({&cnst, 0, 0.0, DBL_MAX, 0.0, DBL_MAX});
+  }
 
   XBT_DEBUG("Variable set : %zu", variable_set.size());
   for (Variable& var : variable_set) {
     var.value_ = 0.0;
     XBT_DEBUG("Handling variable %p", &var);
-    if (var.sharing_penalty_ > 0.0 && std::find_if(begin(var.cnsts_), end(var.cnsts_), [](Element const& x) {
-                                        return x.consumption_weight != 0.0;
-                                      }) != end(var.cnsts_)) {
+    if (var.sharing_penalty_ <= 0.0)
+      continue;
+    statistics_.elements_visited += var.cnsts_.size();
+    for (Element const& elem : var.cnsts_) {
+      // An enabled variable may use an inactive constraint, that is not solved but still gathers the consumption
+      if (elem.constraint->compact_index_ < 0) {
+        elem.constraint->compact_index_ = cnst_state_.size();
+        cnst_state_.push_back({elem.constraint, 0, 0.0, DBL_MAX, 0.0, DBL_MAX});
+      }
+    }
+    if (std::find_if(begin(var.cnsts_), end(var.cnsts_), [](Element const& x) {
+          return x.consumption_weight != 0.0;
+        }) != end(var.cnsts_)) {
       saturated_variable_set.push_back(var);
+      for (Element const& elem : var.cnsts_) {
+        if (elem.consumption_weight > 0)
+          cnst_state_[elem.constraint->compact_index_].nb_variables++;
+      }
     } else {
       XBT_DEBUG("Err, finally, there is no need to take care of variable %p", &var);
-      if (var.sharing_penalty_ > 0.0)
-        var.value_ = 1.0;
+      var.value_ = 1.0;
+      freeze_variable(var); // its elements are enabled, so they count in the consumption of the constraints
     }
   }
 
-  XBT_DEBUG("Active constraints : %zu", active_constraint_set.size());
-  for (Constraint& cnst : active_constraint_set) {
-    saturated_constraint_set.push_back(cnst);
-  }
-  for (Constraint& cnst : saturated_constraint_set) {
-    cnst.remaining_ = cnst.bound_;
-    cnst.usage_     = 0.0;
-  }
-
   XBT_DEBUG("Fair bottleneck Initialized");
 
   /*
@@ -57,22 +89,17 @@ void simgrid::kernel::lmm::FairBottleneck::bottleneck_solve()
   auto& var_list  = saturated_variable_set;
   auto& cnst_list = saturated_constraint_set;
   do {
+    statistics_.rounds++;
     if (XBT_LOG_ISENABLED(surf_maxmin, xbt_log_priority_debug)) {
       XBT_DEBUG("Fair bottleneck done");
       print();
     }
     XBT_DEBUG("******* Constraints to process: %zu *******", cnst_list.size());
     for (auto iter = std::begin(cnst_list); iter != std::end(cnst_list);) {
-      Constraint& cnst = *iter;
-      int nb = 0;
-      XBT_DEBUG("Processing cnst %p ", &cnst);
-      cnst.usage_ = 0.0;
-      for (Element& elem : cnst.enabled_element_set_) {
-        xbt_assert(elem.variable->sharing_penalty_ > 0);
-        if (elem.consumption_weight > 0 && elem.variable->saturated_variable_set_hook_.is_linked())
-          nb++;
-      }
-      XBT_DEBUG("\tThere are %d variables", nb);
+      Constraint& cnst       = *iter;
+      BottleneckState& state = cnst_state_[cnst.compact_index_];
+      int nb                 = state.nb_variables;
+      XBT_DEBUG("Processing cnst %p: there are %d variables", &cnst, nb);
       if (nb > 0 && cnst.sharing_policy_ == s4u::Link::SharingPolicy::FATPIPE)
         nb = 1;
       if (nb == 0) {
@@ -82,6 +109,8 @@ void simgrid::kernel::lmm::FairBottleneck::bottleneck_solve()
       } else {
         cnst.usage_ = cnst.remaining_ / nb;
         XBT_DEBUG("\tConstraint Usage %p : %f with %d variables", &cnst, cnst.usage_, nb);
+        state.round_sum = 0.0;
+        state.round_min = cnst.usage_;
         iter++;
       }
     }
@@ -89,6 +118,7 @@ void simgrid::kernel::lmm::FairBottleneck::bottleneck_solve()
     for (auto iter = std::begin(var_list); iter != std::end(var_list);) {
       Variable& var  = *iter;
       double min_inc = DBL_MAX;
+      statistics_.elements_visited += 2 * var.cnsts_.size();
       for (Element const& elm : var.cnsts_) {
         if (elm.consumption_weight > 0)
           min_inc = std::min(min_inc, elm.constraint->usage_ / elm.consumption_weight);
@@ -98,30 +128,29 @@ void simgrid::kernel::lmm::FairBottleneck::bottleneck_solve()
       var.mu_ = min_inc;
       XBT_DEBUG("Updating variable %p maximum increment: %g", &var, var.mu_);
       var.value_ += var.mu_;
-      if (var.value_ == var.bound_)
+      for (Element const& elm : var.cnsts_) {
+        BottleneckState& state = cnst_state_[elm.constraint->compact_index_];
+        double consumption     = elm.consumption_weight * var.mu_;
+        state.round_sum += consumption;
+        state.round_min = std::min(state.round_min, consumption);
+      }
+      if (var.value_ == var.bound_) {
         iter = var_list.erase(iter);
-      else
+        frozen_.push_back(&var);
+      } else {
         iter++;
+      }
     }
 
     for (auto iter = std::begin(cnst_list); iter != std::end(cnst_list);) {
-      Constraint& cnst = *iter;
-      XBT_DEBUG("Updating cnst %p ", &cnst);
+      Constraint& cnst             = *iter;
+      BottleneckState const& state = cnst_state_[cnst.compact_index_];
       if (cnst.sharing_policy_ != s4u::Link::SharingPolicy::FATPIPE) {
-        for (Element& elem : cnst.enabled_element_set_) {
-          xbt_assert(elem.variable->sharing_penalty_ > 0);
-          XBT_DEBUG("\tUpdate constraint %p (%g) with variable %p by %g", &cnst, cnst.remaining_, elem.variable,
-                    elem.variable->mu_);
-          double_update(&cnst.remaining_, elem.consumption_weight * elem.variable->mu_, sg_maxmin_precision);
-        }
+        XBT_DEBUG("\tUpdate constraint %p (%g) by %g", &cnst, cnst.remaining_, state.stale_sum + state.round_sum);
+        double_update(&cnst.remaining_, state.stale_sum + state.round_sum, sg_maxmin_precision);
       } else {
-        for (Element& elem : cnst.enabled_element_set_) {
-          xbt_assert(elem.variable->sharing_penalty_ > 0);
-          XBT_DEBUG("\tNon-Shared variable. Update constraint usage of %p (%g) with variable %p by %g", &cnst,
-                    cnst.usage_, elem.variable, elem.variable->mu_);
-          cnst.usage_ = std::min(cnst.usage_, elem.consumption_weight * elem.variable->mu_);
-        }
-        XBT_DEBUG("\tUpdate constraint %p (%g) by %g", &cnst, cnst.remaining_, cnst.usage_);
+        cnst.usage_ = std::min(state.round_min, state.stale_min);
+        XBT_DEBUG("\tNon-Shared constraint. Update constraint %p (%g) by %g", &cnst, cnst.remaining_, cnst.usage_);
         double_update(&cnst.remaining_, cnst.usage_, sg_maxmin_precision);
       }
 
@@ -130,22 +159,33 @@ void simgrid::kernel::lmm::FairBottleneck::bottleneck_solve()
         XBT_DEBUG("\tGet rid of constraint %p", &cnst);
 
         iter = cnst_list.erase(iter);
+        statistics_.elements_visited += cnst.enabled_element_set_.size();
         for (Element& elem : cnst.enabled_element_set_) {
           if (elem.variable->sharing_penalty_ <= 0)
             break;
           if (elem.consumption_weight > 0 && elem.variable->saturated_variable_set_hook_.is_linked()) {
             XBT_DEBUG("\t\tGet rid of variable %p", elem.variable);
             simgrid::xbt::intrusive_erase(var_list, *elem.variable);
+            frozen_.push_back(elem.variable);
           }
         }
       } else {
         iter++;
       }
     }
+
+    /* The consumption of the variables that stopped growing during this round only changes the next rounds */
+    for (Variable const* var : frozen_)
+      freeze_variable(*var);
+    frozen_.clear();
   } while (not var_list.empty());
 
   cnst_list.clear();
+  for (BottleneckState const& state : cnst_state_)
+    state.cnst->compact_index_ = -1;
   modified_ = true;
+  statistics_.solves++;
+  statistics_.solve_time += xbt_os_time() - start;
   if (XBT_LOG_ISENABLED(surf_maxmin, xbt_log_priority_debug)) {
     XBT_DEBUG("Fair bottleneck done");
     print();
@@ -4,26 +4,43 @@
  * under the terms of the license (GNU LGPL) which comes with this package. */
 
 #include "src/kernel/lmm/maxmin.hpp"
+#include "src/include/xbt/parmap.hpp"
 #include "src/surf/surf_interface.hpp"
 #include "xbt/backtrace.hpp"
+#include "xbt/config.hpp"
+#include "xbt/xbt_os_time.h"
+
+#include <algorithm>
+#include <boost/range/adaptor/indirected.hpp>
+#include <unordered_map>
 
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(surf_maxmin, surf, "Logging specific to SURF (maxmin)");
 
 double sg_maxmin_precision = 0.00001; /* Change this with --cfg=maxmin/precision:VALUE */
 double sg_surf_precision   = 0.00001; /* Change this with --cfg=surf/precision:VALUE */
 int sg_concurrency_limit   = -1;      /* Change this with --cfg=maxmin/concurrency-limit:VALUE */
+bool sg_maxmin_components  = false;   /* Change this with --cfg=maxmin/components:yes */
+int sg_maxmin_threads      = 1;       /* Change this with --cfg=maxmin/threads:VALUE */
 
 namespace simgrid {
 namespace kernel {
 namespace lmm {
 
-typedef std::vector<int> dyn_light_t;
-
 int Variable::next_rank_   = 1;
 int Constraint::next_rank_ = 1;
 
+static simgrid::config::Flag<std::string> cfg_maxmin_backend{
+    "maxmin/backend",
+    "Data layout used to solve the maxmin systems",
+    "default",
+    {{"default", "Constraints, variables and elements linked together through intrusive lists"},
+     {"compact", "Copy the system into contiguous arrays (compressed sparse rows) before each solve"}},
+    [](const std::string&) {}};
+
 System* make_new_maxmin_system(bool selective_update)
 {
+  if (cfg_maxmin_backend.get() == "compact")
+    return new CompactSystem(selective_update);
   return new System(selective_update);
 }
 
@@ -110,14 +127,23 @@ void System::var_free(Variable* var)
 
   // TODOLATER Can do better than that by leaving only the variable in only one enabled_element_set, call
   // update_modified_set, and then remove it..
-  if (not var->cnsts_.empty())
-    update_modified_set(var->cnsts_[0].constraint);
+  update_modified_set(var);
+
+  // Removing a variable that links several constraints may split their component: only that one is checked again
+  if (var->cnsts_.size() > 1) {
+    if (solve_components_ && not components_dirty_)
+      split_components_.push_back(var->cnsts_[0].constraint);
+    else
+      components_dirty_ = true;
+  }
 
   for (Element& elem : var->cnsts_) {
     if (var->sharing_penalty_ > 0)
       elem.decrease_concurrency();
-    if (elem.enabled_element_set_hook.is_linked())
+    if (elem.enabled_element_set_hook.is_linked()) {
       simgrid::xbt::intrusive_erase(elem.constraint->enabled_element_set_, elem);
+      elem.constraint->elements_version_++;
+    }
     if (elem.disabled_element_set_hook.is_linked())
       simgrid::xbt::intrusive_erase(elem.constraint->disabled_element_set_, elem);
     if (elem.active_element_set_hook.is_linked())
@@ -133,7 +159,9 @@ void System::var_free(Variable* var)
 
   check_concurrency();
 
-  xbt_mallocator_release(variable_mallocator_, var);
+  release(var);
+  var->~Variable();
+  xbt::SlabArena::deallocate(var);
   XBT_OUT();
 }
 
@@ -143,6 +171,8 @@ System::System(bool selective_update) : selective_update_active(selective_update
 
   if (selective_update)
     modified_set_ = new kernel::resource::Action::ModifiedSet();
+
+  set_solve_components(sg_maxmin_components, sg_maxmin_threads);
 }
 
 System::~System()
@@ -159,13 +189,16 @@ System::~System()
   while ((cnst = extract_constraint()))
     cnst_free(cnst);
 
-  xbt_mallocator_free(variable_mallocator_);
   delete modified_set_;
 }
 
 void System::cnst_free(Constraint* cnst)
 {
+  release(cnst);
   make_constraint_inactive(cnst);
+  components_dirty_ = true;
+  changed_constraints_.erase(std::remove(begin(changed_constraints_), end(changed_constraints_), cnst),
+                             end(changed_constraints_));
   delete cnst;
 }
 
@@ -182,7 +215,11 @@ Constraint::Constraint(resource::Resource* id_value, double bound_value) : bound
 
   lambda_     = 0.0;
   new_lambda_ = 0.0;
-  cnst_light_ = nullptr;
+  cnst_light_       = nullptr;
+  component_        = this;
+  component_next_   = this;
+  compact_index_    = -1;
+  elements_version_ = 0;
 }
 
 Constraint* System::constraint_new(resource::Resource* id, double bound_value)
@@ -192,22 +229,12 @@ Constraint* System::constraint_new(resource::Resource* id, double bound_value)
   return cnst;
 }
 
-void* System::variable_mallocator_new_f()
-{
-  return new Variable;
-}
-
-void System::variable_mallocator_free_f(void* var)
-{
-  delete static_cast<Variable*>(var);
-}
-
 Variable* System::variable_new(resource::Action* id, double sharing_penalty, double bound, size_t number_of_constraints)
 {
   XBT_IN("(sys=%p, id=%p, penalty=%f, bound=%f, num_cons =%zu)", this, id, sharing_penalty, bound,
          number_of_constraints);
 
-  Variable* var = static_cast<Variable*>(xbt_mallocator_get(variable_mallocator_));
+  Variable* var = new (variable_arena_.allocate(sizeof(Variable))) Variable(element_arena_);
   var->initialize(id, sharing_penalty, bound, number_of_constraints, visited_counter_ - 1);
   if (sharing_penalty > 0)
     variable_set.push_front(*var);
@@ -267,18 +294,22 @@ void System::expand(Constraint* cnst, Variable* var, double consumption_weight)
 
   if (var->sharing_penalty_) {
     elem.constraint->enabled_element_set_.push_front(elem);
+    elem.constraint->elements_version_++;
     elem.increase_concurrency();
   } else
     elem.constraint->disabled_element_set_.push_back(elem);
 
+  // When dirty, the chains may lead to freed constraints, and the pending rebuild will merge them anyway
+  if (solve_components_ && not components_dirty_ && var->cnsts_.size() > 1)
+    merge_components(var->cnsts_[0].constraint, cnst);
+
   if (not selective_update_active) {
     make_constraint_active(cnst);
   } else if (elem.consumption_weight > 0 || var->sharing_penalty_ > 0) {
     make_constraint_active(cnst);
     update_modified_set(cnst);
     // TODOLATER: Why do we need this second call?
-    if (var->cnsts_.size() > 1)
-      update_modified_set(var->cnsts_[0].constraint);
+    update_modified_set(var);
   }
 
   check_concurrency();
@@ -302,6 +333,7 @@ void System::expand_add(Constraint* cnst, Variable* var, double value)
       elem.consumption_weight += value;
     else
       elem.consumption_weight = std::max(elem.consumption_weight, value);
+    cnst->elements_version_++;
 
     // We need to check that increasing value of the element does not cross the concurrency limit
     if (var->sharing_penalty_) {
@@ -394,22 +426,103 @@ Variable* Constraint::get_variable_safe(const Element** elem, const Element** ne
     return nullptr;
 }
 
-static inline void saturated_constraints_update(double usage, int cnst_light_num, dyn_light_t& saturated_constraints,
-                                                double* min_usage)
+void SaturationHeap::swap_slots(int slot1, int slot2)
 {
-  xbt_assert(usage > 0, "Impossible");
+  std::swap(heap_[slot1], heap_[slot2]);
+  slot_[heap_[slot1].second] = slot1;
+  slot_[heap_[slot2].second] = slot2;
+}
 
-  if (*min_usage < 0 || *min_usage > usage) {
-    *min_usage = usage;
-    XBT_HERE(" min_usage=%f (cnst->remaining / cnst->usage =%f)", *min_usage, usage);
-    saturated_constraints.assign(1, cnst_light_num);
-  } else if (*min_usage == usage) {
-    saturated_constraints.emplace_back(cnst_light_num);
+void SaturationHeap::sift_up(int slot)
+{
+  while (slot > 0 && less(slot, (slot - 1) / 2)) {
+    swap_slots(slot, (slot - 1) / 2);
+    slot = (slot - 1) / 2;
   }
 }
 
+void SaturationHeap::sift_down(int slot)
+{
+  int size = heap_.size();
+  while (true) {
+    int smallest = slot;
+    for (int child = 2 * slot + 1; child <= 2 * slot + 2 && child < size; child++)
+      if (less(child, smallest))
+        smallest = child;
+    if (smallest == slot)
+      return;
+    swap_slots(slot, smallest);
+    slot = smallest;
+  }
+}
+
+void SaturationHeap::push(double remaining_over_usage)
+{
+  int pos = slot_.size();
+  slot_.push_back(heap_.size());
+  rank_.push_back(pushed_++);
+  heap_.emplace_back(remaining_over_usage, pos);
+  sift_up(heap_.size() - 1);
+}
+
+void SaturationHeap::update(int pos, double remaining_over_usage)
+{
+  int slot          = slot_[pos];
+  heap_[slot].first = remaining_over_usage;
+  sift_up(slot);
+  sift_down(slot_[pos]);
+}
+
+void SaturationHeap::remove(int pos)
+{
+  /* Drop the node of pos */
+  int slot = slot_[pos];
+  int last = heap_.size() - 1;
+  if (slot != last) {
+    swap_slots(slot, last);
+    heap_.pop_back();
+    sift_up(slot);
+    sift_down(slot_[heap_[slot].second]);
+  } else {
+    heap_.pop_back();
+  }
+  /* The last position of the light table is moved to pos: its key gets smaller */
+  int moved      = slot_.size() - 1;
+  int moved_slot = slot_[moved];
+  slot_.pop_back();
+  if (moved != pos) {
+    heap_[moved_slot].second = pos;
+    slot_[pos]               = moved_slot;
+    rank_[pos]               = rank_[moved];
+    sift_up(moved_slot);
+  }
+  rank_.pop_back();
+}
+
+double SaturationHeap::get_minimums(std::vector<int>& positions) const
+{
+  positions.clear();
+  if (heap_.empty())
+    return -1;
+  double min_usage = heap_[0].first;
+  /* The nodes holding the minimum form a subtree rooted at the top of the heap */
+  std::vector<int> todo{0};
+  int size = heap_.size();
+  while (not todo.empty()) {
+    int slot = todo.back();
+    todo.pop_back();
+    positions.push_back(heap_[slot].second);
+    for (int child = 2 * slot + 1; child <= 2 * slot + 2 && child < size; child++)
+      if (heap_[child].first == min_usage)
+        todo.push_back(child);
+  }
+  std::sort(positions.begin(), positions.end(), [this](int pos1, int pos2) { return rank_[pos1] < rank_[pos2]; });
+  return min_usage;
+}
+
+template <class VarList>
 static inline void saturated_variable_set_update(ConstraintLight* cnst_light_tab,
-                                                 const dyn_light_t& saturated_constraints, System* sys)
+                                                 const std::vector<int>& saturated_constraints, VarList& var_list)
 {
   /* Add active variables (i.e. variables that need to be set) from the set of constraints to saturate
    * (cnst_light_tab)*/
@@ -418,7 +531,7 @@ static inline void saturated_variable_set_update(ConstraintLight* cnst_light_tab
     for (Element const& elem : cnst.cnst->active_element_set_) {
       xbt_assert(elem.variable->sharing_penalty_ > 0); // All elements of active_element_set should be active
       if (elem.consumption_weight > 0 && not elem.variable->saturated_variable_set_hook_.is_linked())
-        sys->saturated_variable_set.push_back(*elem.variable);
+        var_list.push_back(*elem.variable);
     }
   }
 }
@@ -488,45 +601,155 @@ void System::lmm_solve()
 {
   if (modified_) {
     XBT_IN("(sys=%p)", this);
+    double start = xbt_os_time();
     /* Compute Usage and store the variables that reach the maximum. If selective_update_active is true, only
      * constraints that changed are considered. Otherwise all constraints with active actions are considered.
      */
-    if (selective_update_active)
+    if (incremental_)
+      incremental_solve();
+    else if (selective_update_active)
       lmm_solve(modified_constraint_set);
     else
       lmm_solve(active_constraint_set);
+    statistics_.solves++;
+    statistics_.solve_time += xbt_os_time() - start;
     XBT_OUT();
   }
 }
 
 template <class CnstList> void System::lmm_solve(CnstList& cnst_list)
+{
+  if (solve_components_)
+    solve_components(cnst_list);
+  else
+    saturate(cnst_list, saturated_variable_set, modified_set_, statistics_);
+
+  modified_ = false;
+  if (selective_update_active)
+    remove_all_modified_set();
+
+  if (XBT_LOG_ISENABLED(surf_maxmin, xbt_log_priority_debug)) {
+    print();
+  }
+
+  check_concurrency();
+}
+
+/** @brief Split the constraints to solve into their connected components, and saturate each of them separately.
+ *
+ * The components are listed by order of first appearance in cnst_list, and each of them keeps the relative order of its
+ * constraints. As the saturation of a component only reads and writes the constraints, elements and variables of this
+ * component, the components can be saturated concurrently and the result does not depend on the amount of threads.
+ * Since the saturation breaks its ties in the order of the constraints (see SaturationHeap), each component is saturated
+ * exactly as within the whole system, and the values are the very same as the ones of lmm_solve().
+ */
+template <class CnstList> void System::solve_components(CnstList& cnst_list)
+{
+  if (components_dirty_) {
+    rebuild_components();
+  } else if (not split_components_.empty()) {
+    /* Only check again the components that lost a variable, each of them once */
+    for (Constraint*& cnst : split_components_)
+      cnst = cnst->get_component();
+    std::sort(begin(split_components_), end(split_components_));
+    split_components_.erase(std::unique(begin(split_components_), end(split_components_)), end(split_components_));
+    for (Constraint* root : split_components_)
+      split_component(root);
+    split_components_.clear();
+  }
+
+  /* The modified set of actions is shared by all components: fill it beforehand, in the order of saturate() */
+  if (modified_set_) {
+    for (Constraint const& cnst : cnst_list) {
+      if (not double_positive(cnst.bound_, cnst.bound_ * sg_maxmin_precision))
+        continue;
+      for (Element const& elem : cnst.enabled_element_set_) {
+        resource::Action* action = static_cast<resource::Action*>(elem.variable->id_);
+        if (elem.consumption_weight > 0 && not action->is_within_modified_set())
+          modified_set_->push_back(*action);
+      }
+    }
+  }
+
+  std::unordered_map<Constraint*, size_t> component_index;
+  size_t used = 0;
+  for (Constraint& cnst : cnst_list) {
+    auto it = component_index.emplace(cnst.get_component(), used);
+    if (it.second) {
+      if (used == components_.size())
+        components_.emplace_back();
+      components_[used].cnsts.clear();
+      used++;
+    }
+    components_[it.first->second].cnsts.push_back(&cnst);
+  }
+  XBT_DEBUG("Solving %zu constraints split into %zu components", cnst_list.size(), used);
+
+  std::vector<Component*> todo;
+  todo.reserve(used);
+  for (size_t i = 0; i < used; i++)
+    todo.push_back(&components_[i]);
+
+  auto solve_one = [this](Component* component) {
+    auto cnsts = boost::adaptors::indirect(component->cnsts);
+    component->statistics = SolverStatistics();
+    saturate(cnsts, component->saturated_variables, nullptr, component->statistics);
+  };
+
+  // Logging is not thread-safe, so only go parallel when nobody watches the details
+  if (components_threads_ > 1 && used > 1 && not XBT_LOG_ISENABLED(surf_maxmin, xbt_log_priority_debug)) {
+    if (not components_parmap_)
+      components_parmap_.reset(new xbt::Parmap<Component*>(components_threads_, XBT_PARMAP_DEFAULT));
+    components_parmap_->apply(solve_one, todo);
+  } else {
+    for (Component* component : todo)
+      solve_one(component);
+  }
+  for (Component const* component : todo)
+    statistics_.merge(component->statistics);
+}
+
+template <class CnstList>
+void System::saturate(CnstList& cnst_list, saturated_variable_list_t& var_list,
+                      resource::Action::ModifiedSet* modified_set, SolverStatistics& statistics)
 {
   double min_usage = -1;
   double min_bound = -1;
 
   XBT_DEBUG("Active constraints : %zu", cnst_list.size());
-  /* Init: Only modified code portions: reset the value of active variables */
+  statistics.constraints += cnst_list.size();
+  /* Init: Only modified code portions: reset the value of active variables (but the frozen ones of a residual solve) */
   for (Constraint const& cnst : cnst_list) {
     for (Element const& elem : cnst.enabled_element_set_) {
       xbt_assert(elem.variable->sharing_penalty_ > 0.0);
-      elem.variable->value_ = 0.0;
+      if (not is_frozen(*elem.variable))
+        elem.variable->value_ = 0.0;
     }
   }
 
   ConstraintLight* cnst_light_tab = new ConstraintLight[cnst_list.size()]();
   int cnst_light_num              = 0;
-  dyn_light_t saturated_constraints;
+  SaturationHeap light_heap;
+  light_heap.reserve(cnst_list.size());
+  std::vector<int> saturated_constraints;
 
   for (Constraint& cnst : cnst_list) {
     /* INIT: Collect constraints that actually need to be saturated (i.e remaining  and usage are strictly positive)
      * into cnst_light_tab. */
     cnst.remaining_ = cnst.bound_;
+    if (residual_solve_ && cnst.sharing_policy_ != s4u::Link::SharingPolicy::FATPIPE) {
+      for (Element const& elem : cnst.enabled_element_set_)
+        if (is_frozen(*elem.variable))
+          double_update(&cnst.remaining_, elem.consumption_weight * elem.variable->value_,
+                        cnst.bound_ * sg_maxmin_precision);
+    }
     if (not double_positive(cnst.remaining_, cnst.bound_ * sg_maxmin_precision))
       continue;
     cnst.usage_ = 0;
+    statistics.elements_visited += cnst.enabled_element_set_.size();
     for (Element& elem : cnst.enabled_element_set_) {
       xbt_assert(elem.variable->sharing_penalty_ > 0);
-      if (elem.consumption_weight > 0) {
+      if (elem.consumption_weight > 0 && not is_frozen(*elem.variable)) {
         if (cnst.sharing_policy_ != s4u::Link::SharingPolicy::FATPIPE)
           cnst.usage_ += elem.consumption_weight / elem.variable->sharing_penalty_;
         else if (cnst.usage_ < elem.consumption_weight / elem.variable->sharing_penalty_)
@@ -534,8 +757,8 @@ template <class CnstList> void System::lmm_solve(CnstList& cnst_list)
 
         elem.make_active();
         resource::Action* action = static_cast<resource::Action*>(elem.variable->id_);
-        if (modified_set_ && not action->is_within_modified_set())
-          modified_set_->push_back(*action);
+        if (modified_set && not action->is_within_modified_set())
+          modified_set->push_back(*action);
       }
     }
     XBT_DEBUG("Constraint '%d' usage: %f remaining: %f concurrency: %i<=%i<=%i", cnst.rank_, cnst.usage_,
@@ -546,20 +769,20 @@ template <class CnstList> void System::lmm_solve(CnstList& cnst_list)
       cnst_light_tab[cnst_light_num].cnst                 = &cnst;
       cnst.cnst_light_                                    = &cnst_light_tab[cnst_light_num];
       cnst_light_tab[cnst_light_num].remaining_over_usage = cnst.remaining_ / cnst.usage_;
-      saturated_constraints_update(cnst_light_tab[cnst_light_num].remaining_over_usage, cnst_light_num,
-                                   saturated_constraints, &min_usage);
+      light_heap.push(cnst_light_tab[cnst_light_num].remaining_over_usage);
       xbt_assert(not cnst.active_element_set_.empty(),
                  "There is no sense adding a constraint that has no active element!");
       cnst_light_num++;
     }
   }
 
-  saturated_variable_set_update(cnst_light_tab, saturated_constraints, this);
+  min_usage = light_heap.get_minimums(saturated_constraints);
+  saturated_variable_set_update(cnst_light_tab, saturated_constraints, var_list);
 
   /* Saturated variables update */
   do {
+    statistics.rounds++;
     /* Fix the variables that have to be */
-    auto& var_list = saturated_variable_set;
     for (Variable const& var : var_list) {
       if (var.sharing_penalty_ <= 0.0)
         DIE_IMPOSSIBLE;
@@ -598,6 +821,7 @@ template <class CnstList> void System::lmm_solve(CnstList& cnst_list)
                 var.rank_, var.value_);
 
       /* Update the usage of contraints where this variable is involved */
+      statistics.elements_visited += var.cnsts_.size();
       for (Element& elem : var.cnsts_) {
         Constraint* cnst = elem.constraint;
         if (cnst->sharing_policy_ != s4u::Link::SharingPolicy::FATPIPE) {
@@ -615,10 +839,12 @@ template <class CnstList> void System::lmm_solve(CnstList& cnst_list)
               cnst_light_tab[index].cnst->cnst_light_ = &cnst_light_tab[index];
               cnst_light_num--;
               cnst->cnst_light_ = nullptr;
+              light_heap.remove(index);
             }
           } else {
             if (cnst->cnst_light_) {
               cnst->cnst_light_->remaining_over_usage = cnst->remaining_ / cnst->usage_;
+              light_heap.update(cnst->cnst_light_ - cnst_light_tab, cnst->cnst_light_->remaining_over_usage);
             }
           }
           elem.make_inactive();
@@ -626,9 +852,10 @@ template <class CnstList> void System::lmm_solve(CnstList& cnst_list)
           // Remember: non-shared constraints only require that max(elem.value * var.value) < cnst->bound
           cnst->usage_ = 0.0;
           elem.make_inactive();
+          statistics.elements_visited += cnst->enabled_element_set_.size();
           for (Element& elem2 : cnst->enabled_element_set_) {
             xbt_assert(elem2.variable->sharing_penalty_ > 0);
-            if (elem2.variable->value_ > 0)
+            if (elem2.variable->value_ > 0 || is_frozen(*elem2.variable))
               continue;
             if (elem2.consumption_weight > 0)
               cnst->usage_ = std::max(cnst->usage_, elem2.consumption_weight / elem2.variable->sharing_penalty_);
@@ -646,10 +873,12 @@ template <class CnstList> void System::lmm_solve(CnstList& cnst_list)
               cnst_light_tab[index].cnst->cnst_light_ = &cnst_light_tab[index];
               cnst_light_num--;
               cnst->cnst_light_ = nullptr;
+              light_heap.remove(index);
             }
           } else {
             if (cnst->cnst_light_) {
               cnst->cnst_light_->remaining_over_usage = cnst->remaining_ / cnst->usage_;
+              light_heap.update(cnst->cnst_light_ - cnst_light_tab, cnst->cnst_light_->remaining_over_usage);
               xbt_assert(not cnst->active_element_set_.empty(),
                          "Should not keep a maximum constraint that has no active"
                          " element! You want to check the maxmin precision and possible rounding effects.");
@@ -661,34 +890,19 @@ template <class CnstList> void System::lmm_solve(CnstList& cnst_list)
     }
 
     /* Find out which variables reach the maximum */
-    min_usage = -1;
+    min_usage = light_heap.get_minimums(saturated_constraints);
     min_bound = -1;
-    saturated_constraints.clear();
-    int pos;
-    for (pos = 0; pos < cnst_light_num; pos++) {
+    for (int const& pos : saturated_constraints)
       xbt_assert(not cnst_light_tab[pos].cnst->active_element_set_.empty(),
                  "Cannot saturate more a constraint that has"
                  " no active element! You may want to change the maxmin precision (--cfg=maxmin/precision:<new_value>)"
                  " because of possible rounding effects.\n\tFor the record, the usage of this constraint is %g while "
-                 "the maxmin precision to which it is compared is %g.\n\tThe usage of the previous constraint is %g.",
-                 cnst_light_tab[pos].cnst->usage_, sg_maxmin_precision, cnst_light_tab[pos - 1].cnst->usage_);
-      saturated_constraints_update(cnst_light_tab[pos].remaining_over_usage, pos, saturated_constraints, &min_usage);
-    }
+                 "the maxmin precision to which it is compared is %g.",
+                 cnst_light_tab[pos].cnst->usage_, sg_maxmin_precision);
 
-    saturated_variable_set_update(cnst_light_tab, saturated_constraints, this);
+    saturated_variable_set_update(cnst_light_tab, saturated_constraints, var_list);
 
   } while (cnst_light_num > 0);
-
-  modified_ = false;
-  if (selective_update_active)
-    remove_all_modified_set();
-
-  if (XBT_LOG_ISENABLED(surf_maxmin, xbt_log_priority_debug)) {
-    print();
-  }
-
-  check_concurrency();
-
   delete[] cnst_light_tab;
 }
 
@@ -705,8 +919,7 @@ void System::update_variable_bound(Variable* var, double bound)
   modified_  = true;
   var->bound_ = bound;
 
-  if (not var->cnsts_.empty())
-    update_modified_set(var->cnsts_[0].constraint);
+  update_modified_set(var);
 }
 
 void Variable::initialize(resource::Action* id_value, double sharing_penalty, double bound_value,
@@ -721,7 +934,9 @@ void Variable::initialize(resource::Action* id_value, double sharing_penalty, do
   concurrency_share_ = 1;
   value_             = 0.0;
   visited_           = visited_value;
+  changed_           = 0;
   mu_                = 0.0;
+  compact_index_     = -1;
 
   xbt_assert(not variable_set_hook_.is_linked());
   xbt_assert(not saturated_variable_set_hook_.is_linked());
@@ -761,10 +976,10 @@ void System::enable_var(Variable* var)
   for (Element& elem : var->cnsts_) {
     simgrid::xbt::intrusive_erase(elem.constraint->disabled_element_set_, elem);
     elem.constraint->enabled_element_set_.push_front(elem);
+    elem.constraint->elements_version_++;
     elem.increase_concurrency();
   }
-  if (not var->cnsts_.empty())
-    update_modified_set(var->cnsts_[0].constraint);
+  update_modified_set(var);
 
   // When used within on_disabled_var, we would get an assertion fail, because transiently there can be variables
   // that are staged and could be activated.
@@ -778,11 +993,11 @@ void System::disable_var(Variable* var)
   // BEFORE moving the last element of var.
   simgrid::xbt::intrusive_erase(variable_set, *var);
   variable_set.push_back(*var);
-  if (not var->cnsts_.empty())
-    update_modified_set(var->cnsts_[0].constraint);
+  update_modified_set(var);
   for (Element& elem : var->cnsts_) {
     simgrid::xbt::intrusive_erase(elem.constraint->enabled_element_set_, elem);
     elem.constraint->disabled_element_set_.push_back(elem);
+    elem.constraint->elements_version_++;
     if (elem.active_element_set_hook.is_linked())
       simgrid::xbt::intrusive_erase(elem.constraint->active_element_set_, elem);
     elem.decrease_concurrency();
@@ -913,6 +1128,27 @@ void System::update_modified_set_rec(Constraint* cnst)
 }
 
 void System::update_modified_set(Constraint* cnst)
+{
+  /* the incremental solve only propagates the changes when solving the system */
+  if (incremental_)
+    changed_constraints_.push_back(cnst);
+  else
+    propagate_modified_set(cnst);
+}
+
+/** @brief Same as update_modified_set(Constraint*), for a change of the variable itself (penalty, bound, ...) */
+void System::update_modified_set(Variable* var)
+{
+  if (incremental_) {
+    var->changed_ = changed_counter_;
+    for (Element const& elem : var->cnsts_)
+      changed_constraints_.push_back(elem.constraint);
+  } else if (not var->cnsts_.empty()) {
+    propagate_modified_set(var->cnsts_[0].constraint);
+  }
+}
+
+void System::propagate_modified_set(Constraint* cnst)
 {
   /* nothing to do if selective update isn't active */
   if (selective_update_active && not cnst->modified_constraint_set_hook_.is_linked()) {
@@ -921,6 +1157,247 @@ void System::update_modified_set(Constraint* cnst)
   }
 }
 
+void System::set_incremental(bool enabled)
+{
+  enabled = enabled && selective_update_active;
+  if (incremental_ && not enabled) {
+    for (Constraint* cnst : changed_constraints_)
+      propagate_modified_set(cnst);
+    changed_constraints_.clear();
+  }
+  if (enabled && not incremental_)
+    incremental_ready_ = false; // the variables may not hold a complete solution yet
+  incremental_ = enabled;
+}
+
+/** @brief Compute the share level up to which the previous solution still holds.
+ *
+ * Solving the system amounts to raising the level of all variables together (their value times their penalty), each
+ * variable being fixed when one of its constraints gets saturated. Until one of the changed constraints gets
+ * saturated, in the previous system or in the current one, both systems go through the very same states. The
+ * previous saturation level of a changed constraint is at least the highest level of its unchanged variables (if it
+ * was saturated), while its new saturation level is reached by the unchanged variables following their previous
+ * levels and the changed ones rising up to their bound.
+ *
+ * @return that level (infinite if no changed constraint gets saturated), or -1 if the previous solution cannot be
+ *         reused
+ */
+double System::incremental_threshold() const
+{
+  constexpr double infinity = std::numeric_limits<double>::infinity();
+  double threshold          = infinity;
+  auto get_level            = [this](Variable const* var) {
+    if (var->changed_ != changed_counter_)
+      return var->value_ * var->sharing_penalty_;
+    return var->bound_ > 0 ? var->bound_ * var->sharing_penalty_ : infinity;
+  };
+
+  /* The previous saturation levels */
+  for (Constraint const* cnst : changed_constraints_) {
+    if (cnst->sharing_policy_ != s4u::Link::SharingPolicy::FATPIPE &&
+        double_positive(cnst->remaining_, cnst->bound_ * sg_maxmin_precision))
+      continue; // the constraint was not saturated in the previous solution
+    double highest = -1;
+    for (Element const& elem : cnst->enabled_element_set_)
+      if (elem.variable->changed_ != changed_counter_)
+        highest = std::max(highest, get_level(elem.variable));
+    if (highest >= 0)
+      threshold = std::min(threshold, highest);
+  }
+
+  /* The new saturation levels, when they are below the current threshold */
+  std::vector<std::pair<double, double>> levels; // (level at which the element stops growing, usage of the element)
+  for (Constraint const* cnst : changed_constraints_) {
+    if (cnst->sharing_policy_ == s4u::Link::SharingPolicy::FATPIPE) {
+      for (Element const& elem : cnst->enabled_element_set_) {
+        double usage = elem.consumption_weight / elem.variable->sharing_penalty_;
+        if (usage > 0 && get_level(elem.variable) * usage >= cnst->bound_)
+          threshold = std::min(threshold, cnst->bound_ / usage);
+      }
+      continue;
+    }
+
+    double consumed = 0;
+    levels.clear();
+    for (Element const& elem : cnst->enabled_element_set_) {
+      if (elem.consumption_weight > 0) {
+        levels.emplace_back(get_level(elem.variable), elem.consumption_weight / elem.variable->sharing_penalty_);
+        consumed += levels.back().second * std::min(threshold, levels.back().first);
+      }
+    }
+    if (consumed < cnst->bound_)
+      continue; // not saturated before the threshold
+
+    /* The consumption is a concave function of the level: Newton steps from below never go past its saturation level.
+     * Stopping after a few steps gives a lower bound of that level, which is enough. */
+    double level = 0;
+    for (int step = 0; step < 4 && level < threshold; step++) {
+      double usage = 0;
+      consumed     = 0;
+      for (auto const& elem : levels) {
+        consumed += elem.second * std::min(level, elem.first);
+        if (elem.first > level)
+          usage += elem.second;
+      }
+      if (usage <= 0) {
+        level = infinity; // everybody is fixed before saturating this constraint
+        break;
+      }
+      double next = level + (cnst->bound_ - consumed) / usage;
+      if (next <= level)
+        break;
+      level = next;
+    }
+    threshold = std::min(threshold, level);
+  }
+
+  /* Keep some slack, so that the variables fixed at that very level are solved again */
+  threshold *= 1 - sg_maxmin_precision;
+  return double_positive(threshold, sg_maxmin_precision) ? threshold : -1;
+}
+
+/** @brief Whether a constraint cannot get saturated, as its variables are bounded by their other constraints */
+bool System::never_saturated(const Constraint& cnst) const
+{
+  double consumption = 0;
+  for (Element const& elem : cnst.enabled_element_set_) {
+    if (elem.consumption_weight <= 0)
+      continue;
+    Variable const* var = elem.variable;
+    double value        = var->bound_ > 0 ? var->bound_ : std::numeric_limits<double>::infinity();
+    for (Element const& elem2 : var->cnsts_)
+      if (elem2.constraint != &cnst && elem2.consumption_weight > 0)
+        value = std::min(value, elem2.constraint->bound_ / elem2.consumption_weight);
+    if (cnst.sharing_policy_ != s4u::Link::SharingPolicy::FATPIPE)
+      consumption += elem.consumption_weight * value;
+    else
+      consumption = std::max(consumption, elem.consumption_weight * value);
+    if (consumption >= cnst.bound_ * (1 - sg_maxmin_precision))
+      return false;
+  }
+  return true;
+}
+
+void System::incremental_solve()
+{
+  double threshold = incremental_ready_ ? incremental_threshold() : -1;
+  if (threshold > 0) {
+    /* Solve again the constraints connected to the changes through the variables that were not fixed below the
+     * threshold. The other variables are frozen to their previous value. */
+    std::vector<Constraint*> todo;
+    auto add_constraint = [this, &todo](Constraint* cnst) {
+      if (not cnst->modified_constraint_set_hook_.is_linked()) {
+        modified_constraint_set.push_back(*cnst);
+        todo.push_back(cnst);
+      }
+    };
+    for (Constraint* cnst : changed_constraints_)
+      add_constraint(cnst);
+    while (not todo.empty()) {
+      Constraint* cnst = todo.back();
+      todo.pop_back();
+      // A constraint that was not saturated and cannot get saturated does not bind the unchanged variables together
+      bool loose = cnst->sharing_policy_ != s4u::Link::SharingPolicy::FATPIPE &&
+                   double_positive(cnst->remaining_, cnst->bound_ * sg_maxmin_precision) && never_saturated(*cnst);
+      for (Element const& elem : cnst->enabled_element_set_) {
+        Variable* var = elem.variable;
+        if (var->visited_ == visited_counter_ ||
+            (var->changed_ != changed_counter_ && var->value_ > 0 &&
+             (loose || var->value_ * var->sharing_penalty_ < threshold)))
+          continue;
+        var->visited_ = visited_counter_;
+        for (Element const& elem2 : var->cnsts_)
+          add_constraint(elem2.constraint);
+      }
+    }
+    residual_solve_ = true;
+  } else {
+    for (Constraint* cnst : changed_constraints_)
+      propagate_modified_set(cnst);
+  }
+  XBT_DEBUG("Incremental solve from level %g: %zu constraints changed, %zu constraints solved", threshold,
+            changed_constraints_.size(), modified_constraint_set.size());
+  changed_constraints_.clear();
+
+  lmm_solve(modified_constraint_set);
+
+  residual_solve_    = false;
+  incremental_ready_ = true;
+  if (++changed_counter_ == 0) {
+    /* the counter wrapped around, reset each variable->changed */
+    for (Variable& var : variable_set)
+      var.changed_ = 0;
+    changed_counter_ = 1;
+  }
+}
+
+void System::set_solve_components(bool enabled, int threads)
+{
+  xbt_assert(threads > 0, "The amount of threads used to solve the components should be positive");
+  if (enabled && not solve_components_)
+    components_dirty_ = true;
+  solve_components_ = enabled;
+  if (threads != components_threads_)
+    components_parmap_.reset();
+  components_threads_ = threads;
+}
+
+Constraint* Constraint::get_component()
+{
+  Constraint* cnst = this;
+  while (cnst->component_ != cnst) {
+    cnst->component_ = cnst->component_->component_; // path halving
+    cnst             = cnst->component_;
+  }
+  return cnst;
+}
+
+void System::merge_components(Constraint* cnst1, Constraint* cnst2)
+{
+  Constraint* root1 = cnst1->get_component();
+  Constraint* root2 = cnst2->get_component();
+  if (root1 != root2) {
+    root2->component_ = root1;
+    std::swap(root1->component_next_, root2->component_next_); // splice both circular lists into a single one
+  }
+}
+
+/** @brief Recompute the components of the constraints of this one, as removing a variable may have split it. */
+void System::split_component(Constraint* root)
+{
+  std::vector<Constraint*> cnsts;
+  Constraint* cnst = root;
+  do {
+    cnsts.push_back(cnst);
+    cnst = cnst->component_next_;
+  } while (cnst != root);
+
+  for (Constraint* member : cnsts) {
+    member->component_      = member;
+    member->component_next_ = member;
+  }
+  for (Constraint* member : cnsts) {
+    for (Element const& elem : member->enabled_element_set_)
+      merge_components(elem.variable->cnsts_[0].constraint, member);
+    for (Element const& elem : member->disabled_element_set_)
+      merge_components(elem.variable->cnsts_[0].constraint, member);
+  }
+}
+
+/** @brief Recompute all the connected components from scratch, as a constraint was removed. */
+void System::rebuild_components()
+{
+  for (Constraint& cnst : constraint_set) {
+    cnst.component_      = &cnst;
+    cnst.component_next_ = &cnst;
+  }
+  for (Variable const& var : variable_set)
+    for (unsigned i = 1; i < var.cnsts_.size(); i++)
+      merge_components(var.cnsts_[0].constraint, var.cnsts_[i].constraint);
+  components_dirty_ = false;
+  split_components_.clear();
+}
+
 void System::remove_all_modified_set()
 {
   // We cleverly un-flag all variables just by incrementing visited_counter
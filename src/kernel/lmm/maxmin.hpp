@@ -9,14 +9,18 @@
 #include "simgrid/kernel/resource/Action.hpp"
 #include "simgrid/s4u/Link.hpp"
 #include "xbt/asserts.h"
-#include "xbt/mallocator.h"
+#include "xbt/slab_arena.hpp"
 
 #include <boost/intrusive/list.hpp>
 #include <cmath>
 #include <limits>
+#include <memory>
 #include <vector>
 
 namespace simgrid {
+namespace xbt {
+template <typename T> class Parmap;
+}
 namespace kernel {
 namespace lmm {
 
@@ -167,6 +171,61 @@ public:
   Constraint* cnst;
 };
 
+/**
+ * @brief Indexed min-heap over the positions of a light table, ordered by (remaining_over_usage, position)
+ *
+ * It mirrors the light table used during the saturation (including its swap-with-last removals), so that each round
+ * only touches the constraints whose ratio changed instead of rescanning the whole table. The constraints to saturate
+ * are given in the order in which they were pushed (i.e., their order in the solved list), which does not depend on
+ * the removals: the constraints of a connected component are thus saturated in the same order whether the component is
+ * solved alone or within the whole system, and both compute the very same values.
+ */
+class XBT_PUBLIC SaturationHeap {
+public:
+  void clear()
+  {
+    heap_.clear();
+    slot_.clear();
+    rank_.clear();
+    pushed_ = 0;
+  }
+  void reserve(size_t size)
+  {
+    heap_.reserve(size);
+    slot_.reserve(size);
+    rank_.reserve(size);
+  }
+  bool empty() const { return heap_.empty(); }
+
+  /** @brief Add the next position of the light table */
+  void push(double remaining_over_usage);
+  /** @brief Change the ratio of a position */
+  void update(int pos, double remaining_over_usage);
+  /** @brief Remove a position, the last position of the table taking its place */
+  void remove(int pos);
+  /**
+   * @brief Get the positions with the minimal ratio
+   * @param positions filled with these positions, in the order in which they were pushed
+   * @return the minimal ratio, or -1 if the heap is empty
+   */
+  double get_minimums(std::vector<int>& positions) const;
+
+private:
+  bool less(int slot1, int slot2) const
+  {
+    return heap_[slot1].first < heap_[slot2].first ||
+           (heap_[slot1].first == heap_[slot2].first && heap_[slot1].second < heap_[slot2].second);
+  }
+  void swap_slots(int slot1, int slot2);
+  void sift_up(int slot);
+  void sift_down(int slot);
+
+  std::vector<std::pair<double, int>> heap_; /* (remaining_over_usage, position) */
+  std::vector<int> slot_;                    /* slot_[position] is the index of that position in heap_ */
+  std::vector<int> rank_;                    /* rank_[position] is the amount of positions pushed before that one */
+  int pushed_ = 0;
+};
+
 /**
  * @brief LMM constraint
  * Each constraint contains several partially overlapping logical sets of elements:
@@ -246,6 +305,9 @@ public:
    */
   resource::Resource* get_id() const { return id_; }
 
+  /** @brief Get the representative of the connected component containing this constraint */
+  Constraint* get_component();
+
   /* hookup to system */
   boost::intrusive::list_member_hook<> constraint_set_hook_;
   boost::intrusive::list_member_hook<> active_constraint_set_hook_;
@@ -273,6 +335,10 @@ public:
   double lambda_;
   double new_lambda_;
   ConstraintLight* cnst_light_;
+  Constraint* component_;      // Union-find parent, used by System::solve_components()
+  Constraint* component_next_; // Next constraint of the same component (circular list), to split it again
+  int compact_index_;          // Row in CompactSystem, or position in FairBottleneck during a solve, -1 otherwise
+  unsigned elements_version_;  // Changed with the enabled elements or their weights (see CompactSystem)
 
 private:
   static int next_rank_;  // To give a separate rank_ to each contraint
@@ -289,6 +355,9 @@ private:
  */
 class XBT_PUBLIC Variable {
 public:
+  /** @param element_arena where the array of the elements of the variable is allocated */
+  explicit Variable(xbt::SlabArena& element_arena) : cnsts_(xbt::ArenaAllocator<Element>(element_arena)) {}
+
   void initialize(resource::Action* id_value, double sharing_penalty, double bound_value, int number_of_constraints,
                   unsigned visited_value);
 
@@ -342,7 +411,7 @@ public:
   boost::intrusive::list_member_hook<> variable_set_hook_;
   boost::intrusive::list_member_hook<> saturated_variable_set_hook_;
 
-  std::vector<Element> cnsts_;
+  std::vector<Element, xbt::ArenaAllocator<Element>> cnsts_;
 
   // sharing_penalty: variable's impact on the resource during the sharing
   //   if == 0, the variable is not considered by LMM
@@ -358,7 +427,10 @@ public:
   resource::Action* id_;
   int rank_;         // Only used in debug messages to identify the variable
   unsigned visited_; /* used by System::update_modified_set() */
+  unsigned changed_; /* used by the incremental solve: the variable changed since the last solve if equal to the
+                      * changed_counter_ of its system */
   double mu_;
+  int compact_index_; /* Slot of the variable in the arrays of CompactSystem, -1 otherwise */
 
 private:
   static int next_rank_; // To give a separate rank_ to each variable
@@ -374,6 +446,26 @@ inline void Element::make_inactive()
     simgrid::xbt::intrusive_erase(constraint->active_element_set_, *this);
 }
 
+/** @brief Activity counters of a System, cheap enough to be always maintained */
+struct SolverStatistics {
+  unsigned long long solves           = 0; /* solves of a modified system */
+  unsigned long long rounds           = 0; /* saturation rounds of these solves */
+  unsigned long long constraints      = 0; /* constraints handed to these solves (modified set with selective update) */
+  unsigned long long elements_visited = 0; /* elements (constraint/variable pairs) visited while saturating */
+  double solve_time                   = 0; /* seconds spent in these solves */
+  double conversion_time              = 0; /* part of solve_time spent in updating the arrays of CompactSystem */
+
+  void merge(const SolverStatistics& other)
+  {
+    solves += other.solves;
+    rounds += other.rounds;
+    constraints += other.constraints;
+    elements_visited += other.elements_visited;
+    solve_time += other.solve_time;
+    conversion_time += other.conversion_time;
+  }
+};
+
 /**
  * @brief LMM system
  */
@@ -449,9 +541,47 @@ public:
   /** @brief Solve the lmm system. May be specialized in subclasses. */
   virtual void solve() { lmm_solve(); }
 
+  /**
+   * @brief Solve the connected components of the system separately
+   * @param enabled whether the system should be split into its connected components before being solved
+   * @param threads the amount of threads used to solve these components in parallel
+   *
+   * The components are solved one after the other (or concurrently if threads > 1), always in the same order, so the
+   * computed values do not depend on the amount of threads. They are also the very same as without components.
+   */
+  void set_solve_components(bool enabled, int threads = 1);
+
+  /**
+   * @brief Re-solve the system incrementally from its previous solution (only with selective update)
+   * @param enabled whether the incremental solve should be used
+   *
+   * Instead of solving again every constraint connected to a change, the solver computes the share level below which
+   * the previous saturation order cannot be affected by the changes. The variables that were fixed below that level
+   * keep their value, and only the remaining part of the system that is connected to the changes is solved again,
+   * on top of the capacity consumed by these frozen variables. The system is fully solved again when no such level
+   * can be found (first solve, or a change that affects the system from the start).
+   */
+  virtual void set_incremental(bool enabled);
+
+  /** @brief Occupancy of the arena where the variables are allocated */
+  xbt::ArenaOccupancy get_variable_arena_occupancy() const { return variable_arena_.get_occupancy(); }
+  /** @brief Occupancy of the arena where the arrays of elements of the variables are allocated */
+  xbt::ArenaOccupancy get_element_arena_occupancy() const { return element_arena_.get_occupancy(); }
+
+  /** @brief Activity counters of the solver since the creation of the system */
+  const SolverStatistics& get_statistics() const { return statistics_; }
+
 private:
-  static void* variable_mallocator_new_f();
-  static void variable_mallocator_free_f(void* var);
+  using saturated_variable_list_t =
+      boost::intrusive::list<Variable, boost::intrusive::member_hook<Variable, boost::intrusive::list_member_hook<>,
+                                                                     &Variable::saturated_variable_set_hook_>>;
+
+  /** @brief A connected component of the system, that can be saturated independently of the others */
+  struct Component {
+    std::vector<Constraint*> cnsts;
+    saturated_variable_list_t saturated_variables;
+    SolverStatistics statistics; // of the last solve, merged into the ones of the system afterward
+  };
 
   void var_free(Variable * var);
   void cnst_free(Constraint * cnst);
@@ -505,13 +635,24 @@ private:
   void update(Constraint * cnst, Variable * var, double value);
 
   void update_modified_set(Constraint * cnst);
+  void update_modified_set(Variable * var);
   void update_modified_set_rec(Constraint * cnst);
+  void propagate_modified_set(Constraint * cnst);
 
-  /** @brief Remove all constraints of the modified_constraint_set. */
-  void remove_all_modified_set();
-  void check_concurrency() const;
+  void incremental_solve();
+  double incremental_threshold() const;
+  bool never_saturated(const Constraint& cnst) const;
+  bool is_frozen(const Variable& var) const { return residual_solve_ && var.visited_ != visited_counter_; }
+
+  void merge_components(Constraint * cnst1, Constraint * cnst2);
+  void split_component(Constraint * root);
+  void rebuild_components();
 
   template <class CnstList> void lmm_solve(CnstList& cnst_list);
+  template <class CnstList> void solve_components(CnstList& cnst_list);
+  template <class CnstList>
+  void saturate(CnstList& cnst_list, saturated_variable_list_t& var_list, resource::Action::ModifiedSet* modified_set,
+                SolverStatistics& statistics);
 
 public:
   bool modified_ = false;
@@ -521,36 +662,157 @@ public:
   boost::intrusive::list<Constraint, boost::intrusive::member_hook<Constraint, boost::intrusive::list_member_hook<>,
                                                                    &Constraint::active_constraint_set_hook_>>
       active_constraint_set;
-  boost::intrusive::list<Variable, boost::intrusive::member_hook<Variable, boost::intrusive::list_member_hook<>,
-                                                                 &Variable::saturated_variable_set_hook_>>
-      saturated_variable_set;
+  saturated_variable_list_t saturated_variable_set;
   boost::intrusive::list<Constraint, boost::intrusive::member_hook<Constraint, boost::intrusive::list_member_hook<>,
                                                                    &Constraint::saturated_constraint_set_hook_>>
       saturated_constraint_set;
 
   resource::Action::ModifiedSet* modified_set_ = nullptr;
 
-private:
+protected:
+  /** @brief Remove all constraints of the modified_constraint_set. */
+  void remove_all_modified_set();
+  /** @brief Called before freeing a variable, for the subclasses that keep data about it */
+  virtual void release(Variable*) { /* nothing to release */ }
+  /** @brief Called before freeing a constraint, for the subclasses that keep data about it */
+  virtual void release(Constraint*) { /* nothing to release */ }
+  void check_concurrency() const;
+
+  SolverStatistics statistics_;
   bool selective_update_active; /* flag to update partially the system only selecting changed portions */
+  boost::intrusive::list<Constraint, boost::intrusive::member_hook<Constraint, boost::intrusive::list_member_hook<>,
+                                                                   &Constraint::modified_constraint_set_hook_>>
+      modified_constraint_set;
+
+private:
   unsigned visited_counter_ = 1; /* used by System::update_modified_set() and System::remove_all_modified_set() to
                                   * cleverly (un-)flag the constraints (more details in these functions) */
   boost::intrusive::list<Constraint, boost::intrusive::member_hook<Constraint, boost::intrusive::list_member_hook<>,
                                                                    &Constraint::constraint_set_hook_>>
       constraint_set;
-  boost::intrusive::list<Constraint, boost::intrusive::member_hook<Constraint, boost::intrusive::list_member_hook<>,
-                                                                   &Constraint::modified_constraint_set_hook_>>
-      modified_constraint_set;
-  xbt_mallocator_t variable_mallocator_ =
-      xbt_mallocator_new(65536, System::variable_mallocator_new_f, System::variable_mallocator_free_f, nullptr);
+  xbt::SlabArena variable_arena_{"lmm variables", 1024};
+  xbt::SlabArena element_arena_{"lmm elements", 1024};
+
+  bool solve_components_  = false; /* flag to split the system into its connected components before solving it */
+  bool components_dirty_  = true;  /* whether the union-find must be rebuilt (on constraint removal) */
+  int components_threads_ = 1;
+  std::vector<Constraint*> split_components_; /* constraints whose component may be split by a variable removal */
+  std::vector<Component> components_;
+  std::unique_ptr<xbt::Parmap<Component*>> components_parmap_;
+
+  bool incremental_       = false; /* flag to solve the system incrementally from its previous solution */
+  bool incremental_ready_ = false; /* whether the values of the variables come from a previous solve */
+  bool residual_solve_    = false; /* set during an incremental solve: only the visited variables are solved */
+  unsigned changed_counter_ = 1;   /* used to flag the variables that changed since the last incremental solve */
+  std::vector<Constraint*> changed_constraints_; /* constraints directly impacted by the changes (with duplicates) */
 };
 
+/**
+ * @brief LMM system solved with the bottleneck progressive filling
+ *
+ * At each round, every constraint shares its remaining capacity among its unsaturated variables, and every variable
+ * grows by its smallest share. Instead of walking every element of every constraint at each round, the solver keeps
+ * per-constraint aggregates up to date: the amount of unsaturated variables, and the consumption of the variables that
+ * stopped growing. A round then only costs the elements of the variables that are still growing.
+ */
 class XBT_PUBLIC FairBottleneck : public System {
 public:
   explicit FairBottleneck(bool selective_update) : System(selective_update) {}
   void solve() final { bottleneck_solve(); }
+  void set_incremental(bool) override { /* not supported */ }
 
 private:
+  /* Per-constraint aggregates, indexed by Constraint::compact_index_ during a solve */
+  struct BottleneckState {
+    Constraint* cnst;
+    int nb_variables;   // unsaturated variables with a positive weight (with duplicates, as the elements)
+    double stale_sum;   // sum of weight*mu over the variables that stopped growing
+    double stale_min;   // min of weight*mu over the variables that stopped growing (for the FATPIPE constraints)
+    double round_sum;   // sum of weight*mu over the variables that grew during the current round
+    double round_min;   // min of the usage and of weight*mu over these variables (for the FATPIPE constraints)
+  };
+
   void bottleneck_solve();
+  void freeze_variable(const Variable& var);
+
+  std::vector<BottleneckState> cnst_state_;
+  std::vector<Variable*> frozen_; // variables that stopped growing during the current round
+};
+
+/**
+ * @brief LMM system solved on a compact copy of its active part
+ *
+ * The constraints and their enabled elements are kept in contiguous index-addressed arrays: one row of elements per
+ * constraint, and one range of elements per variable (in Variable::cnsts_ order). These arrays persist across the
+ * solves: a row is only rebuilt when the enabled elements of its constraint or their weights changed since then, and
+ * the slots of the variables and constraints are reused once freed. The saturation loop then only performs linear
+ * scans over these arrays instead of chasing the intrusive lists. The saturation order is the same as in
+ * System::lmm_solve(), so both backends compute identical values.
+ */
+class XBT_PUBLIC CompactSystem : public System {
+public:
+  explicit CompactSystem(bool selective_update) : System(selective_update) {}
+  void solve() final { compact_solve(); }
+  void set_incremental(bool) override { /* not supported */ }
+
+private:
+  void compact_solve();
+  template <class CnstList> void compact_solve(CnstList& cnst_list);
+  void saturated_variable_set_update();
+
+  void release(Variable* var) override;
+  void release(Constraint* cnst) override;
+  int variable_slot(Variable* var);
+  void rebuild_row(int row);
+  void compact_rows();
+
+  /* Rows, indexed by Constraint::compact_index_. The elements of row r are row_elems_[row_begin_[r] + i] for
+   * i < row_size_[r], in enabled_element_set order. */
+  std::vector<Constraint*> row_cnst_;
+  std::vector<unsigned> row_version_; /* elements_version_ of the constraint when the row was built */
+  std::vector<int> row_begin_;
+  std::vector<int> row_size_;
+  std::vector<int> row_capacity_;
+  std::vector<int> row_position_; /* position of the constraint in the solved list during a solve, -1 otherwise */
+  std::vector<int> row_elems_;
+  std::vector<int> free_rows_;
+  size_t row_used_ = 0; /* sum of row_size_ */
+
+  /* Elements, grouped by variable: the element i of the variable in slot v is at var_elem_begin_[v] + i */
+  std::vector<int> elem_var_; /* slot of the variable */
+  std::vector<int> elem_row_; /* row of the constraint, or -1 if the element was never in a row */
+  std::vector<double> elem_weight_;
+  std::vector<char> elem_active_;
+
+  /* Variables, indexed by Variable::compact_index_. The range of a slot fits the capacity of the variable, and a free
+   * slot is only reused for a variable of the same capacity. */
+  std::vector<Variable*> var_;
+  std::vector<int> var_elem_begin_;
+  std::vector<int> var_elem_end_; /* only covers the elements of the variable during a solve */
+  std::vector<double> var_penalty_;
+  std::vector<double> var_bound_;
+  std::vector<double> var_value_;
+  std::vector<char> var_saturated_;
+  std::vector<unsigned> var_solve_;              /* last solve involving the variable */
+  std::vector<std::vector<int>> free_var_slots_; /* by capacity */
+  unsigned solve_counter_ = 0;
+
+  /* Constraints to solve, indexed by their position in the solved list */
+  std::vector<int> cnst_row_;
+  std::vector<double> cnst_bound_;
+  std::vector<double> cnst_remaining_;
+  std::vector<double> cnst_usage_;
+  std::vector<char> cnst_fatpipe_;
+  std::vector<int> cnst_light_index_;   /* position in the light table, or -1 */
+  std::vector<int> cnst_active_amount_; /* amount of active elements */
+  std::vector<int> solved_vars_;        /* slots of the variables of these constraints, by order of discovery */
+
+  /* Light table of the constraints that still need to be saturated */
+  std::vector<int> light_cnst_;
+  std::vector<double> light_remaining_over_usage_;
+  SaturationHeap light_heap_;
+  std::vector<int> saturated_constraints_;
+  std::vector<int> saturated_variables_;
 };
 
 XBT_PUBLIC System* make_new_maxmin_system(bool selective_update);
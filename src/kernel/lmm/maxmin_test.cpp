@@ -288,3 +288,388 @@ TEST_CASE("kernel::lmm Single constraint unshared systems", "[kernel-lmm-unshare
   Sys->variable_free_all();
   delete Sys;
 }
+
+TEST_CASE("kernel::lmm Systems solved by connected components", "[kernel-lmm-components]")
+{
+  lmm::System* Sys = lmm::make_new_maxmin_system(false);
+  Sys->set_solve_components(true);
+
+  SECTION("Independent components")
+  {
+
+    /*
+     * Two independent systems are solved as if they were alone
+     *
+     * In details:
+     *   o System:  a1 * p1 * \rho1  +  a2 * p2 * \rho2 < C1
+     *              a3 * p3 * \rho3                     < C2
+     *   o consumption_weight: a1=1 ; a2=1 ; a3=1
+     *   o sharing_penalty:    p1=1 ; p2=2 ; p3=1
+     *
+     * Expectations
+     *   o rho1 = 2 * rho2 and rho1 + rho2 = C1
+     *   o rho3 = C2
+     */
+
+    lmm::Constraint* sys_cnst_1 = Sys->constraint_new(nullptr, 3);
+    lmm::Constraint* sys_cnst_2 = Sys->constraint_new(nullptr, 7);
+    lmm::Variable* rho_1        = Sys->variable_new(nullptr, 1);
+    lmm::Variable* rho_2        = Sys->variable_new(nullptr, 2);
+    lmm::Variable* rho_3        = Sys->variable_new(nullptr, 1);
+
+    Sys->expand(sys_cnst_1, rho_1, 1);
+    Sys->expand(sys_cnst_1, rho_2, 1);
+    Sys->expand(sys_cnst_2, rho_3, 1);
+    Sys->solve();
+
+    REQUIRE(double_equals(rho_1->get_value(), 2, sg_maxmin_precision));
+    REQUIRE(double_equals(rho_2->get_value(), 1, sg_maxmin_precision));
+    REQUIRE(double_equals(rho_3->get_value(), 7, sg_maxmin_precision));
+  }
+
+  SECTION("Components split when a variable leaves")
+  {
+
+    /*
+     * Removing the only variable linking two constraints splits their component
+     *
+     * In details:
+     *   o System:  \rho1 + \rho2 < C1
+     *              \rho2 + \rho3 < C2
+     *   o C1=2 ; C2=10 ; all weights and penalties are 1
+     *
+     * Expectations
+     *   o rho1 = rho2 = 1 and rho3 = 9 (rho2 is bottlenecked by C1)
+     *   o once rho2 is removed, rho1 = C1 and rho3 = C2
+     */
+
+    lmm::Constraint* sys_cnst_1 = Sys->constraint_new(nullptr, 2);
+    lmm::Constraint* sys_cnst_2 = Sys->constraint_new(nullptr, 10);
+    lmm::Variable* rho_1        = Sys->variable_new(nullptr, 1);
+    lmm::Variable* rho_2        = Sys->variable_new(nullptr, 1, -1, 2);
+    lmm::Variable* rho_3        = Sys->variable_new(nullptr, 1);
+
+    Sys->expand(sys_cnst_1, rho_1, 1);
+    Sys->expand(sys_cnst_1, rho_2, 1);
+    Sys->expand(sys_cnst_2, rho_2, 1);
+    Sys->expand(sys_cnst_2, rho_3, 1);
+    Sys->solve();
+
+    REQUIRE(sys_cnst_1->get_component() == sys_cnst_2->get_component());
+    REQUIRE(double_equals(rho_1->get_value(), 1, sg_maxmin_precision));
+    REQUIRE(double_equals(rho_2->get_value(), 1, sg_maxmin_precision));
+    REQUIRE(double_equals(rho_3->get_value(), 9, sg_maxmin_precision));
+
+    Sys->variable_free(rho_2);
+    Sys->solve();
+
+    REQUIRE(sys_cnst_1->get_component() != sys_cnst_2->get_component());
+    REQUIRE(double_equals(rho_1->get_value(), 2, sg_maxmin_precision));
+    REQUIRE(double_equals(rho_3->get_value(), 10, sg_maxmin_precision));
+  }
+
+  Sys->variable_free_all();
+  delete Sys;
+}
+
+TEST_CASE("kernel::lmm Compact systems", "[kernel-lmm-compact]")
+{
+  lmm::System* Sys     = new lmm::System(false);
+  lmm::System* Compact = new lmm::CompactSystem(false);
+
+  SECTION("Same values as the default backend")
+  {
+
+    /*
+     * Both backends saturate the constraints in the same order, so they compute the very same values
+     *
+     * In details:
+     *   o System:  a1 * p1 * \rho1  +  a2 * p2 * \rho2                     < C1
+     *              a3 * p1 * \rho1                     +  a4 * p3 * \rho3  < C2 (FATPIPE)
+     *                                   a5 * p2 * \rho2 +  a6 * p3 * \rho3  < C3
+     *   o rho3 is bounded by 4
+     */
+
+    for (lmm::System* sys : {Sys, Compact}) {
+      lmm::Constraint* cnst_1 = sys->constraint_new(nullptr, 20);
+      lmm::Constraint* cnst_2 = sys->constraint_new(nullptr, 60);
+      lmm::Constraint* cnst_3 = sys->constraint_new(nullptr, 7);
+      cnst_2->unshare();
+
+      lmm::Variable* rho_1 = sys->variable_new(nullptr, 1, -1, 2);
+      lmm::Variable* rho_2 = sys->variable_new(nullptr, 2, -1, 2);
+      lmm::Variable* rho_3 = sys->variable_new(nullptr, 1, 4, 2);
+
+      sys->expand(cnst_1, rho_1, 1);
+      sys->expand(cnst_1, rho_2, 2);
+      sys->expand(cnst_2, rho_1, 2);
+      sys->expand(cnst_2, rho_3, 1);
+      sys->expand(cnst_3, rho_2, 0.5);
+      sys->expand(cnst_3, rho_3, 1.5);
+      sys->solve();
+    }
+
+    auto var     = Sys->variable_set.begin();
+    auto compact = Compact->variable_set.begin();
+    for (; var != Sys->variable_set.end(); ++var, ++compact)
+      REQUIRE(var->get_value() == compact->get_value());
+    REQUIRE(compact == Compact->variable_set.end());
+
+    /* Both backends count the same solves and rounds, and solving an unmodified system again is free */
+    Sys->solve();
+    for (lmm::System const* sys : {Sys, Compact}) {
+      REQUIRE(sys->get_statistics().solves == 1);
+      REQUIRE(sys->get_statistics().constraints == 3);
+      REQUIRE(sys->get_statistics().elements_visited > 0);
+    }
+    REQUIRE(Sys->get_statistics().rounds == Compact->get_statistics().rounds);
+  }
+
+  SECTION("Same values after changing the system between the solves")
+  {
+
+    /*
+     * The compact backend keeps its arrays from one solve to the next, and only updates the rows of the constraints
+     * which elements changed in between: it must still compute the very same values as the default backend.
+     */
+
+    std::vector<lmm::Variable*> vars[2];
+    std::vector<lmm::Constraint*> cnsts[2];
+    lmm::System* systems[2] = {Sys, Compact};
+    auto compare = [&vars]() {
+      for (unsigned i = 0; i < vars[0].size(); i++)
+        if (vars[0][i])
+          REQUIRE(vars[0][i]->get_value() == vars[1][i]->get_value());
+    };
+
+    for (int s = 0; s < 2; s++) {
+      lmm::System* sys = systems[s];
+      for (int i = 0; i < 4; i++)
+        cnsts[s].push_back(sys->constraint_new(nullptr, 10 + 3 * i));
+      cnsts[s][3]->unshare();
+      for (int i = 0; i < 6; i++) {
+        vars[s].push_back(sys->variable_new(nullptr, 1 + i % 3, i == 2 ? 1.5 : -1, 3));
+        sys->expand(cnsts[s][i % 4], vars[s][i], 1 + 0.5 * i);
+        sys->expand(cnsts[s][(i + 1) % 4], vars[s][i], 2 - 0.25 * i);
+      }
+      sys->solve();
+    }
+    compare();
+
+    for (int s = 0; s < 2; s++) { // Remove a variable, and add another one
+      systems[s]->variable_free(vars[s][1]);
+      vars[s][1] = nullptr;
+      vars[s].push_back(systems[s]->variable_new(nullptr, 2, -1, 3));
+      systems[s]->expand(cnsts[s][0], vars[s].back(), 0.75);
+      systems[s]->expand(cnsts[s][2], vars[s].back(), 1.25);
+      systems[s]->expand(cnsts[s][3], vars[s].back(), 3);
+      systems[s]->solve();
+    }
+    compare();
+
+    for (int s = 0; s < 2; s++) { // Change a weight, then a penalty, a bound and the bound of a constraint
+      systems[s]->expand_add(cnsts[s][2], vars[s][2], 4);
+      systems[s]->solve();
+      systems[s]->update_variable_penalty(vars[s][3], 5);
+      systems[s]->update_variable_bound(vars[s][4], 0.5);
+      systems[s]->update_constraint_bound(cnsts[s][1], 2);
+      systems[s]->solve();
+    }
+    compare();
+
+    for (int s = 0; s < 2; s++) { // Disable a variable, then enable it again
+      systems[s]->update_variable_penalty(vars[s][0], 0);
+      systems[s]->solve();
+      REQUIRE(vars[s][0]->get_value() == 0);
+      systems[s]->update_variable_penalty(vars[s][0], 2);
+      systems[s]->solve();
+    }
+    compare();
+  }
+
+  Sys->variable_free_all();
+  Compact->variable_free_all();
+  delete Sys;
+  delete Compact;
+}
+
+TEST_CASE("kernel::lmm Fair bottleneck systems", "[kernel-lmm-fair-bottleneck]")
+{
+  lmm::System* Sys = new lmm::FairBottleneck(false);
+
+  SECTION("Shared and FATPIPE constraints")
+  {
+
+    /*
+     * Each round, every constraint shares its remaining capacity among its unsaturated variables
+     *
+     * In details:
+     *   o System:  rho1 + rho2          < 10
+     *              rho1 +  2 * rho3      < C2 (FATPIPE)
+     *   o rho2 is bounded by 2
+     *   o With C2=6: rho1 and rho3 get 5 and 3 in the first round, while rho2 reaches its bound; the second round
+     *     saturates both constraints with rho1 and rho3 getting 1 and 0.5 more.
+     *   o With C2=4, C2 saturates in the first round already.
+     */
+
+    lmm::Constraint* cnst_1 = Sys->constraint_new(nullptr, 10);
+    lmm::Constraint* cnst_2 = Sys->constraint_new(nullptr, 6);
+    cnst_2->unshare();
+
+    lmm::Variable* rho_1 = Sys->variable_new(nullptr, 1, -1, 2);
+    lmm::Variable* rho_2 = Sys->variable_new(nullptr, 1, 2, 1);
+    lmm::Variable* rho_3 = Sys->variable_new(nullptr, 1, -1, 1);
+
+    Sys->expand(cnst_1, rho_1, 1);
+    Sys->expand(cnst_1, rho_2, 1);
+    Sys->expand(cnst_2, rho_1, 1);
+    Sys->expand(cnst_2, rho_3, 2);
+    Sys->solve();
+
+    REQUIRE(double_equals(rho_1->get_value(), 6, sg_maxmin_precision));
+    REQUIRE(double_equals(rho_2->get_value(), 2, sg_maxmin_precision));
+    REQUIRE(double_equals(rho_3->get_value(), 3.5, sg_maxmin_precision));
+    REQUIRE(Sys->get_statistics().rounds == 2);
+
+    Sys->update_constraint_bound(cnst_2, 4);
+    Sys->solve();
+
+    REQUIRE(double_equals(rho_1->get_value(), 4, sg_maxmin_precision));
+    REQUIRE(double_equals(rho_2->get_value(), 2, sg_maxmin_precision));
+    REQUIRE(double_equals(rho_3->get_value(), 2, sg_maxmin_precision));
+    REQUIRE(Sys->get_statistics().rounds == 3);
+  }
+
+  Sys->variable_free_all();
+  delete Sys;
+}
+
+TEST_CASE("kernel::lmm Saturation heap", "[kernel-lmm-saturation-heap]")
+{
+  lmm::SaturationHeap heap;
+  std::vector<int> positions;
+
+  SECTION("Empty heap")
+  {
+    REQUIRE(heap.get_minimums(positions) == -1);
+    REQUIRE(positions.empty());
+  }
+
+  SECTION("Ties are given in increasing positions")
+  {
+    for (double ratio : {3.0, 1.0, 2.0, 1.0, 5.0, 1.0})
+      heap.push(ratio);
+    REQUIRE(heap.get_minimums(positions) == 1.0);
+    REQUIRE(positions == std::vector<int>({1, 3, 5}));
+
+    heap.update(3, 4.0);
+    heap.update(4, 0.5);
+    REQUIRE(heap.get_minimums(positions) == 0.5);
+    REQUIRE(positions == std::vector<int>({4}));
+  }
+
+  SECTION("Removal moves the last position, but not its rank among the ties")
+  {
+    for (double ratio : {3.0, 1.0, 2.0, 7.0, 2.0})
+      heap.push(ratio);
+    heap.remove(1); // position 4 (2.0) is now position 1, but still comes after position 2
+    REQUIRE(heap.get_minimums(positions) == 2.0);
+    REQUIRE(positions == std::vector<int>({2, 1}));
+
+    heap.remove(3); // last position removed
+    heap.remove(1); // position 2 (2.0) is now position 1
+    REQUIRE(heap.get_minimums(positions) == 2.0);
+    REQUIRE(positions == std::vector<int>({1}));
+
+    heap.remove(0);
+    heap.remove(0);
+    REQUIRE(heap.empty());
+  }
+}
+
+TEST_CASE("kernel::lmm Incremental solve", "[kernel-lmm-incremental]")
+{
+  /* A lazily updated system solved incrementally must compute the same values as a system fully solved each time. The
+   * bounds are not round numbers, to avoid the ties between constraints that make the sharing of fatpipes depend on
+   * rounding errors. */
+  lmm::System* Sys = new lmm::System(false);
+  lmm::System* Inc = new lmm::System(true);
+  Inc->set_incremental(true);
+  // The variables of this test are not bound to any action
+  delete Inc->modified_set_;
+  Inc->modified_set_ = nullptr;
+
+  unsigned long seed = 42;
+  auto random        = [&seed](int max) {
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    return static_cast<int>((seed >> 33) % max);
+  };
+
+  std::vector<lmm::Constraint*> sys_cnsts;
+  std::vector<lmm::Constraint*> inc_cnsts;
+  for (int i = 0; i < 20; i++) {
+    double bound = i == 0 ? 1000 : 10 + random(9000) / 99.0; // the first constraint is a backbone, rarely saturated
+    sys_cnsts.push_back(Sys->constraint_new(nullptr, bound));
+    inc_cnsts.push_back(Inc->constraint_new(nullptr, bound));
+    if (i % 7 == 6) {
+      sys_cnsts.back()->unshare();
+      inc_cnsts.back()->unshare();
+    }
+  }
+
+  std::vector<lmm::Variable*> sys_vars;
+  std::vector<lmm::Variable*> inc_vars;
+  auto add_variable = [&]() {
+    double penalty = 1 + random(3);
+    double bound   = random(4) == 0 ? 1 + random(2000) / 99.0 : -1;
+    int amount     = 1 + random(4);
+    sys_vars.push_back(Sys->variable_new(nullptr, penalty, bound, amount));
+    inc_vars.push_back(Inc->variable_new(nullptr, penalty, bound, amount));
+    for (int i = 0; i < amount; i++) {
+      int cnst      = i == 0 && random(2) ? 0 : random(sys_cnsts.size());
+      double weight = 1 + random(2);
+      Sys->expand(sys_cnsts[cnst], sys_vars.back(), weight);
+      Inc->expand(inc_cnsts[cnst], inc_vars.back(), weight);
+    }
+  };
+  for (int i = 0; i < 40; i++)
+    add_variable();
+
+  for (int step = 0; step < 300; step++) {
+    int var = random(sys_vars.size());
+    switch (random(4)) {
+      case 0:
+        add_variable();
+        break;
+      case 1:
+        Sys->variable_free(sys_vars[var]);
+        Inc->variable_free(inc_vars[var]);
+        sys_vars.erase(sys_vars.begin() + var);
+        inc_vars.erase(inc_vars.begin() + var);
+        break;
+      case 2: {
+        double bound = 1 + random(3000) / 99.0;
+        Sys->update_variable_bound(sys_vars[var], bound);
+        Inc->update_variable_bound(inc_vars[var], bound);
+        break;
+      }
+      default: {
+        int cnst     = random(sys_cnsts.size());
+        double bound = 10 + random(9000) / 99.0;
+        Sys->update_constraint_bound(sys_cnsts[cnst], bound);
+        Inc->update_constraint_bound(inc_cnsts[cnst], bound);
+        break;
+      }
+    }
+    Sys->solve();
+    Inc->solve();
+    for (unsigned i = 0; i < sys_vars.size(); i++)
+      REQUIRE(std::abs(sys_vars[i]->get_value() - inc_vars[i]->get_value()) <=
+              1e-9 * std::max(1.0, sys_vars[i]->get_value()));
+  }
+
+  Sys->variable_free_all();
+  Inc->variable_free_all();
+  delete Sys;
+  delete Inc;
+}
@@ -9,8 +9,11 @@
 #include "src/surf/surf_interface.hpp"
 #include "surf/surf.hpp"
 
+#include <algorithm>
+
 XBT_LOG_NEW_CATEGORY(kernel, "Logging specific to the internals of SimGrid");
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(resource, kernel, "Logging specific to the resources");
+XBT_LOG_NEW_SUBCATEGORY(resource_heap, resource, "Operations on the action heaps (replayed by action_heap_bench)");
 
 namespace simgrid {
 namespace kernel {
@@ -29,12 +32,14 @@ Action::Action(simgrid::kernel::resource::Model* model, double cost, bool failed
     state_set_ = get_model()->get_started_action_set();
 
   state_set_->push_back(*this);
+  get_model()->invalidate_next_event();
 }
 
 Action::~Action()
 {
   if (state_set_hook_.is_linked())
     simgrid::xbt::intrusive_erase(*state_set_, *this);
+  get_model()->invalidate_next_event();
   if (get_variable())
     get_model()->get_maxmin_system()->variable_free(get_variable());
 
@@ -44,11 +49,24 @@ Action::~Action()
     simgrid::xbt::intrusive_erase(*get_model()->get_modified_set(), *this);
 }
 
+void* Action::operator new(size_t size, Model* model)
+{
+  return model->get_action_arena().allocate(size);
+}
+
+void Action::operator delete(void* ptr)
+{
+  xbt::SlabArena::deallocate(ptr);
+}
+
 void Action::finish(Action::State state)
 {
   finish_time_ = surf_get_clock();
   set_remains(0);
-  set_state(state);
+  if (model_->is_deferring_state_changes())
+    model_->defer_state_change(this, state);
+  else
+    set_state(state);
 }
 
 Action::State Action::get_state() const
@@ -91,6 +109,7 @@ void Action::set_state(Action::State state)
   }
   if (state_set_)
     state_set_->push_back(*this);
+  model_->invalidate_next_event();
 }
 
 double Action::get_bound() const
@@ -101,11 +120,12 @@ double Action::get_bound() const
 void Action::set_bound(double bound)
 {
   XBT_IN("(%p,%g)", this, bound);
-  if (variable_)
+  /* The actions without variable are not shared: their end does not depend on their bound, and must stay in the heap */
+  if (variable_) {
     get_model()->get_maxmin_system()->update_variable_bound(variable_, bound);
-
-  if (get_model()->get_update_algorithm() == Model::UpdateAlgo::LAZY && get_last_update() != surf_get_clock())
-    get_model()->get_action_heap().remove(this);
+    if (get_model()->get_update_algorithm() == Model::UpdateAlgo::LAZY && get_last_update() != surf_get_clock())
+      get_model()->get_action_heap().remove(this);
+  }
   XBT_OUT();
 }
 
@@ -117,6 +137,7 @@ void Action::ref()
 void Action::set_max_duration(double duration)
 {
   max_duration_ = duration;
+  get_model()->invalidate_next_event();
   if (get_model()->get_update_algorithm() == Model::UpdateAlgo::LAZY) // remove action from the heap
     get_model()->get_action_heap().remove(this);
 }
@@ -195,10 +216,17 @@ void Action::update_max_duration(double delta)
 {
   if (max_duration_ != NO_MAX_DURATION)
     double_update(&max_duration_, delta, sg_surf_precision);
+  model_->invalidate_next_event();
 }
 void Action::update_remains(double delta)
 {
   double_update(&remains_, delta, sg_maxmin_precision * sg_surf_precision);
+  model_->invalidate_next_event();
+}
+void Action::set_remains(double value)
+{
+  remains_ = value;
+  model_->invalidate_next_event();
 }
 
 void Action::set_last_update()
@@ -206,39 +234,139 @@ void Action::set_last_update()
   last_update_ = surf_get_clock();
 }
 
+#if SIMGRID_HAVE_DARY_HEAP
+void ActionHeap::place(std::size_t slot, const Entry& entry)
+{
+  heap_[slot]               = entry;
+  entry.action->heap_slot_ = slot;
+}
+void ActionHeap::sift_up(std::size_t slot)
+{
+  Entry entry = heap_[slot];
+  while (slot > 0) {
+    std::size_t parent = (slot - 1) / arity;
+    if (not before(entry, heap_[parent]))
+      break;
+    place(slot, heap_[parent]);
+    slot = parent;
+  }
+  place(slot, entry);
+}
+void ActionHeap::sift_down(std::size_t slot)
+{
+  Entry entry      = heap_[slot];
+  std::size_t size = heap_.size();
+  std::size_t first;
+  while ((first = slot * arity + 1) < size) {
+    std::size_t best = first;
+    for (std::size_t child = first + 1; child < std::min(first + arity, size); child++)
+      if (before(heap_[child], heap_[best]))
+        best = child;
+    if (not before(heap_[best], entry))
+      break;
+    place(slot, heap_[best]);
+    slot = best;
+  }
+  place(slot, entry);
+}
+void ActionHeap::erase(std::size_t slot)
+{
+  heap_[slot].action->heap_slot_ = no_slot;
+  std::size_t last               = heap_.size() - 1;
+  if (slot != last) {
+    place(slot, heap_[last]);
+    heap_.pop_back();
+    if (slot > 0 && before(heap_[slot], heap_[(slot - 1) / arity]))
+      sift_up(slot);
+    else
+      sift_down(slot);
+  } else {
+    heap_.pop_back();
+  }
+}
+
+double ActionHeap::top_date() const
+{
+  return heap_.front().date;
+}
+void ActionHeap::insert(Action* action, double date, ActionHeap::Type type)
+{
+  XBT_CDEBUG(resource_heap, "%p insert %p %a", this, action, date);
+  action->type_ = type;
+  heap_.push_back({date, ++rank_, action});
+  sift_up(heap_.size() - 1);
+}
+void ActionHeap::remove(Action* action)
+{
+  action->type_ = ActionHeap::Type::unset;
+  if (action->heap_slot_ != no_slot) {
+    XBT_CDEBUG(resource_heap, "%p remove %p", this, action);
+    erase(action->heap_slot_);
+  }
+}
+void ActionHeap::update(Action* action, double date, ActionHeap::Type type)
+{
+  XBT_CDEBUG(resource_heap, "%p update %p %a", this, action, date);
+  action->type_ = type;
+  if (action->heap_slot_ != no_slot) {
+    std::size_t slot = action->heap_slot_;
+    heap_[slot].date = date;
+    heap_[slot].rank = ++rank_;
+    if (slot > 0 && before(heap_[slot], heap_[(slot - 1) / arity]))
+      sift_up(slot);
+    else
+      sift_down(slot);
+  } else {
+    heap_.push_back({date, ++rank_, action});
+    sift_up(heap_.size() - 1);
+  }
+}
+Action* ActionHeap::pop()
+{
+  Action* action = heap_.front().action;
+  XBT_CDEBUG(resource_heap, "%p pop %p", this, action);
+  erase(0);
+  return action;
+}
+#else
 double ActionHeap::top_date() const
 {
-  return top().first;
+  return heap_.top().first;
 }
 void ActionHeap::insert(Action* action, double date, ActionHeap::Type type)
 {
+  XBT_CDEBUG(resource_heap, "%p insert %p %a", this, action, date);
   action->type_      = type;
-  action->heap_hook_ = emplace(std::make_pair(date, action));
+  action->heap_hook_ = heap_.emplace(std::make_pair(date, action));
 }
 void ActionHeap::remove(Action* action)
 {
   action->type_ = ActionHeap::Type::unset;
   if (action->heap_hook_) {
-    erase(*action->heap_hook_);
+    XBT_CDEBUG(resource_heap, "%p remove %p", this, action);
+    heap_.erase(*action->heap_hook_);
     action->heap_hook_ = boost::none;
   }
 }
 void ActionHeap::update(Action* action, double date, ActionHeap::Type type)
 {
+  XBT_CDEBUG(resource_heap, "%p update %p %a", this, action, date);
   action->type_ = type;
   if (action->heap_hook_) {
-    heap_type::update(*action->heap_hook_, std::make_pair(date, action));
+    heap_.update(*action->heap_hook_, std::make_pair(date, action));
   } else {
-    action->heap_hook_ = emplace(std::make_pair(date, action));
+    action->heap_hook_ = heap_.emplace(std::make_pair(date, action));
   }
 }
 Action* ActionHeap::pop()
 {
-  Action* action = top().second;
-  heap_type::pop();
+  Action* action = heap_.top().second;
+  XBT_CDEBUG(resource_heap, "%p pop %p", this, action);
+  heap_.pop();
   action->heap_hook_ = boost::none;
   return action;
 }
+#endif
 
 } // namespace surf
 } // namespace kernel
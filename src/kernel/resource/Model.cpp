@@ -5,6 +5,8 @@
 
 #include "simgrid/kernel/resource/Model.hpp"
 #include "src/kernel/lmm/maxmin.hpp"
+#include "xbt/backtrace.hpp"
+#include "xbt/xbt_os_time.h"
 
 XBT_LOG_EXTERNAL_DEFAULT_CATEGORY(resource);
 
@@ -26,6 +28,81 @@ void Model::set_maxmin_system(lmm::System* system)
   maxmin_system_.reset(system);
 }
 
+double Model::timed_next_occuring_event(double now)
+{
+  double start = xbt_os_time();
+  double res   = next_occuring_event(now);
+  next_event_calls_++;
+  next_event_time_ += xbt_os_time() - start;
+  return res;
+}
+
+void Model::timed_update_actions_state(double now, double delta)
+{
+  double start = xbt_os_time();
+  update_actions_state(now, delta);
+  update_calls_++;
+  update_time_ += xbt_os_time() - start;
+  next_event_valid_ = false;
+}
+
+double Model::poll_next_occuring_event(double now)
+{
+  if (next_occuring_event_is_cacheable() && not maxmin_system_->modified_) {
+    /* Nothing to share again: the lazy models find their next event on top of their heap, as
+     * next_occuring_event_lazy() would do, while the full ones did not change since the previous poll */
+    if (update_algorithm_ == UpdateAlgo::LAZY && maxmin_system_->modified_set_->empty()) {
+      next_event_skips_++;
+      return action_heap_.empty() ? -1 : action_heap_.top_date() - now;
+    }
+    if (update_algorithm_ == UpdateAlgo::FULL && next_event_valid_) {
+      next_event_skips_++;
+      return next_event_delay_;
+    }
+  }
+  next_event_delay_ = timed_next_occuring_event(now);
+  next_event_valid_ = true;
+  return next_event_delay_;
+}
+
+void Model::poll_update_actions_state(double now, double delta)
+{
+  if (next_occuring_event_is_cacheable() && started_action_set_.empty() && action_heap_.empty()) {
+    update_skips_++;
+    return;
+  }
+  timed_update_actions_state(now, delta);
+}
+
+void Model::apply_deferred_state_changes()
+{
+  defer_state_changes_ = false;
+  for (auto const& change : deferred_state_changes_)
+    change.first->set_state(change.second);
+  deferred_state_changes_.clear();
+}
+
+ModelStatistics Model::get_statistics() const
+{
+  ModelStatistics stats;
+  stats.name = xbt::demangle(typeid(*this).name()).get();
+  if (maxmin_system_) {
+    const lmm::SolverStatistics& solver = maxmin_system_->get_statistics();
+    stats.solves                        = solver.solves;
+    stats.rounds                        = solver.rounds;
+    stats.constraints                   = solver.constraints;
+    stats.elements_visited              = solver.elements_visited;
+    stats.solve_time                    = solver.solve_time;
+  }
+  stats.next_event_calls = next_event_calls_;
+  stats.next_event_time  = next_event_time_;
+  stats.update_calls     = update_calls_;
+  stats.update_time      = update_time_;
+  stats.next_event_skips = next_event_skips_;
+  stats.update_skips     = update_skips_;
+  return stats;
+}
+
 double Model::next_occuring_event(double now)
 {
   // FIXME: set the good function once and for all
@@ -107,7 +184,7 @@ double Model::next_occuring_event_full(double /*now*/)
   double min = -1;
 
   for (Action& action : *get_started_action_set()) {
-    double value = action.get_variable()->get_value();
+    double value = action.get_variable() ? action.get_variable()->get_value() : 0.0;
     if (value > 0) {
       if (action.get_remains() > 0)
         value = action.get_remains_no_update() / value;
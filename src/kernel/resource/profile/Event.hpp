@@ -8,6 +8,8 @@
 
 #include "simgrid/forward.h"
 
+#include <cstddef>
+
 namespace simgrid {
 namespace kernel {
 namespace profile {
@@ -18,6 +20,10 @@ public:
   unsigned int idx;
   resource::Resource* resource;
   bool free_me;
+
+  /* The events are carved out of a slab arena */
+  static void* operator new(std::size_t size);
+  static void operator delete(void* ptr);
 };
 } // namespace profile
 } // namespace kernel
@@ -7,48 +7,166 @@
 #include "src/kernel/resource/profile/Event.hpp"
 #include "src/kernel/resource/profile/Profile.hpp"
 
+#include <algorithm>
+
 namespace simgrid {
 namespace kernel {
 namespace profile {
 
 simgrid::kernel::profile::FutureEvtSet future_evt_set; // FIXME: singleton antipattern
 
+void FutureEvtSet::Bucket::insert(const Qelt& elt)
+{
+  auto pos = std::upper_bound(events.begin() + first, events.end(), elt);
+  if (pos == events.begin() + first && first > 0)
+    events[--first] = elt;
+  else
+    events.insert(pos, elt);
+}
+
+void FutureEvtSet::Bucket::pop_front()
+{
+  first++;
+  if (first == events.size()) {
+    events.clear(); // keep the capacity for the next events
+    first = 0;
+  } else if (first >= 32 && 2 * first >= events.size()) {
+    events.erase(events.begin(), events.begin() + first);
+    first = 0;
+  }
+}
+
 FutureEvtSet::FutureEvtSet() = default;
 FutureEvtSet::~FutureEvtSet()
 {
-  while (not heap_.empty()) {
-    delete heap_.top().second;
-    heap_.pop();
+  for (Bucket const& bucket : buckets_)
+    for (auto elt = bucket.events.begin() + bucket.first; elt != bucket.events.end(); ++elt)
+      delete elt->second;
+}
+
+std::size_t FutureEvtSet::bucket_of(double day) const
+{
+  if (day < 9007199254740992.0) // 2^53: every day up to there is exactly represented
+    return static_cast<std::size_t>(static_cast<unsigned long long>(day)) & (buckets_.size() - 1);
+  return static_cast<std::size_t>(std::fmod(day, buckets_.size()));
+}
+
+/** @brief Finds the bucket of the next occurring event (there must be one) */
+std::size_t FutureEvtSet::first_bucket() const
+{
+  if (first_known_)
+    return first_bucket_;
+
+  /* Visit the days of the coming year, in order */
+  for (std::size_t i = 0; i < buckets_.size(); i++) {
+    Bucket const& bucket = buckets_[current_bucket_];
+    if (not bucket.empty() && day_of(bucket.front().first) <= current_day_) {
+      first_bucket_ = current_bucket_;
+      first_known_  = true;
+      return first_bucket_;
+    }
+    current_bucket_ = (current_bucket_ + 1) & (buckets_.size() - 1);
+    current_day_ += 1;
+  }
+
+  /* Nothing for a whole year: directly search the earliest event, and restart the calendar from its day */
+  std::size_t earliest = buckets_.size();
+  for (std::size_t i = 0; i < buckets_.size(); i++)
+    if (not buckets_[i].empty() && (earliest == buckets_.size() || buckets_[i].front() < buckets_[earliest].front()))
+      earliest = i;
+  current_bucket_ = earliest;
+  current_day_    = day_of(buckets_[earliest].front().first);
+  first_bucket_   = earliest;
+  first_known_    = true;
+  return first_bucket_;
+}
+
+/** @brief Redistributes the events over that amount of buckets, with a width of day fitting their spacing */
+void FutureEvtSet::resize(std::size_t nb_buckets)
+{
+  std::vector<Qelt> events;
+  events.reserve(size_);
+  for (Bucket const& bucket : buckets_)
+    events.insert(events.end(), bucket.events.begin() + bucket.first, bucket.events.end());
+
+  /* As advised by Brown, a day lasts 3 times the average spacing of the next events, not counting the large gaps */
+  std::size_t sample = std::min<std::size_t>(events.size(), 25);
+  if (sample > 0) {
+    std::nth_element(events.begin(), events.begin() + (sample - 1), events.end());
+    std::sort(events.begin(), events.begin() + (sample - 1));
+  }
+  if (sample > 1) {
+    double average = (events[sample - 1].first - events[0].first) / (sample - 1);
+    double total   = 0.0;
+    int gaps       = 0;
+    for (std::size_t i = 1; i < sample; i++) {
+      double gap = events[i].first - events[i - 1].first;
+      if (gap <= 2 * average) {
+        total += gap;
+        gaps++;
+      }
+    }
+    if (total > 0)
+      width_ = 3 * total / gaps;
+  }
+
+  buckets_.clear();
+  buckets_.resize(nb_buckets);
+  for (Qelt const& elt : events)
+    buckets_[bucket_of(day_of(elt.first))].insert(elt);
+  first_known_ = false;
+  if (not events.empty()) {
+    current_day_    = day_of(events[0].first);
+    current_bucket_ = bucket_of(current_day_);
   }
 }
 
 /** @brief Schedules an event to a future date */
 void FutureEvtSet::add_event(double date, Event* evt)
 {
-  heap_.emplace(date, evt);
+  Qelt elt(date, evt);
+  bool is_first = size_ == 0 || (first_known_ && elt < buckets_[first_bucket_].front());
+  double day    = day_of(date);
+  std::size_t b = bucket_of(day);
+  buckets_[b].insert(elt);
+  if (size_ == 0 || day < current_day_) {
+    current_day_    = day;
+    current_bucket_ = b;
+  }
+  if (is_first) {
+    first_bucket_ = b;
+    first_known_  = true;
+  }
+  size_++;
+  if (size_ > 2 * buckets_.size())
+    resize(2 * buckets_.size());
 }
 
 /** @brief returns the date of the next occurring event (or -1 if empty) */
 double FutureEvtSet::next_date() const
 {
-  return heap_.empty() ? -1.0 : heap_.top().first;
+  return size_ == 0 ? -1.0 : buckets_[first_bucket()].front().first;
 }
 
 /** @brief Retrieves the next occurring event, or nullptr if none happens before date */
 Event* FutureEvtSet::pop_leq(double date, double* value, resource::Resource** resource)
 {
   double event_date = next_date();
-  if (event_date > date || heap_.empty())
+  if (event_date > date || size_ == 0)
     return nullptr;
 
-  Event* event       = heap_.top().second;
+  Event* event       = buckets_[first_bucket()].front().second;
   Profile* profile   = event->profile;
-  DatedValue dateVal = profile->next(event);
+  DatedValue dateVal = profile->next(event); // may schedule the next occurrence, that comes after this one
 
   *resource = event->resource;
   *value    = dateVal.value_;
 
-  heap_.pop();
+  buckets_[first_bucket()].pop_front();
+  first_known_ = false;
+  size_--;
+  if (buckets_.size() > min_buckets && size_ < buckets_.size() / 2)
+    resize(buckets_.size() / 2);
 
   return event;
 }
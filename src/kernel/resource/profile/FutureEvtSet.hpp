@@ -7,14 +7,23 @@
 #define FUTUREEVTSET_HPP
 
 #include "simgrid/forward.h"
-#include <queue>
+#include <cmath>
+#include <vector>
 
 namespace simgrid {
 namespace kernel {
 namespace profile {
 
 /** @brief Future Event Set (collection of iterators over the traces)
- * That's useful to quickly know which is the next occurring event in a set of traces. */
+ * That's useful to quickly know which is the next occurring event in a set of traces.
+ *
+ * This is a calendar queue (R. Brown, 1988). The time is cut in days of the same width, and each day is hashed in an
+ * array of buckets, that are sorted. Looking for the next event only checks the buckets of the next days, so adding
+ * and retrieving events takes a constant amortized time as long as the amount of buckets and the width of the days
+ * follow the amount of events and their spacing. Both are adapted whenever the amount of events doubles or halves.
+ *
+ * Events of the same date are retrieved by increasing address, as with the binary heap used before.
+ */
 class XBT_PUBLIC FutureEvtSet {
 public:
   FutureEvtSet();
@@ -24,10 +33,34 @@ public:
   double next_date() const;
   Event* pop_leq(double date, double* value, resource::Resource** resource);
   void add_event(double date, Event* evt);
+  std::size_t size() const { return size_; }
 
 private:
   typedef std::pair<double, Event*> Qelt;
-  std::priority_queue<Qelt, std::vector<Qelt>, std::greater<Qelt>> heap_;
+  struct Bucket {
+    std::vector<Qelt> events; // sorted; the ones before the first one were already retrieved
+    std::size_t first = 0;
+    bool empty() const { return first == events.size(); }
+    const Qelt& front() const { return events[first]; }
+    void insert(const Qelt& elt);
+    void pop_front();
+  };
+  static constexpr std::size_t min_buckets = 16;
+
+  double day_of(double date) const { return std::floor(date / width_); }
+  std::size_t bucket_of(double day) const;
+  std::size_t first_bucket() const;
+  void resize(std::size_t nb_buckets);
+
+  std::vector<Bucket> buckets_ = std::vector<Bucket>(min_buckets);
+  double width_                = 1.0;
+  std::size_t size_            = 0;
+  /* Where the search of the next event starts: no event is scheduled before that day */
+  mutable std::size_t current_bucket_ = 0;
+  mutable double current_day_         = 0.0;
+  /* Bucket of the next event, if known */
+  mutable std::size_t first_bucket_ = 0;
+  mutable bool first_known_         = false;
 };
 
 // FIXME: kill that singleton
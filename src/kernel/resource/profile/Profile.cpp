@@ -5,31 +5,68 @@
 
 #include "src/kernel/resource/profile/Profile.hpp"
 #include "simgrid/forward.h"
+#include "src/internal_config.h"
 #include "src/kernel/resource/profile/DatedValue.hpp"
 #include "src/kernel/resource/profile/Event.hpp"
 #include "src/kernel/resource/profile/FutureEvtSet.hpp"
 #include "src/surf/surf_interface.hpp"
+#include "xbt/slab_arena.hpp"
 
 #include <boost/algorithm/string.hpp>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <ostream>
 #include <sstream>
 #include <unordered_map>
 #include <vector>
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
 
 static std::unordered_map<std::string, simgrid::kernel::profile::Profile*> trace_list;
 
+namespace {
+/* Binary profiles start with that header, followed by the dated values as they are stored in Profile::event_list */
+constexpr char binary_magic[8]            = {'S', 'G', 'P', 'R', 'O', 'F', '0', '1'};
+constexpr std::uint64_t binary_byte_order = 0x0102030405060708ULL;
+constexpr std::size_t binary_record_size  = 2 * sizeof(double);
+struct BinaryHeader {
+  char magic[8];
+  std::uint64_t byte_order; // binary_byte_order, as written by the machine that produced the file
+  std::uint64_t nb_values;
+};
+} // namespace
+
 namespace simgrid {
 namespace kernel {
 namespace profile {
 
+void* Event::operator new(std::size_t size)
+{
+  static xbt::SlabArena* arena = new xbt::SlabArena("profile events"); // never freed: events may outlive main()
+  return arena->allocate(size);
+}
+
+void Event::operator delete(void* ptr)
+{
+  xbt::SlabArena::deallocate(ptr);
+}
+
 Profile::Profile()
 {
   /* Add the first fake event storing the time at which the trace begins */
   DatedValue val(0, -1);
   event_list.push_back(val);
 }
-Profile::~Profile() = default;
+Profile::~Profile()
+{
+#if HAVE_MMAP
+  if (mapping_)
+    munmap(const_cast<unsigned char*>(mapping_), mapping_size_);
+#endif
+}
 
 /** @brief Register this profile for that resource onto that FES,
  * and get an iterator over the integrated trace  */
@@ -41,7 +78,7 @@ Event* Profile::schedule(FutureEvtSet* fes, resource::Resource* resource)
   event->resource = resource;
   event->free_me  = false;
 
-  xbt_assert((event->idx < event_list.size()), "Your profile should have at least one event!");
+  xbt_assert((event->idx < size()), "Your profile should have at least one event!");
 
   fes_ = fes;
   fes_->add_event(0.0 /* start time */, event);
@@ -53,9 +90,9 @@ Event* Profile::schedule(FutureEvtSet* fes, resource::Resource* resource)
 DatedValue Profile::next(Event* event)
 {
   double event_date  = fes_->next_date();
-  DatedValue dateVal = event_list.at(event->idx);
+  DatedValue dateVal = at(event->idx);
 
-  if (event->idx < event_list.size() - 1) {
+  if (event->idx < size() - 1) {
     fes_->add_event(event_date + dateVal.date_, event);
     event->idx++;
   } else if (dateVal.date_ > 0) { /* Last element. Shall we loop? */
@@ -69,6 +106,12 @@ DatedValue Profile::next(Event* event)
 }
 
 Profile* Profile::from_string(const std::string& name, const std::string& input, double periodicity)
+{
+  std::istringstream stream(input);
+  return from_stream(name, stream, periodicity);
+}
+
+Profile* Profile::from_stream(const std::string& name, std::istream& input, double periodicity)
 {
   int linecount                                    = 0;
   simgrid::kernel::profile::Profile* profile       = new simgrid::kernel::profile::Profile();
@@ -76,9 +119,8 @@ Profile* Profile::from_string(const std::string& name, const std::string& input,
 
   xbt_assert(trace_list.find(name) == trace_list.end(), "Refusing to define trace %s twice", name.c_str());
 
-  std::vector<std::string> list;
-  boost::split(list, input, boost::is_any_of("\n\r"));
-  for (auto val : list) {
+  std::string val;
+  while (std::getline(input, val)) {
     simgrid::kernel::profile::DatedValue event;
     linecount++;
     boost::trim(val);
@@ -90,11 +132,11 @@ Profile* Profile::from_string(const std::string& name, const std::string& input,
       continue;
 
     XBT_ATTRIB_UNUSED int res = sscanf(val.c_str(), "%lg  %lg\n", &event.date_, &event.value_);
-    xbt_assert(res == 2, "%s:%d: Syntax error in trace\n%s", name.c_str(), linecount, input.c_str());
+    xbt_assert(res == 2, "%s:%d: Syntax error in trace\n%s", name.c_str(), linecount, val.c_str());
 
     xbt_assert(last_event->date_ <= event.date_,
                "%s:%d: Invalid trace: Events must be sorted, but time %g > time %g.\n%s", name.c_str(), linecount,
-               last_event->date_, event.date_, input.c_str());
+               last_event->date_, event.date_, val.c_str());
     last_event->date_ = event.date_ - last_event->date_;
 
     profile->event_list.push_back(event);
@@ -112,19 +154,105 @@ Profile* Profile::from_string(const std::string& name, const std::string& input,
 
   return profile;
 }
+
 Profile* Profile::from_file(const std::string& path)
 {
   xbt_assert(not path.empty(), "Cannot parse a trace from an empty filename");
-  xbt_assert(trace_list.find(path) == trace_list.end(), "Refusing to define trace %s twice", path.c_str());
+  auto known = trace_list.find(path);
+  if (known != trace_list.end()) // the resources using the same file share its profile
+    return known->second;
+
+  std::FILE* file = surf_fopen(path, "rb");
+  if (file == nullptr)
+    xbt_die("Cannot open file '%s' (path=%s)", path.c_str(), (boost::join(surf_path, ":")).c_str());
+  char magic[sizeof binary_magic];
+  if (std::fread(magic, 1, sizeof magic, file) == sizeof magic && std::memcmp(magic, binary_magic, sizeof magic) == 0) {
+    Profile* profile = from_binary_file(path, file);
+    std::fclose(file);
+    trace_list.insert({path, profile});
+    return profile;
+  }
+  std::fclose(file);
 
   std::ifstream* f = surf_ifsopen(path);
   xbt_assert(not f->fail(), "Cannot open file '%s' (path=%s)", path.c_str(), (boost::join(surf_path, ":")).c_str());
-
-  std::stringstream buffer;
-  buffer << f->rdbuf();
+  Profile* profile = Profile::from_stream(path, *f, -1);
   delete f;
 
-  return Profile::from_string(path, buffer.str(), -1);
+  return profile;
+}
+
+Profile* Profile::from_binary_file(const std::string& name, std::FILE* file)
+{
+  BinaryHeader header;
+  std::rewind(file);
+  if (std::fread(&header, sizeof header, 1, file) != 1)
+    xbt_die("%s: Truncated binary profile", name.c_str());
+  if (header.byte_order != binary_byte_order)
+    xbt_die("%s: This binary profile comes from a machine of another endianness", name.c_str());
+  long end = std::fseek(file, 0, SEEK_END) == 0 ? std::ftell(file) : -1;
+  if (end < 0)
+    xbt_die("%s: Cannot get the size of the binary profile: %s", name.c_str(), strerror(errno));
+  auto file_size = static_cast<unsigned long long>(end);
+  /* Compare by division, as the amount of values announced may be large enough to overflow the multiplication */
+  unsigned long long data_size = file_size - sizeof header;
+  if (file_size <= sizeof header || data_size % binary_record_size != 0 || header.nb_values == 0 ||
+      header.nb_values != data_size / binary_record_size)
+    xbt_die("%s: Corrupted binary profile (%llu values announced in %llu bytes)", name.c_str(),
+            static_cast<unsigned long long>(header.nb_values), file_size);
+
+  Profile* profile = new Profile();
+  profile->event_list.clear();
+#if HAVE_MMAP
+  void* mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+  if (mapping == MAP_FAILED)
+    xbt_die("%s: Cannot map the binary profile: %s", name.c_str(), strerror(errno));
+  profile->mapping_      = static_cast<const unsigned char*>(mapping);
+  profile->mapping_size_ = file_size;
+  profile->nb_mapped_    = header.nb_values;
+#else
+  profile->event_list.resize(header.nb_values);
+  std::fseek(file, sizeof header, SEEK_SET);
+  for (DatedValue& val : profile->event_list) {
+    if (std::fread(&val.date_, sizeof val.date_, 1, file) != 1 ||
+        std::fread(&val.value_, sizeof val.value_, 1, file) != 1)
+      xbt_die("%s: Cannot read the binary profile", name.c_str());
+  }
+#endif
+  return profile;
+}
+
+DatedValue Profile::at(std::size_t i) const
+{
+  if (not mapping_)
+    return event_list.at(i);
+  xbt_assert(i < nb_mapped_, "Value %zu of a profile of %zu values", i, nb_mapped_);
+  DatedValue val;
+  const unsigned char* record = mapping_ + sizeof(BinaryHeader) + i * binary_record_size;
+  std::memcpy(&val.date_, record, sizeof val.date_);
+  std::memcpy(&val.value_, record + sizeof val.date_, sizeof val.value_);
+  return val;
+}
+
+/** @brief Writes the profile in the binary format, that from_file() maps in memory */
+void Profile::save_binary(const std::string& path) const
+{
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr)
+    xbt_die("Cannot create file '%s': %s", path.c_str(), strerror(errno));
+  BinaryHeader header;
+  std::memcpy(header.magic, binary_magic, sizeof binary_magic);
+  header.byte_order = binary_byte_order;
+  header.nb_values  = size();
+  bool ok           = std::fwrite(&header, sizeof header, 1, file) == 1;
+  for (std::size_t i = 0; ok && i < size(); i++) {
+    DatedValue val = at(i);
+    ok = std::fwrite(&val.date_, sizeof val.date_, 1, file) == 1 &&
+         std::fwrite(&val.value_, sizeof val.value_, 1, file) == 1;
+  }
+  ok = std::fclose(file) == 0 && ok;
+  if (not ok)
+    xbt_die("Cannot write file '%s': %s", path.c_str(), strerror(errno));
 }
 
 } // namespace profile
@@ -10,7 +10,10 @@
 #include "src/kernel/resource/profile/DatedValue.hpp"
 #include "src/kernel/resource/profile/FutureEvtSet.hpp"
 
+#include <cstdio>
+#include <iosfwd>
 #include <queue>
+#include <string>
 #include <vector>
 
 namespace simgrid {
@@ -22,6 +25,10 @@ namespace profile {
  * It is useful to model dynamic platforms, where an external load that makes the resource availability change over
  * time. To model that, you have to set several profiles per resource: one for the on/off state and one for each
  * numerical value (computational speed, bandwidth and/or latency).
+ *
+ * The profiles are either parsed from text, or mapped from a file in the binary format written by save_binary(), in
+ * which case their dated values are only decoded when needed. Every file is only loaded once, and the resources using
+ * it share its profile.
  */
 class XBT_PUBLIC Profile {
 public:
@@ -31,13 +38,25 @@ public:
   Event* schedule(FutureEvtSet* fes, resource::Resource* resource);
   DatedValue next(Event* event);
 
+  /** Amount of dated values, including the first one that stores the date of the second one */
+  std::size_t size() const { return mapping_ ? nb_mapped_ : event_list.size(); }
+  /** The i-th dated value, whose date_ is the delay until the next one (or -1 after the last one, if not looping) */
+  DatedValue at(std::size_t i) const;
+  void save_binary(const std::string& path) const;
+
   static Profile* from_file(const std::string& path);
   static Profile* from_string(const std::string& name, const std::string& input, double periodicity);
+  static Profile* from_stream(const std::string& name, std::istream& input, double periodicity);
   // private:
-  std::vector<DatedValue> event_list;
+  std::vector<DatedValue> event_list; // only used by the profiles that are not mapped from a binary file
 
 private:
+  static Profile* from_binary_file(const std::string& name, std::FILE* file);
+
   FutureEvtSet* fes_ = nullptr;
+  const unsigned char* mapping_ = nullptr; // records of the binary file
+  std::size_t mapping_size_     = 0;
+  std::size_t nb_mapped_        = 0;
 };
 
 } // namespace profile
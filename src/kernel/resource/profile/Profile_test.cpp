@@ -14,7 +14,15 @@
 #include "xbt/log.h"
 #include "xbt/misc.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <map>
+#include <queue>
+#include <random>
+#include <set>
+#include <string>
+#include <unistd.h>
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(unit, "Unit tests of the Trace Manager");
 
@@ -30,14 +38,11 @@ public:
   bool is_used() override { return true; }
 };
 
-static std::vector<simgrid::kernel::profile::DatedValue> trace2vector(const char* str)
+static std::vector<simgrid::kernel::profile::DatedValue> profile2vector(simgrid::kernel::profile::Profile* trace)
 {
   std::vector<simgrid::kernel::profile::DatedValue> res;
-  simgrid::kernel::profile::Profile* trace = simgrid::kernel::profile::Profile::from_string("TheName", str, 0);
-  XBT_VERB("---------------------------------------------------------");
-  XBT_VERB("data>>\n%s<<data\n", str);
-  for (auto const& evt : trace->event_list)
-    XBT_VERB("event: d:%lg v:%lg", evt.date_, evt.value_);
+  for (std::size_t i = 0; i < trace->size(); i++)
+    XBT_VERB("event: d:%lg v:%lg", trace->at(i).date_, trace->at(i).value_);
 
   MockedResource daResource;
   simgrid::kernel::profile::FutureEvtSet fes;
@@ -63,6 +68,34 @@ static std::vector<simgrid::kernel::profile::DatedValue> trace2vector(const char
   return res;
 }
 
+static std::vector<simgrid::kernel::profile::DatedValue> trace2vector(const char* str)
+{
+  simgrid::kernel::profile::Profile* trace = simgrid::kernel::profile::Profile::from_string("TheName", str, 0);
+  XBT_VERB("---------------------------------------------------------");
+  XBT_VERB("data>>\n%s<<data\n", str);
+  return profile2vector(trace);
+}
+
+/* Saves the profile in the binary format, and reads it back */
+static std::vector<simgrid::kernel::profile::DatedValue> trace2binary2vector(const char* str)
+{
+  simgrid::kernel::profile::Profile* trace = simgrid::kernel::profile::Profile::from_string("TheName", str, 0);
+  char cwd[4096];
+  REQUIRE(getcwd(cwd, sizeof cwd) != nullptr);
+  std::string path = std::string(cwd) + "/Profile_test.bin";
+  trace->save_binary(path);
+
+  simgrid::kernel::profile::Profile* binary = simgrid::kernel::profile::Profile::from_file(path);
+  REQUIRE(binary != trace);
+  REQUIRE(simgrid::kernel::profile::Profile::from_file(path) == binary); // loaded once, and then shared
+  REQUIRE(binary->size() == trace->size());
+  for (std::size_t i = 0; i < trace->size(); i++)
+    REQUIRE(binary->at(i) == trace->at(i));
+  std::remove(path.c_str()); // the mapping remains valid
+
+  return profile2vector(binary);
+}
+
 TEST_CASE("kernel::profile: Resource profiles, defining the external load", "kernel::profile")
 {
 
@@ -144,3 +177,100 @@ TEST_CASE("kernel::profile: Resource profiles, defining the external load", "ker
     REQUIRE(want == got);
   }
 }
+
+/* Schedules many profiles on a future event set, and checks that their events are retrieved in the order of the
+ * binary heap that the future event sets used to be: by date, then by address of the event */
+static void check_event_order(int nb_profiles, int nb_events, int max_date, bool with_outliers)
+{
+  typedef std::pair<double, simgrid::kernel::profile::Event*> Qelt;
+  std::priority_queue<Qelt, std::vector<Qelt>, std::greater<Qelt>> reference;
+  std::map<Qelt, double> values;
+  std::mt19937 rng(42);
+
+  MockedResource daResource;
+  simgrid::kernel::profile::FutureEvtSet fes;
+  for (int i = 0; i < nb_profiles; i++) {
+    /* Distinct integer dates, so that many events of different profiles happen at the same date */
+    std::set<double> date_set;
+    while (date_set.size() < static_cast<size_t>(nb_events))
+      date_set.insert(1 + rng() % max_date);
+    std::vector<double> dates(date_set.begin(), date_set.end());
+    if (with_outliers && i % 10 == 0)
+      dates.back() = 1e6 + rng() % 1000;
+    std::string input;
+    for (int j = 0; j < nb_events; j++)
+      input += std::to_string(dates[j]) + " " + std::to_string(i * nb_events + j) + "\n";
+
+    simgrid::kernel::profile::Profile* profile =
+        simgrid::kernel::profile::Profile::from_string("Profile " + std::to_string(i), input, 0);
+    simgrid::kernel::profile::Event* event = profile->schedule(&fes, &daResource);
+    reference.emplace(0.0, event);
+    values[Qelt(0.0, event)] = -1;
+    for (int j = 0; j < nb_events; j++) {
+      reference.emplace(dates[j], event);
+      values[Qelt(dates[j], event)] = i * nb_events + j;
+    }
+  }
+  REQUIRE(fes.size() == static_cast<size_t>(nb_profiles));
+
+  while (fes.next_date() >= 0) {
+    REQUIRE_FALSE(reference.empty());
+    Qelt expected = reference.top();
+    reference.pop();
+    REQUIRE(fes.next_date() == expected.first);
+
+    double value;
+    simgrid::kernel::resource::Resource* resource;
+    simgrid::kernel::profile::Event* event = fes.pop_leq(expected.first, &value, &resource);
+    REQUIRE(event == expected.second);
+    REQUIRE(resource == &daResource);
+    REQUIRE(value == values[expected]);
+    REQUIRE(fes.pop_leq(expected.first - 0.5, &value, &resource) == nullptr);
+    tmgr_trace_event_unref(&event);
+  }
+  REQUIRE(reference.empty());
+  REQUIRE(fes.size() == 0);
+  tmgr_finalize();
+}
+
+TEST_CASE("kernel::profile: Binary profiles", "kernel::profile")
+{
+  SECTION("One event no loop")
+  {
+    std::vector<simgrid::kernel::profile::DatedValue> got = trace2binary2vector("9.0 3.0\n");
+
+    std::vector<simgrid::kernel::profile::DatedValue> want;
+    want.push_back(simgrid::kernel::profile::DatedValue(9, 3));
+    REQUIRE(want == got);
+  }
+
+  SECTION("Two events, looping")
+  {
+    const char* input = "1.0 1.0\n"
+                        "3.0 3.0\n"
+                        "LOOPAFTER 2\n";
+    std::vector<simgrid::kernel::profile::DatedValue> want = trace2vector(input);
+    std::vector<simgrid::kernel::profile::DatedValue> got  = trace2binary2vector(input);
+    REQUIRE(want.size() == 8);
+    REQUIRE(want == got);
+  }
+
+  SECTION("Many events")
+  {
+    std::string input;
+    for (int i = 0; i < 1000; i++)
+      input += std::to_string(i * 0.02) + " " + std::to_string(i % 7 + 0.5) + "\n";
+    std::vector<simgrid::kernel::profile::DatedValue> want = trace2vector(input.c_str());
+    std::vector<simgrid::kernel::profile::DatedValue> got  = trace2binary2vector(input.c_str());
+    REQUIRE(want.size() == 1000);
+    REQUIRE(want == got);
+  }
+}
+
+TEST_CASE("kernel::profile: Future event sets retrieve the events in order", "kernel::profile")
+{
+  SECTION("A few profiles") { check_event_order(5, 3, 10, false); }
+  SECTION("Many profiles, many events at the same dates") { check_event_order(2000, 20, 100, false); }
+  SECTION("Many profiles, sparse dates") { check_event_order(1000, 10, 1000000, false); }
+  SECTION("Many profiles, with events far in the future") { check_event_order(1000, 10, 100, true); }
+}
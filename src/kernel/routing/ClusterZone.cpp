@@ -6,11 +6,18 @@
 #include "simgrid/kernel/routing/ClusterZone.hpp"
 #include "simgrid/kernel/routing/NetPoint.hpp"
 #include "simgrid/kernel/routing/RoutedZone.hpp"
+#include "simgrid/s4u/Engine.hpp"
+#include "simgrid/simix.hpp"
+#include "src/kernel/EngineImpl.hpp"
 #include "src/surf/network_interface.hpp"
 #include "src/surf/xml/platf_private.hpp" // FIXME: RouteCreationArgs and friends
 
+#include <algorithm>
+
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(surf_route_cluster, surf, "Routing part of surf");
 
+bool sg_lazy_clusters = false; /* Change this with --cfg=routing/lazy-clusters:yes */
+
 /* This routing is specifically setup to represent clusters, aka homogeneous sets of machines
  * Note that a router is created, easing the interconnexion with the rest of the world. */
 
@@ -22,6 +29,34 @@ ClusterZone::ClusterZone(NetZoneImpl* father, const std::string& name, resource:
 {
 }
 
+ClusterZone::~ClusterZone()
+{
+  if (lazy_args_ != nullptr) {
+    delete lazy_args_->radicals;
+    delete lazy_args_->properties;
+    delete lazy_args_;
+  }
+}
+
+int ClusterZone::add_component(NetPoint* elm)
+{
+  if (creating_rank_ >= 0) // A lazy node, that gets the id reserved for its rank
+    return add_component_at(elm, creating_rank_);
+  return NetZoneImpl::add_component(elm);
+}
+
+std::vector<s4u::Host*> ClusterZone::get_all_hosts()
+{
+  if (lazy_count_ > 0) // The nodes are created by the maestro, even when an actor asks for them
+    kernel::actor::simcall([this] { create_all_lazy_nodes(); });
+  return NetZoneImpl::get_all_hosts();
+}
+
+int ClusterZone::get_host_count()
+{
+  return NetZoneImpl::get_host_count() + lazy_count_;
+}
+
 void ClusterZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArgs* route, double* lat)
 {
   XBT_VERB("cluster getLocalRoute from '%s'[%u] to '%s'[%u]", src->get_cname(), src->id(), dst->get_cname(), dst->id());
@@ -32,7 +67,7 @@ void ClusterZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArg
     if (src->is_router()) {
       XBT_WARN("Routing from a cluster private router to itself is meaningless");
     } else {
-      std::pair<resource::LinkImpl*, resource::LinkImpl*> info = private_links_.at(node_pos(src->id()));
+      std::pair<resource::LinkImpl*, resource::LinkImpl*> info = get_private_link_at(node_pos(src->id()));
       route->link_list.push_back(info.first);
       if (lat)
         *lat += info.first->get_latency();
@@ -42,12 +77,11 @@ void ClusterZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArg
 
   if (not src->is_router()) { // No private link for the private router
     if (has_limiter_) {      // limiter for sender
-      std::pair<resource::LinkImpl*, resource::LinkImpl*> info = private_links_.at(node_pos_with_loopback(src->id()));
-      route->link_list.push_back(info.first);
+      route->link_list.push_back(get_private_link_at(node_pos_with_loopback(src->id())).first);
     }
 
     std::pair<resource::LinkImpl*, resource::LinkImpl*> info =
-        private_links_.at(node_pos_with_loopback_limiter(src->id()));
+        get_private_link_at(node_pos_with_loopback_limiter(src->id()));
     if (info.first) { // link up
       route->link_list.push_back(info.first);
       if (lat)
@@ -64,14 +98,14 @@ void ClusterZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArg
   if (not dst->is_router()) { // No specific link for router
 
     std::pair<resource::LinkImpl*, resource::LinkImpl*> info =
-        private_links_.at(node_pos_with_loopback_limiter(dst->id()));
+        get_private_link_at(node_pos_with_loopback_limiter(dst->id()));
     if (info.second) { // link down
       route->link_list.push_back(info.second);
       if (lat)
         *lat += info.second->get_latency();
     }
     if (has_limiter_) { // limiter for receiver
-      info = private_links_.at(node_pos_with_loopback(dst->id()));
+      info = get_private_link_at(node_pos_with_loopback(dst->id()));
       route->link_list.push_back(info.first);
     }
   }
@@ -93,10 +127,10 @@ void ClusterZone::get_graph(xbt_graph_t graph, std::map<std::string, xbt_node_t>
   }
 
   for (auto const& src : get_vertices()) {
-    if (not src->is_router()) {
+    if (src != nullptr && not src->is_router()) {
       xbt_node_t previous = new_xbt_graph_node(graph, src->get_cname(), nodes);
 
-      std::pair<resource::LinkImpl*, resource::LinkImpl*> info = private_links_.at(src->id());
+      std::pair<resource::LinkImpl*, resource::LinkImpl*> info = get_private_link_at(src->id());
 
       if (info.first) { // link up
         xbt_node_t current = new_xbt_graph_node(graph, info.first->get_cname(), nodes);
@@ -143,7 +177,111 @@ void ClusterZone::create_links_for_node(ClusterCreationArgs* cluster, int id, in
     linkUp   = s4u::Link::by_name(link_id);
     linkDown = linkUp;
   }
-  private_links_.insert({position, {linkUp->get_impl(), linkDown->get_impl()}});
+  add_private_link_at(position, {linkUp->get_impl(), linkDown->get_impl()});
+}
+
+void ClusterZone::add_private_link_at(unsigned int position,
+                                      std::pair<resource::LinkImpl*, resource::LinkImpl*> link)
+{
+  if (position >= private_links_.size())
+    private_links_.resize(position + 1, {nullptr, nullptr});
+  if (private_links_[position].first == nullptr)
+    private_links_[position] = link;
+}
+
+void ClusterZone::set_lazy_nodes(const ClusterCreationArgs* cluster)
+{
+  xbt_assert(get_table_size() == 0, "The nodes of the cluster %s must be its first components", get_cname());
+  lazy_args_           = new ClusterCreationArgs(*cluster);
+  lazy_args_->radicals = new std::vector<int>(*cluster->radicals);
+  if (cluster->properties != nullptr)
+    lazy_args_->properties = new std::unordered_map<std::string, std::string>(*cluster->properties);
+
+  const std::vector<int>& radicals = *lazy_args_->radicals;
+  lazy_count_                      = radicals.size();
+  lazy_created_.resize(lazy_count_, false);
+  if (not std::is_sorted(radicals.begin(), radicals.end(), [](int a, int b) { return a <= b; }))
+    for (unsigned int rank = 0; rank < radicals.size(); rank++)
+      lazy_ranks_.insert({radicals[rank], rank});
+  reserve_components(lazy_count_);
+  s4u::Engine::get_instance()->pimpl->lazy_clusters_.push_back(this);
+  XBT_DEBUG("The %u nodes of the cluster %s are created on need", lazy_count_, get_cname());
+}
+
+/* Finds the rank of the node of that radical, given as a string */
+bool ClusterZone::find_lazy_rank(const std::string& radical, unsigned int* rank) const
+{
+  if (radical.empty() || radical.size() > 11)
+    return false;
+  char* end;
+  long value = strtol(radical.c_str(), &end, 10);
+  if (*end != '\0' || std::to_string(value) != radical) // Only the names generated for the nodes are accepted
+    return false;
+
+  const std::vector<int>& radicals = *lazy_args_->radicals;
+  if (lazy_ranks_.empty()) {
+    auto pos = std::lower_bound(radicals.begin(), radicals.end(), value);
+    if (pos == radicals.end() || *pos != value)
+      return false;
+    *rank = pos - radicals.begin();
+  } else {
+    auto pos = lazy_ranks_.find(value);
+    if (pos == lazy_ranks_.end())
+      return false;
+    *rank = pos->second;
+  }
+  return true;
+}
+
+bool ClusterZone::create_lazy_node(unsigned int rank)
+{
+  if (lazy_created_[rank])
+    return false;
+  lazy_created_[rank] = true; // Before the creation, that looks for the host name
+  lazy_count_--;
+
+  XBT_DEBUG("Create the node of rank %u of the cluster %s", rank, get_cname());
+  creating_rank_ = rank;
+  sg_platf_new_cluster_node(this, lazy_args_, (*lazy_args_->radicals)[rank], rank);
+  creating_rank_ = -1;
+  return true;
+}
+
+bool ClusterZone::create_lazy_host(const std::string& name)
+{
+  if (lazy_count_ == 0)
+    return false;
+  /* The nodes are named <prefix><radical><suffix> */
+  const std::string& prefix = lazy_args_->prefix;
+  const std::string& suffix = lazy_args_->suffix;
+  if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+      name.compare(name.size() - suffix.size(), std::string::npos, suffix) != 0)
+    return false;
+
+  unsigned int rank;
+  return find_lazy_rank(name.substr(prefix.size(), name.size() - prefix.size() - suffix.size()), &rank) &&
+         create_lazy_node(rank);
+}
+
+bool ClusterZone::create_lazy_link(const std::string& name)
+{
+  if (lazy_count_ == 0)
+    return false;
+  /* The private links are named <cluster>_link_<radical>, possibly followed by _UP, _DOWN, _loopback or _limiter */
+  std::string prefix = lazy_args_->id + "_link_";
+  if (name.compare(0, prefix.size(), prefix) != 0)
+    return false;
+
+  std::string::size_type end = name.find('_', prefix.size());
+  unsigned int rank;
+  return find_lazy_rank(name.substr(prefix.size(), end == std::string::npos ? end : end - prefix.size()), &rank) &&
+         create_lazy_node(rank);
+}
+
+void ClusterZone::create_all_lazy_nodes()
+{
+  for (unsigned int rank = 0; lazy_count_ > 0 && rank < lazy_created_.size(); rank++)
+    create_lazy_node(rank);
 }
 }
 }
@@ -5,99 +5,166 @@
 
 #include "simgrid/kernel/routing/DijkstraZone.hpp"
 #include "simgrid/kernel/routing/NetPoint.hpp"
+#include "src/include/xbt/parmap.hpp"
+#include "src/kernel/routing/RouteStore.hpp"
+#include "src/simix/smx_private.hpp"
 #include "src/surf/network_interface.hpp"
+#include "src/surf/surf_interface.hpp"
 #include "src/surf/xml/platf_private.hpp"
 #include "surf/surf.hpp"
 #include "xbt/string.hpp"
 
-#include <cfloat>
+#include <algorithm>
+#include <limits>
 #include <queue>
+#include <stdexcept>
 #include <vector>
 
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(surf_route_dijkstra, surf, "Routing part of surf -- dijkstra routing logic");
 
+namespace {
+constexpr unsigned int dijkstra_chunk = 16; // sources given together to a thread by routing/dijkstra-precompute
+} // namespace
+
+int sg_dijkstra_cache_size = 1024; /* Change this with --cfg=routing/dijkstra-cache-size:VALUE */
+bool sg_dijkstra_precompute = false; /* Change this with --cfg=routing/dijkstra-precompute:yes */
+
 namespace simgrid {
 namespace kernel {
 namespace routing {
 
-class GraphNodeData {
-public:
-  explicit GraphNodeData(int id) : id_(id) {}
-  int id_;
-  int graph_id_ = -1; /* used for caching internal graph id's */
-};
-
 DijkstraZone::DijkstraZone(NetZoneImpl* father, const std::string& name, resource::NetworkModel* netmodel, bool cached)
     : RoutedZone(father, name, netmodel), cached_(cached)
 {
 }
 
-static void graph_node_data_free(void* n)
-{
-  delete static_cast<simgrid::kernel::routing::GraphNodeData*>(n);
-}
-
-static void graph_edge_data_free(void* e)
-{
-  delete static_cast<simgrid::kernel::routing::RouteCreationArgs*>(e);
-}
-
-DijkstraZone::~DijkstraZone()
-{
-  xbt_graph_free_graph(route_graph_, &graph_node_data_free, &graph_edge_data_free, nullptr);
-}
+DijkstraZone::~DijkstraZone() = default;
 
 void DijkstraZone::seal()
 {
-  unsigned int cursor;
-  xbt_node_t node = nullptr;
-
-  if (not route_graph_)
-    route_graph_ = xbt_graph_new_graph(1, nullptr);
+  unsigned int nr_nodes = graph_node_map_.size();
 
   /* Add the loopback if needed */
   if (network_model_->loopback_ && hierarchy_ == RoutingMode::base) {
-
-    xbt_dynar_foreach (xbt_graph_get_nodes(route_graph_), cursor, node) {
-      bool found = false;
-      xbt_edge_t edge = nullptr;
-      unsigned int cursor2;
-      xbt_dynar_foreach (xbt_graph_node_get_outedges(node), cursor2, edge) {
-        if (xbt_graph_edge_get_target(edge) == node) { // There is an edge from node to itself
-          found = true;
-          break;
-        }
-      }
-
-      if (not found) {
+    for (unsigned int node = 0; node < nr_nodes; node++) {
+      if (edge_set_.find(std::make_pair(node, node)) == edge_set_.end()) {
         RouteCreationArgs* route = new simgrid::kernel::routing::RouteCreationArgs();
         route->link_list.push_back(network_model_->loopback_);
-        xbt_graph_new_edge(route_graph_, node, node, route);
+        edges_.push_back({node, node, std::unique_ptr<RouteCreationArgs>(route)});
+        edge_set_.emplace(node, node);
       }
     }
   }
 
-  /* initialize graph indexes in nodes after graph has been built */
-  xbt_dynar_t nodes = xbt_graph_get_nodes(route_graph_);
-
-  xbt_dynar_foreach (nodes, cursor, node) {
-    GraphNodeData* data = static_cast<GraphNodeData*>(xbt_graph_node_get_data(node));
-    data->graph_id_     = cursor;
+  /* Build the compressed sparse rows, keeping the edges of each node in order of creation */
+  edge_offsets_.assign(nr_nodes + 1, 0);
+  for (Edge const& edge : edges_)
+    edge_offsets_[edge.src + 1]++;
+  for (unsigned int node = 0; node < nr_nodes; node++)
+    edge_offsets_[node + 1] += edge_offsets_[node];
+  edge_ids_.resize(edges_.size());
+  edge_targets_.resize(edges_.size());
+  edge_costs_.resize(edges_.size());
+  std::vector<unsigned int> next(edge_offsets_.begin(), edge_offsets_.end() - 1);
+  for (unsigned int id = 0; id < edges_.size(); id++) {
+    unsigned int pos   = next[edges_[id].src]++;
+    edge_ids_[pos]     = id;
+    edge_targets_[pos] = edges_[id].dst;
+    edge_costs_[pos]   = edges_[id].route->link_list.size();
+  }
+  edge_set_.clear();
+
+  if (sg_dijkstra_precompute && nr_nodes > 0) {
+    XBT_DEBUG("Computing the paths between the %u nodes of %s", nr_nodes, get_cname());
+    pred_table_.reset(new PairTable(nr_nodes));
+    std::vector<unsigned int> chunks;
+    for (unsigned int node = 0; node < nr_nodes; node += dijkstra_chunk)
+      chunks.push_back(node);
+    auto compute_chunk = [this, nr_nodes](unsigned int chunk) {
+      for (unsigned int node = chunk; node < std::min(chunk + dijkstra_chunk, nr_nodes); node++)
+        compute_predecessors(node, pred_table_->row(node));
+    };
+    // Logging is not thread-safe, and the workers need contexts
+    if (sg_routing_threads > 1 && chunks.size() > 1 && simix_global != nullptr && simix_global->context_factory &&
+        not XBT_LOG_ISENABLED(surf_route_dijkstra, xbt_log_priority_debug)) {
+      xbt::Parmap<unsigned int> parmap(sg_routing_threads, XBT_PARMAP_DEFAULT);
+      parmap.apply(compute_chunk, chunks);
+    } else {
+      for (unsigned int chunk : chunks)
+        compute_chunk(chunk);
+    }
   }
 }
 
-xbt_node_t DijkstraZone::route_graph_new_node(int id)
+unsigned int DijkstraZone::node_of(int netpoint_id)
 {
-  xbt_node_t node = xbt_graph_new_node(route_graph_, new GraphNodeData(id));
-  graph_node_map_.emplace(id, node);
+  auto elm = graph_node_map_.emplace(netpoint_id, graph_node_map_.size());
+  return elm.first->second;
+}
 
-  return node;
+void DijkstraZone::compute_predecessors(unsigned int src_node, std::uint32_t* pred_edges) const
+{
+  unsigned int nr_nodes = edge_offsets_.size() - 1;
+  std::vector<unsigned int> cost_arr(nr_nodes, std::numeric_limits<unsigned int>::max()); /* cost from src */
+  std::fill_n(pred_edges, nr_nodes, 0);
+  typedef std::pair<unsigned int, unsigned int> Qelt;
+  std::priority_queue<Qelt, std::vector<Qelt>, std::greater<Qelt>> pqueue;
+
+  /* The nodes of same cost are visited by increasing index, and their edges in order of creation */
+  cost_arr[src_node] = 0;
+  pqueue.emplace(0, src_node);
+  while (not pqueue.empty()) {
+    unsigned int v_cost = pqueue.top().first;
+    unsigned int v_id   = pqueue.top().second;
+    pqueue.pop();
+    if (v_cost > cost_arr[v_id]) // already visited with a lower cost
+      continue;
+
+    for (unsigned int pos = edge_offsets_[v_id]; pos < edge_offsets_[v_id + 1]; pos++) {
+      unsigned int u_id   = edge_targets_[pos];
+      unsigned int u_cost = v_cost + edge_costs_[pos];
+      if (u_cost < cost_arr[u_id]) {
+        pred_edges[u_id] = edge_ids_[pos] + 1;
+        cost_arr[u_id]   = u_cost;
+        pqueue.emplace(u_cost, u_id);
+      }
+    }
+  }
 }
 
-xbt_node_t DijkstraZone::node_map_search(int id)
+const std::uint32_t* DijkstraZone::get_predecessors(unsigned int src_node)
 {
-  auto ret = graph_node_map_.find(id);
-  return ret == graph_node_map_.end() ? nullptr : ret->second;
+  if (pred_table_)
+    return pred_table_->row(src_node);
+
+  std::size_t nr_nodes = edge_offsets_.size() - 1;
+  if (not cached_) {
+    pred_buffer_.resize(nr_nodes);
+    compute_predecessors(src_node, pred_buffer_.data());
+    return pred_buffer_.data();
+  }
+
+  auto elm = route_cache_index_.find(src_node);
+  if (elm != route_cache_index_.end()) {
+    route_cache_.splice(route_cache_.begin(), route_cache_, elm->second);
+    return elm->second->second.data();
+  }
+
+  /* Evict the least recently used paths when the cache is full, and reuse their storage */
+  std::vector<std::uint32_t> pred_arr;
+  std::size_t max_entries = std::numeric_limits<std::size_t>::max();
+  if (sg_dijkstra_cache_size > 0)
+    max_entries = std::max<std::size_t>(1, (std::size_t(sg_dijkstra_cache_size) << 20) / (nr_nodes * sizeof(std::uint32_t)));
+  if (route_cache_.size() >= max_entries) {
+    route_cache_index_.erase(route_cache_.back().first);
+    pred_arr = std::move(route_cache_.back().second);
+    route_cache_.pop_back();
+  }
+  pred_arr.resize(nr_nodes);
+  compute_predecessors(src_node, pred_arr.data());
+  route_cache_.emplace_front(src_node, std::move(pred_arr));
+  route_cache_index_.emplace(src_node, route_cache_.begin());
+  return route_cache_.front().second.data();
 }
 
 /* Parsing */
@@ -105,98 +172,48 @@ xbt_node_t DijkstraZone::node_map_search(int id)
 void DijkstraZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArgs* route, double* lat)
 {
   get_route_check_params(src, dst);
-  int src_id = src->id();
-  int dst_id = dst->id();
-
-  xbt_dynar_t nodes = xbt_graph_get_nodes(route_graph_);
 
   /* Use the graph_node id mapping set to quickly find the nodes */
-  xbt_node_t src_elm = node_map_search(src_id);
-  xbt_node_t dst_elm = node_map_search(dst_id);
+  auto src_elm = graph_node_map_.find(src->id());
+  auto dst_elm = graph_node_map_.find(dst->id());
+  if (src_elm == graph_node_map_.end() || dst_elm == graph_node_map_.end())
+    throw std::invalid_argument(xbt::string_printf("No route from '%s' to '%s'", src->get_cname(), dst->get_cname()));
+  unsigned int src_node_id = src_elm->second;
+  unsigned int dst_node_id = dst_elm->second;
 
-  int src_node_id = static_cast<GraphNodeData*>(xbt_graph_node_get_data(src_elm))->graph_id_;
-  int dst_node_id = static_cast<GraphNodeData*>(xbt_graph_node_get_data(dst_elm))->graph_id_;
+  /* The links are gathered from the destination, and added at the beginning of the route in the end */
+  std::vector<resource::LinkImpl*> links;
 
   /* if the src and dst are the same */
   if (src_node_id == dst_node_id) {
+    const RouteCreationArgs* e_route = nullptr;
+    for (unsigned int pos = edge_offsets_[src_node_id]; pos < edge_offsets_[src_node_id + 1]; pos++)
+      if (edge_targets_[pos] == src_node_id) {
+        e_route = edges_[edge_ids_[pos]].route.get();
+        break;
+      }
 
-    xbt_node_t node_s_v = xbt_dynar_get_as(nodes, src_node_id, xbt_node_t);
-    xbt_node_t node_e_v = xbt_dynar_get_as(nodes, dst_node_id, xbt_node_t);
-    xbt_edge_t edge     = xbt_graph_get_edge(route_graph_, node_s_v, node_e_v);
-
-    if (edge == nullptr)
+    if (e_route == nullptr)
       throw std::invalid_argument(xbt::string_printf("No route from '%s' to '%s'", src->get_cname(), dst->get_cname()));
 
-    RouteCreationArgs* e_route = static_cast<RouteCreationArgs*>(xbt_graph_edge_get_data(edge));
-
     for (auto const& link : e_route->link_list) {
-      route->link_list.insert(route->link_list.begin(), link);
+      links.push_back(link);
       if (lat)
         *lat += static_cast<resource::LinkImpl*>(link)->get_latency();
     }
   }
 
-  auto elm                   = route_cache_.emplace(src_id, std::vector<int>());
-  std::vector<int>& pred_arr = elm.first->second;
-
-  if (elm.second) { /* new element was inserted (not cached mode, or cache miss) */
-    int nr_nodes      = xbt_dynar_length(nodes);
-    std::vector<double> cost_arr(nr_nodes); /* link cost from src to other hosts */
-    pred_arr.resize(nr_nodes);              /* predecessors in path from src */
-    typedef std::pair<double, int> Qelt;
-    std::priority_queue<Qelt, std::vector<Qelt>, std::greater<Qelt>> pqueue;
-
-    /* initialize */
-    cost_arr[src_node_id] = 0.0;
-
-    for (int i = 0; i < nr_nodes; i++) {
-      if (i != src_node_id) {
-        cost_arr[i] = DBL_MAX;
-      }
-
-      pred_arr[i] = 0;
-
-      /* initialize priority queue */
-      pqueue.emplace(cost_arr[i], i);
-    }
-
-    /* apply dijkstra using the indexes from the graph's node array */
-    while (not pqueue.empty()) {
-      int v_id = pqueue.top().second;
-      pqueue.pop();
-      xbt_node_t v_node = xbt_dynar_get_as(nodes, v_id, xbt_node_t);
-      xbt_edge_t edge   = nullptr;
-      unsigned int cursor;
-
-      xbt_dynar_foreach (xbt_graph_node_get_outedges(v_node), cursor, edge) {
-        xbt_node_t u_node                  = xbt_graph_edge_get_target(edge);
-        GraphNodeData* data                = static_cast<GraphNodeData*>(xbt_graph_node_get_data(u_node));
-        int u_id                           = data->graph_id_;
-        RouteCreationArgs* tmp_e_route     = static_cast<RouteCreationArgs*>(xbt_graph_edge_get_data(edge));
-        int cost_v_u                       = tmp_e_route->link_list.size(); /* count of links, old model assume 1 */
-
-        if (cost_v_u + cost_arr[v_id] < cost_arr[u_id]) {
-          pred_arr[u_id] = v_id;
-          cost_arr[u_id] = cost_v_u + cost_arr[v_id];
-          pqueue.emplace(cost_arr[u_id], u_id);
-        }
-      }
-    }
-  }
+  const std::uint32_t* pred_arr = src_node_id == dst_node_id ? nullptr : get_predecessors(src_node_id);
 
   /* compose route path with links */
   NetPoint* gw_src   = nullptr;
   NetPoint* first_gw = nullptr;
 
-  for (int v = dst_node_id; v != src_node_id; v = pred_arr[v]) {
-    xbt_node_t node_pred_v = xbt_dynar_get_as(nodes, pred_arr[v], xbt_node_t);
-    xbt_node_t node_v      = xbt_dynar_get_as(nodes, v, xbt_node_t);
-    xbt_edge_t edge        = xbt_graph_get_edge(route_graph_, node_pred_v, node_v);
-
-    if (edge == nullptr)
+  for (unsigned int v = dst_node_id; v != src_node_id; v = edges_[pred_arr[v] - 1].src) {
+    if (pred_arr[v] == 0)
       throw std::invalid_argument(xbt::string_printf("No route from '%s' to '%s'", src->get_cname(), dst->get_cname()));
 
-    RouteCreationArgs* e_route = static_cast<RouteCreationArgs*>(xbt_graph_edge_get_data(edge));
+    const RouteCreationArgs* e_route = edges_[pred_arr[v] - 1].route.get();
 
     NetPoint* prev_gw_src = gw_src;
     gw_src                = e_route->gw_src;
@@ -211,29 +228,24 @@ void DijkstraZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationAr
       NetPoint* gw_dst_net_elm      = nullptr;
       NetPoint* prev_gw_src_net_elm = nullptr;
       get_global_route(gw_dst_net_elm, prev_gw_src_net_elm, e_route_as_to_as, nullptr);
-      auto pos = route->link_list.begin();
-      for (auto const& link : e_route_as_to_as) {
-        route->link_list.insert(pos, link);
+      for (auto const& link : e_route_as_to_as)
         if (lat)
           *lat += link->get_latency();
-        pos++;
-      }
+      links.insert(links.end(), e_route_as_to_as.rbegin(), e_route_as_to_as.rend());
     }
 
     for (auto const& link : e_route->link_list) {
-      route->link_list.insert(route->link_list.begin(), link);
+      links.push_back(link);
       if (lat)
         *lat += static_cast<resource::LinkImpl*>(link)->get_latency();
     }
   }
+  route->link_list.insert(route->link_list.begin(), links.rbegin(), links.rend());
 
   if (hierarchy_ == RoutingMode::recursive) {
     route->gw_src = gw_src;
     route->gw_dst = first_gw;
   }
-
-  if (not cached_)
-    route_cache_.clear();
 }
 
 void DijkstraZone::add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, NetPoint* gw_dst,
@@ -241,9 +253,6 @@ void DijkstraZone::add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, Net
 {
   add_route_check_params(src, dst, gw_src, gw_dst, link_list, symmetrical);
 
-  if (not route_graph_)
-    route_graph_ = xbt_graph_new_graph(1, nullptr);
-
   new_edge(src->id(), dst->id(), new_extended_route(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, 1));
 
   if (symmetrical == true)
@@ -253,18 +262,14 @@ void DijkstraZone::add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, Net
 void DijkstraZone::new_edge(int src_id, int dst_id, simgrid::kernel::routing::RouteCreationArgs* route)
 {
   XBT_DEBUG("Create Route from '%d' to '%d'", src_id, dst_id);
+  std::unique_ptr<RouteCreationArgs> e_route(route);
 
   // Get the extremities, or create them if they don't exist yet
-  xbt_node_t src = node_map_search(src_id);
-  if (src == nullptr)
-    src = route_graph_new_node(src_id);
-
-  xbt_node_t dst = node_map_search(dst_id);
-  if (dst == nullptr)
-    dst = route_graph_new_node(dst_id);
+  unsigned int src = node_of(src_id);
+  unsigned int dst = node_of(dst_id);
 
   // Make sure that this graph edge was not already added to the graph
-  if (xbt_graph_get_edge(route_graph_, src, dst) != nullptr) {
+  if (not edge_set_.emplace(src, dst).second) {
     if (route->gw_dst == nullptr || route->gw_src == nullptr)
       throw std::invalid_argument(
           xbt::string_printf("Route from %s to %s already exists", route->src->get_cname(), route->dst->get_cname()));
@@ -275,7 +280,7 @@ void DijkstraZone::new_edge(int src_id, int dst_id, simgrid::kernel::routing::Ro
   }
 
   // Finally add it
-  xbt_graph_new_edge(route_graph_, src, dst, route);
+  edges_.push_back({src, dst, std::move(e_route)});
 }
 }
 }
@@ -119,19 +119,9 @@ void DragonflyZone::seal()
     return;
   }
 
-  this->generate_routers();
   this->generate_links();
 }
 
-void DragonflyZone::generate_routers()
-{
-  this->routers_.reserve(this->num_groups_ * this->num_chassis_per_group_ * this->num_blades_per_chassis_);
-  for (unsigned int i = 0; i < this->num_groups_; i++)
-    for (unsigned int j = 0; j < this->num_chassis_per_group_; j++)
-      for (unsigned int k = 0; k < this->num_blades_per_chassis_; k++)
-        this->routers_.emplace_back(i, j, k);
-}
-
 void DragonflyZone::create_link(const std::string& id, int numlinks, resource::LinkImpl** linkup,
                                 resource::LinkImpl** linkdown)
 {
@@ -162,22 +152,24 @@ void DragonflyZone::generate_links()
   resource::LinkImpl* linkdown;
 
   unsigned int numRouters = this->num_groups_ * this->num_chassis_per_group_ * this->num_blades_per_chassis_;
+  unsigned int numNodeLinks = num_links_per_link_ * this->num_nodes_per_blade_; // per router
+
+  // allocate structures
+  this->node_links_.resize(numRouters * numNodeLinks);
+  this->green_links_.resize(numRouters * this->num_blades_per_chassis_);
+  this->black_links_.resize(numRouters * this->num_chassis_per_group_);
+  this->blue_links_.resize(numRouters);
 
   // Links from routers to their local nodes.
   for (unsigned int i = 0; i < numRouters; i++) {
-    // allocate structures
-    this->routers_[i].my_nodes_.resize(num_links_per_link_ * this->num_nodes_per_blade_);
-    this->routers_[i].green_links_.resize(this->num_blades_per_chassis_);
-    this->routers_[i].black_links_.resize(this->num_chassis_per_group_);
-
-    for (unsigned int j = 0; j < num_links_per_link_ * this->num_nodes_per_blade_; j += num_links_per_link_) {
+    for (unsigned int j = 0; j < numNodeLinks; j += num_links_per_link_) {
       std::string id = "local_link_from_router_" + std::to_string(i) + "_to_node_" +
                        std::to_string(j / num_links_per_link_) + "_" + std::to_string(uniqueId);
       this->create_link(id, 1, &linkup, &linkdown);
 
-      this->routers_[i].my_nodes_[j] = linkup;
+      this->node_links_[i * numNodeLinks + j] = linkup;
       if (this->sharing_policy_ == s4u::Link::SharingPolicy::SPLITDUPLEX)
-        this->routers_[i].my_nodes_[j + 1] = linkdown;
+        this->node_links_[i * numNodeLinks + j + 1] = linkdown;
 
       uniqueId++;
     }
@@ -191,8 +183,8 @@ void DragonflyZone::generate_links()
                          std::to_string(j) + "_and_" + std::to_string(k) + "_" + std::to_string(uniqueId);
         this->create_link(id, this->num_links_green_, &linkup, &linkdown);
 
-        this->routers_[i * num_blades_per_chassis_ + j].green_links_[k] = linkup;
-        this->routers_[i * num_blades_per_chassis_ + k].green_links_[j] = linkdown;
+        this->green_links_[(i * num_blades_per_chassis_ + j) * num_blades_per_chassis_ + k] = linkup;
+        this->green_links_[(i * num_blades_per_chassis_ + k) * num_blades_per_chassis_ + j] = linkdown;
         uniqueId++;
       }
     }
@@ -207,10 +199,8 @@ void DragonflyZone::generate_links()
               "_and_" + std::to_string(k) +"_blade_" + std::to_string(l) + "_" + std::to_string(uniqueId);
           this->create_link(id, this->num_links_black_, &linkup, &linkdown);
 
-          this->routers_[i * num_blades_per_chassis_ * num_chassis_per_group_ + j * num_blades_per_chassis_ + l]
-              .black_links_[k] = linkup;
-          this->routers_[i * num_blades_per_chassis_ * num_chassis_per_group_ + k * num_blades_per_chassis_ + l]
-              .black_links_[j] = linkdown;
+          this->black_links_[router_id(i, j, l) * num_chassis_per_group_ + k] = linkup;
+          this->black_links_[router_id(i, k, l) * num_chassis_per_group_ + j] = linkdown;
           uniqueId++;
         }
       }
@@ -228,8 +218,8 @@ void DragonflyZone::generate_links()
           std::to_string(routernumi) + "_and_" + std::to_string(routernumj) + "_" + std::to_string(uniqueId);
       this->create_link(id, this->num_links_blue_, &linkup, &linkdown);
 
-      this->routers_[routernumi].blue_link_ = linkup;
-      this->routers_[routernumj].blue_link_ = linkdown;
+      this->blue_links_[routernumi] = linkup;
+      this->blue_links_[routernumj] = linkdown;
       uniqueId++;
     }
   }
@@ -247,11 +237,11 @@ void DragonflyZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationA
            dst->id());
 
   if ((src->id() == dst->id()) && has_loopback_) {
-    std::pair<resource::LinkImpl*, resource::LinkImpl*> info = private_links_.at(node_pos(src->id()));
+    resource::LinkImpl* loopback = get_private_link_at(node_pos(src->id())).first;
 
-    route->link_list.push_back(info.first);
+    route->link_list.push_back(loopback);
     if (latency)
-      *latency += info.first->get_latency();
+      *latency += loopback->get_latency();
     return;
   }
 
@@ -263,76 +253,64 @@ void DragonflyZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationA
   XBT_DEBUG("dst : %u group, %u chassis, %u blade, %u node", targetCoords[0], targetCoords[1], targetCoords[2],
             targetCoords[3]);
 
-  DragonflyRouter* myRouter = &routers_[myCoords[0] * (num_chassis_per_group_ * num_blades_per_chassis_) +
-                                        myCoords[1] * num_blades_per_chassis_ + myCoords[2]];
-  DragonflyRouter* targetRouter = &routers_[targetCoords[0] * (num_chassis_per_group_ * num_blades_per_chassis_) +
-                                            targetCoords[1] * num_blades_per_chassis_ + targetCoords[2]];
-  DragonflyRouter* currentRouter = myRouter;
+  /* The routers are only designated by their index, from which their coordinates are computed on need */
+  const unsigned int numNodeLinks = num_links_per_link_ * num_nodes_per_blade_;
+  unsigned int myRouter           = router_id(myCoords[0], myCoords[1], myCoords[2]);
+  unsigned int targetRouter       = router_id(targetCoords[0], targetCoords[1], targetCoords[2]);
+  unsigned int currentRouter      = myRouter;
+  auto add_link                   = [route, latency](resource::LinkImpl* link) {
+    route->link_list.push_back(link);
+    if (latency)
+      *latency += link->get_latency();
+  };
 
   // node->router local link
-  route->link_list.push_back(myRouter->my_nodes_[myCoords[3] * num_links_per_link_]);
-  if (latency)
-    *latency += myRouter->my_nodes_[myCoords[3] * num_links_per_link_]->get_latency();
+  add_link(node_links_[myRouter * numNodeLinks + myCoords[3] * num_links_per_link_]);
 
   if (has_limiter_) { // limiter for sender
-    std::pair<resource::LinkImpl*, resource::LinkImpl*> info = private_links_.at(node_pos_with_loopback(src->id()));
-    route->link_list.push_back(info.first);
+    route->link_list.push_back(get_private_link_at(node_pos_with_loopback(src->id())).first);
   }
 
   if (targetRouter != myRouter) {
 
     // are we on a different group ?
-    if (targetRouter->group_ != currentRouter->group_) {
+    if (targetCoords[0] != currentRouter / (num_chassis_per_group_ * num_blades_per_chassis_)) {
       // go to the router of our group connected to this one.
-      if (currentRouter->blade_ != targetCoords[0]) {
+      if (currentRouter % num_blades_per_chassis_ != targetCoords[0]) {
         // go to the nth router in our chassis
-        route->link_list.push_back(currentRouter->green_links_[targetCoords[0]]);
-        if (latency)
-          *latency += currentRouter->green_links_[targetCoords[0]]->get_latency();
-        currentRouter = &routers_[myCoords[0] * (num_chassis_per_group_ * num_blades_per_chassis_) +
-                                  myCoords[1] * num_blades_per_chassis_ + targetCoords[0]];
+        add_link(green_links_[currentRouter * num_blades_per_chassis_ + targetCoords[0]]);
+        currentRouter = router_id(myCoords[0], myCoords[1], targetCoords[0]);
       }
 
-      if (currentRouter->chassis_ != 0) {
+      if ((currentRouter / num_blades_per_chassis_) % num_chassis_per_group_ != 0) {
         // go to the first chassis of our group
-        route->link_list.push_back(currentRouter->black_links_[0]);
-        if (latency)
-          *latency += currentRouter->black_links_[0]->get_latency();
-        currentRouter = &routers_[myCoords[0] * (num_chassis_per_group_ * num_blades_per_chassis_) + targetCoords[0]];
+        add_link(black_links_[currentRouter * num_chassis_per_group_ + 0]);
+        currentRouter = router_id(myCoords[0], 0, targetCoords[0]);
       }
 
       // go to destination group - the only optical hop
-      route->link_list.push_back(currentRouter->blue_link_);
-      if (latency)
-        *latency += currentRouter->blue_link_->get_latency();
-      currentRouter = &routers_[targetCoords[0] * (num_chassis_per_group_ * num_blades_per_chassis_) + myCoords[0]];
+      add_link(blue_links_[currentRouter]);
+      currentRouter = router_id(targetCoords[0], 0, myCoords[0]);
     }
 
     // same group, but same blade ?
-    if (targetRouter->blade_ != currentRouter->blade_) {
-      route->link_list.push_back(currentRouter->green_links_[targetCoords[2]]);
-      if (latency)
-        *latency += currentRouter->green_links_[targetCoords[2]]->get_latency();
-      currentRouter = &routers_[targetCoords[0] * (num_chassis_per_group_ * num_blades_per_chassis_) + targetCoords[2]];
+    if (targetCoords[2] != currentRouter % num_blades_per_chassis_) {
+      add_link(green_links_[currentRouter * num_blades_per_chassis_ + targetCoords[2]]);
+      currentRouter = router_id(targetCoords[0], 0, targetCoords[2]);
     }
 
     // same blade, but same chassis ?
-    if (targetRouter->chassis_ != currentRouter->chassis_) {
-      route->link_list.push_back(currentRouter->black_links_[targetCoords[1]]);
-      if (latency)
-        *latency += currentRouter->black_links_[targetCoords[1]]->get_latency();
+    if (targetCoords[1] != (currentRouter / num_blades_per_chassis_) % num_chassis_per_group_) {
+      add_link(black_links_[currentRouter * num_chassis_per_group_ + targetCoords[1]]);
     }
   }
 
   if (has_limiter_) { // limiter for receiver
-    std::pair<resource::LinkImpl*, resource::LinkImpl*> info = private_links_.at(node_pos_with_loopback(dst->id()));
-    route->link_list.push_back(info.first);
+    route->link_list.push_back(get_private_link_at(node_pos_with_loopback(dst->id())).first);
   }
 
   // router->node local link
-  route->link_list.push_back(targetRouter->my_nodes_[targetCoords[3] * num_links_per_link_ + num_links_per_link_ - 1]);
-  if (latency)
-    *latency += targetRouter->my_nodes_[targetCoords[3] * num_links_per_link_ + num_links_per_link_ - 1]->get_latency();
+  add_link(node_links_[targetRouter * numNodeLinks + targetCoords[3] * num_links_per_link_ + num_links_per_link_ - 1]);
 }
 }
 }
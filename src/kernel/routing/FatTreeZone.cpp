@@ -66,15 +66,13 @@ void FatTreeZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArg
     return;
 
   /* Let's find the source and the destination in our internal structure */
-  auto searchedNode = this->compute_nodes_.find(src->id());
-  xbt_assert(searchedNode != this->compute_nodes_.end(), "Could not find the source %s [%u] in the fat tree",
-             src->get_cname(), src->id());
-  FatTreeNode* source = searchedNode->second;
+  xbt_assert(src->id() < compute_nodes_.size() && compute_nodes_[src->id()] != nullptr,
+             "Could not find the source %s [%u] in the fat tree", src->get_cname(), src->id());
+  FatTreeNode* source = compute_nodes_[src->id()];
 
-  searchedNode = this->compute_nodes_.find(dst->id());
-  xbt_assert(searchedNode != this->compute_nodes_.end(), "Could not find the destination %s [%u] in the fat tree",
-             dst->get_cname(), dst->id());
-  FatTreeNode* destination = searchedNode->second;
+  xbt_assert(dst->id() < compute_nodes_.size() && compute_nodes_[dst->id()] != nullptr,
+             "Could not find the destination %s [%u] in the fat tree", dst->get_cname(), dst->id());
+  FatTreeNode* destination = compute_nodes_[dst->id()];
 
   XBT_VERB("Get route and latency from '%s' [%u] to '%s' [%u] in a fat tree", src->get_cname(), src->id(),
            dst->get_cname(), dst->id());
@@ -112,19 +110,25 @@ void FatTreeZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArg
             currentNode->id, currentNode->level, currentNode->position);
 
   // Down part
+  /* The children ports leading to the destination are the ones congruent to its label modulo the amount of children.
+   * The port index is not reset when going down a level, but only when it runs out of the ports of the current node. */
+  unsigned int i = 0;
   while (currentNode != destination) {
-    for (unsigned int i = 0; i < currentNode->children.size(); i++) {
-      if (i % this->num_children_per_node_[currentNode->level - 1] == destination->label[currentNode->level - 1]) {
-        into->link_list.push_back(currentNode->children[i]->down_link_);
-        if (latency)
-          *latency += currentNode->children[i]->down_link_->get_latency();
-        currentNode = currentNode->children[i]->down_node_;
-        if (this->has_limiter_)
-          into->link_list.push_back(currentNode->limiter_link_);
-        XBT_DEBUG("%d(%u,%u) is accessible through %d(%u,%u)", destination->id, destination->level,
-                  destination->position, currentNode->id, currentNode->level, currentNode->position);
-      }
+    unsigned int k = this->num_children_per_node_[currentNode->level - 1];
+    i += (destination->label[currentNode->level - 1] + k - i % k) % k;
+    if (i >= currentNode->children.size()) {
+      i = 0;
+      continue;
     }
+    into->link_list.push_back(currentNode->children[i]->down_link_);
+    if (latency)
+      *latency += currentNode->children[i]->down_link_->get_latency();
+    currentNode = currentNode->children[i]->down_node_;
+    if (this->has_limiter_)
+      into->link_list.push_back(currentNode->limiter_link_);
+    XBT_DEBUG("%d(%u,%u) is accessible through %d(%u,%u)", destination->id, destination->level, destination->position,
+              currentNode->id, currentNode->level, currentNode->position);
+    i++;
   }
 }
 
@@ -179,58 +183,34 @@ void FatTreeZone::seal()
 
 int FatTreeZone::connect_node_to_parents(FatTreeNode* node)
 {
-  std::vector<FatTreeNode*>::iterator currentParentNode = this->nodes_.begin();
-  int connectionsNumber                                 = 0;
-  const int level                                       = node->level;
+  const unsigned int level = node->level;
   XBT_DEBUG("We are connecting node %d(%u,%u) to his parents.", node->id, node->level, node->position);
-  currentParentNode += this->get_level_position(level + 1);
-  for (unsigned int i = 0; i < this->nodes_by_level_[level + 1]; i++) {
-    if (this->are_related(*currentParentNode, node)) {
-      XBT_DEBUG("%d(%u,%u) and %d(%u,%u) are related,"
-                " with %u links between them.",
-                node->id, node->level, node->position, (*currentParentNode)->id, (*currentParentNode)->level,
-                (*currentParentNode)->position, this->num_port_lower_level_[level]);
-      for (unsigned int j = 0; j < this->num_port_lower_level_[level]; j++) {
-        this->add_link(*currentParentNode, node->label[level] + j * this->num_children_per_node_[level], node,
-                       (*currentParentNode)->label[level] + j * this->num_parents_per_node_[level]);
-      }
-      connectionsNumber++;
-    }
-    ++currentParentNode;
-  }
-  return connectionsNumber;
-}
-
-bool FatTreeZone::are_related(FatTreeNode* parent, FatTreeNode* child)
-{
-  std::stringstream msgBuffer;
-
-  if (XBT_LOG_ISENABLED(surf_route_fat_tree, xbt_log_priority_debug)) {
-    msgBuffer << "Are " << child->id << "(" << child->level << "," << child->position << ") <";
-
-    for (unsigned int i = 0; i < this->levels_; i++) {
-      msgBuffer << child->label[i] << ",";
-    }
-    msgBuffer << ">";
-
-    msgBuffer << " and " << parent->id << "(" << parent->level << "," << parent->position << ") <";
-    for (unsigned int i = 0; i < this->levels_; i++) {
-      msgBuffer << parent->label[i] << ",";
-    }
-    msgBuffer << ">";
-    msgBuffer << " related ? ";
-    XBT_DEBUG("%s", msgBuffer.str().c_str());
-  }
-  if (parent->level != child->level + 1) {
-    return false;
-  }
 
+  /* The parents share the label of the node, except for the digit of its level. Since the digits of lower rank come
+   * first in the labels, the position of a node in its level is given by its label in a mixed radix, that only differs
+   * between the node and its parents in the digit of that level. */
+  unsigned int first_parent = 0;
+  unsigned int weight       = 1;
+  unsigned int level_weight = 0;
   for (unsigned int i = 0; i < this->levels_; i++) {
-    if (parent->label[i] != child->label[i] && i + 1 != parent->level) {
-      return false;
+    if (i == level)
+      level_weight = weight;
+    else
+      first_parent += node->label[i] * weight;
+    weight *= i + 1 > level + 1 ? this->num_children_per_node_[i] : this->num_parents_per_node_[i];
+  }
+
+  const unsigned int parents_offset = this->get_level_position(level + 1);
+  for (unsigned int i = 0; i < this->num_parents_per_node_[level]; i++) {
+    FatTreeNode* parent = this->nodes_[parents_offset + first_parent + i * level_weight];
+    XBT_DEBUG("%d(%u,%u) and %d(%u,%u) are related, with %u links between them.", node->id, node->level,
+              node->position, parent->id, parent->level, parent->position, this->num_port_lower_level_[level]);
+    for (unsigned int j = 0; j < this->num_port_lower_level_[level]; j++) {
+      this->add_link(parent, node->label[level] + j * this->num_children_per_node_[level], node,
+                     parent->label[level] + j * this->num_parents_per_node_[level]);
     }
   }
-  return true;
+  return this->num_parents_per_node_[level];
 }
 
 void FatTreeZone::generate_switches()
@@ -336,13 +316,14 @@ int FatTreeZone::get_level_position(const unsigned int level)
 
 void FatTreeZone::add_processing_node(int id)
 {
-  using std::make_pair;
   static int position = 0;
   FatTreeNode* newNode;
   newNode = new FatTreeNode(this->cluster_, id, 0, position++);
   newNode->parents.resize(this->num_parents_per_node_[0] * this->num_port_lower_level_[0]);
   newNode->label.resize(this->levels_);
-  this->compute_nodes_.insert(make_pair(id, newNode));
+  if (this->compute_nodes_.size() <= static_cast<unsigned int>(id))
+    this->compute_nodes_.resize(id + 1, nullptr);
+  this->compute_nodes_[id] = newNode;
   this->nodes_.push_back(newNode);
 }
 
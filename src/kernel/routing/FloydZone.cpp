@@ -5,19 +5,71 @@
 
 #include "simgrid/kernel/routing/FloydZone.hpp"
 #include "simgrid/kernel/routing/NetPoint.hpp"
+#include "src/include/xbt/parmap.hpp"
+#include "src/kernel/routing/RouteStore.hpp"
+#include "src/simix/smx_private.hpp"
 #include "src/surf/network_interface.hpp"
+#include "src/surf/surf_interface.hpp"
 #include "src/surf/xml/platf_private.hpp"
 #include "surf/surf.hpp"
+#include "xbt/config.hpp"
 #include "xbt/string.hpp"
 
+#include <algorithm>
+#include <cerrno>
 #include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <limits>
+#include <stdexcept>
+#include <unistd.h>
 
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(surf_route_floyd, surf, "Routing part of surf");
 
-#define TO_FLOYD_COST(i, j) (cost_table_)[(i) + (j)*table_size]
-#define TO_FLOYD_PRED(i, j) (predecessor_table_)[(i) + (j)*table_size]
-#define TO_FLOYD_LINK(i, j) (link_table_)[(i) + (j)*table_size]
+static simgrid::config::Flag<std::string> cfg_floyd_cache{
+    "routing/floyd-cache",
+    "Directory in which the Floyd zones save their shortest paths, to reuse them on the same routes (empty: none)",
+    ""};
+
+namespace {
+/* Floyd-Warshall applies the pivots by blocks to chunks of rows, that are updated tile by tile. Every cell still gets
+ * the pivots in order, with the same values as in the textbook triple loop, so the ties are broken the same way. */
+constexpr unsigned int floyd_block = 32;  // pivots applied together
+constexpr unsigned int floyd_chunk = 64;  // rows given together to a thread
+constexpr unsigned int floyd_tile  = 512; // columns updated together
+
+/* Bump this when the computation changes, so that the paths saved by the previous versions are not used anymore */
+constexpr std::uint64_t floyd_cache_version = 1;
+
+/* Goes from a to the columns [begin, end) through the pivot c, if that is shorter */
+inline void floyd_relax(double* cost_a, std::uint32_t* pred_a, double cost_ac, const double* cost_c,
+                        const std::uint32_t* pred_c, unsigned int begin, unsigned int end)
+{
+  if (cost_ac >= DBL_MAX)
+    return;
+  for (unsigned int b = begin; b < end; b++)
+    if (cost_c[b] < DBL_MAX && (fabs(cost_a[b] - DBL_MAX) < std::numeric_limits<double>::epsilon() ||
+                                (cost_ac + cost_c[b] < cost_a[b]))) {
+      cost_a[b] = cost_ac + cost_c[b];
+      pred_a[b] = pred_c[b];
+    }
+}
+
+/* Checks the predecessors loaded from the cache: each one must be a netpoint of the zone with a 1-hop route to the
+ * destination, so that a corrupted file with the right key cannot make get_local_route() read out of the tables */
+bool valid_predecessors(const simgrid::kernel::routing::PairTable& predecessors,
+                        const simgrid::kernel::routing::RouteStore& links, unsigned int table_size)
+{
+  for (unsigned int a = 0; a < table_size; a++)
+    for (unsigned int b = 0; b < table_size; b++) {
+      std::uint32_t pred = predecessors.get(a, b);
+      if (pred > table_size || (pred != 0 && not links.has_route(pred - 1, b)))
+        return false;
+    }
+  return true;
+}
+} // namespace
 
 namespace simgrid {
 namespace kernel {
@@ -26,113 +78,89 @@ namespace routing {
 FloydZone::FloydZone(NetZoneImpl* father, const std::string& name, resource::NetworkModel* netmodel)
     : RoutedZone(father, name, netmodel)
 {
-  predecessor_table_ = nullptr;
-  cost_table_        = nullptr;
-  link_table_        = nullptr;
 }
 
-FloydZone::~FloydZone()
-{
-  if (link_table_ == nullptr) // Dealing with a parse error in the file?
-    return;
-  unsigned int table_size = get_table_size();
-  /* Delete link_table */
-  for (unsigned int i = 0; i < table_size; i++)
-    for (unsigned int j = 0; j < table_size; j++)
-      delete TO_FLOYD_LINK(i, j);
-  delete[] link_table_;
+FloydZone::~FloydZone() = default;
 
-  delete[] predecessor_table_;
-  delete[] cost_table_;
+void FloydZone::init_tables()
+{
+  if (not link_table_) {
+    /* Create the Predecessor and Link tables */
+    unsigned int table_size = get_table_size();
+    predecessor_table_.reset(new PairTable(table_size)); /* predecessor host numbers */
+    link_table_.reset(new RouteStore(table_size));       /* actual link between src and dst */
+  }
 }
 
 void FloydZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArgs* route, double* lat)
 {
-  unsigned int table_size = get_table_size();
-
   get_route_check_params(src, dst);
 
   /* create a result route */
-  std::vector<RouteCreationArgs*> route_stack;
+  std::vector<RouteStore::Route> route_stack;
   unsigned int cur = dst->id();
   do {
-    int pred = TO_FLOYD_PRED(src->id(), cur);
-    if (pred == -1)
+    std::uint32_t pred = predecessor_table_->get(src->id(), cur);
+    if (pred == 0)
       throw std::invalid_argument(xbt::string_printf("No route from '%s' to '%s'", src->get_cname(), dst->get_cname()));
-    route_stack.push_back(TO_FLOYD_LINK(pred, cur));
-    cur = pred;
+    route_stack.push_back(link_table_->get_route(pred - 1, cur));
+    cur = pred - 1;
   } while (cur != src->id());
 
   if (hierarchy_ == RoutingMode::recursive) {
-    route->gw_src = route_stack.back()->gw_src;
-    route->gw_dst = route_stack.front()->gw_dst;
+    route->gw_src = route_stack.back().gw_src;
+    route->gw_dst = route_stack.front().gw_dst;
   }
 
   NetPoint* prev_dst_gw = nullptr;
   while (not route_stack.empty()) {
-    RouteCreationArgs* e_route = route_stack.back();
+    RouteStore::Route e_route = route_stack.back();
     route_stack.pop_back();
     if (hierarchy_ == RoutingMode::recursive && prev_dst_gw != nullptr &&
-        prev_dst_gw->get_cname() != e_route->gw_src->get_cname()) {
-      get_global_route(prev_dst_gw, e_route->gw_src, route->link_list, lat);
+        prev_dst_gw->get_cname() != e_route.gw_src->get_cname()) {
+      get_global_route(prev_dst_gw, e_route.gw_src, route->link_list, lat);
     }
 
-    for (auto const& link : e_route->link_list) {
+    for (auto const& link : e_route) {
       route->link_list.push_back(link);
       if (lat)
         *lat += link->get_latency();
     }
 
-    prev_dst_gw = e_route->gw_dst;
+    prev_dst_gw = e_route.gw_dst;
   }
 }
 
 void FloydZone::add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, NetPoint* gw_dst,
                           std::vector<resource::LinkImpl*>& link_list, bool symmetrical)
 {
-  /* set the size of table routing */
-  unsigned int table_size = get_table_size();
-
   add_route_check_params(src, dst, gw_src, gw_dst, link_list, symmetrical);
 
-  if (not link_table_) {
-    /* Create Cost, Predecessor and Link tables */
-    cost_table_        = new double[table_size * table_size];             /* link cost from host to host */
-    predecessor_table_ = new int[table_size * table_size];                /* predecessor host numbers */
-    link_table_        = new RouteCreationArgs*[table_size * table_size]; /* actual link between src and dst */
-
-    /* Initialize costs and predecessors */
-    for (unsigned int i = 0; i < table_size; i++)
-      for (unsigned int j = 0; j < table_size; j++) {
-        TO_FLOYD_COST(i, j) = DBL_MAX;
-        TO_FLOYD_PRED(i, j) = -1;
-        TO_FLOYD_LINK(i, j) = nullptr;
-      }
-  }
+  init_tables();
 
   /* Check that the route does not already exist */
   if (gw_dst) // netzone route (to adapt the error message, if any)
-    xbt_assert(nullptr == TO_FLOYD_LINK(src->id(), dst->id()),
+    xbt_assert(not link_table_->has_route(src->id(), dst->id()),
                "The route between %s@%s and %s@%s already exists (Rq: routes are symmetrical by default).",
                src->get_cname(), gw_src->get_cname(), dst->get_cname(), gw_dst->get_cname());
   else
-    xbt_assert(nullptr == TO_FLOYD_LINK(src->id(), dst->id()),
+    xbt_assert(not link_table_->has_route(src->id(), dst->id()),
                "The route between %s and %s already exists (Rq: routes are symmetrical by default).", src->get_cname(),
                dst->get_cname());
 
-  TO_FLOYD_LINK(src->id(), dst->id()) =
-      new_extended_route(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, 1);
-  TO_FLOYD_PRED(src->id(), dst->id()) = src->id();
-  TO_FLOYD_COST(src->id(), dst->id()) = (TO_FLOYD_LINK(src->id(), dst->id()))->link_list.size();
+  std::unique_ptr<RouteCreationArgs> route(
+      new_extended_route(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, 1));
+  link_table_->set_route(src->id(), dst->id(), route->gw_src, route->gw_dst, route->link_list);
+  predecessor_table_->set(src->id(), dst->id(), src->id() + 1);
 
   if (symmetrical == true) {
     if (gw_dst) // netzone route (to adapt the error message, if any)
       xbt_assert(
-          nullptr == TO_FLOYD_LINK(dst->id(), src->id()),
+          not link_table_->has_route(dst->id(), src->id()),
           "The route between %s@%s and %s@%s already exists. You should not declare the reverse path as symmetrical.",
           dst->get_cname(), gw_dst->get_cname(), src->get_cname(), gw_src->get_cname());
     else
-      xbt_assert(nullptr == TO_FLOYD_LINK(dst->id(), src->id()),
+      xbt_assert(not link_table_->has_route(dst->id(), src->id()),
                  "The route between %s and %s already exists. You should not declare the reverse path as symmetrical.",
                  dst->get_cname(), src->get_cname());
 
@@ -148,11 +176,9 @@ void FloydZone::add_route(NetPoint* src, NetPoint* dst, NetPoint* gw_src, NetPoi
       XBT_DEBUG("Load NetzoneRoute from \"%s(%s)\" to \"%s(%s)\"", dst->get_cname(), gw_src->get_cname(),
                 src->get_cname(), gw_dst->get_cname());
 
-    TO_FLOYD_LINK(dst->id(), src->id()) =
-        new_extended_route(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, 0);
-    TO_FLOYD_PRED(dst->id(), src->id()) = dst->id();
-    TO_FLOYD_COST(dst->id(), src->id()) =
-        (TO_FLOYD_LINK(dst->id(), src->id()))->link_list.size(); /* count of links, old model assume 1 */
+    route.reset(new_extended_route(hierarchy_, src, dst, gw_src, gw_dst, link_list, symmetrical, 0));
+    link_table_->set_route(dst->id(), src->id(), route->gw_src, route->gw_dst, route->link_list);
+    predecessor_table_->set(dst->id(), src->id(), dst->id() + 1);
   }
 }
 
@@ -161,45 +187,124 @@ void FloydZone::seal()
   /* set the size of table routing */
   unsigned int table_size = get_table_size();
 
-  if (not link_table_) {
-    /* Create Cost, Predecessor and Link tables */
-    cost_table_        = new double[table_size * table_size];             /* link cost from host to host */
-    predecessor_table_ = new int[table_size * table_size];                /* predecessor host numbers */
-    link_table_        = new RouteCreationArgs*[table_size * table_size]; /* actual link between src and dst */
-
-    /* Initialize costs and predecessors */
-    for (unsigned int i = 0; i < table_size; i++)
-      for (unsigned int j = 0; j < table_size; j++) {
-        TO_FLOYD_COST(i, j) = DBL_MAX;
-        TO_FLOYD_PRED(i, j) = -1;
-        TO_FLOYD_LINK(i, j) = nullptr;
-      }
-  }
+  init_tables();
 
   /* Add the loopback if needed */
   if (network_model_->loopback_ && hierarchy_ == RoutingMode::base) {
+    std::vector<resource::LinkImpl*> loopback = {network_model_->loopback_};
     for (unsigned int i = 0; i < table_size; i++) {
-      RouteCreationArgs* route = TO_FLOYD_LINK(i, i);
-      if (not route) {
-        route = new RouteCreationArgs();
-        route->link_list.push_back(network_model_->loopback_);
-        TO_FLOYD_LINK(i, i) = route;
-        TO_FLOYD_PRED(i, i) = i;
-        TO_FLOYD_COST(i, i) = 1;
+      if (not link_table_->has_route(i, i)) {
+        link_table_->set_route(i, i, nullptr, nullptr, loopback);
+        predecessor_table_->set(i, i, i + 1);
       }
     }
   }
-  /* Calculate path costs */
-  for (unsigned int c = 0; c < table_size; c++) {
-    for (unsigned int a = 0; a < table_size; a++) {
-      for (unsigned int b = 0; b < table_size; b++) {
-        if (TO_FLOYD_COST(a, c) < DBL_MAX && TO_FLOYD_COST(c, b) < DBL_MAX &&
-            (fabs(TO_FLOYD_COST(a, b) - DBL_MAX) < std::numeric_limits<double>::epsilon() ||
-             (TO_FLOYD_COST(a, c) + TO_FLOYD_COST(c, b) < TO_FLOYD_COST(a, b)))) {
-          TO_FLOYD_COST(a, b) = TO_FLOYD_COST(a, c) + TO_FLOYD_COST(c, b);
-          TO_FLOYD_PRED(a, b) = TO_FLOYD_PRED(c, b);
+  link_table_->seal();
+
+  /* The paths only depend on the amount of links of the 1-hop routes, that are summed up in the key of the cache */
+  std::string cache_file;
+  std::uint64_t cache_key = 14695981039346656037ULL; // FNV-1a, word by word
+  if (not cfg_floyd_cache.get().empty()) {
+    for (std::uint64_t word : {floyd_cache_version, std::uint64_t(table_size)})
+      cache_key = (cache_key ^ word) * 1099511628211ULL;
+    for (unsigned int i = 0; i < table_size; i++)
+      for (unsigned int j = 0; j < table_size; j++) {
+        std::uint64_t word = link_table_->has_route(i, j) ? link_table_->get_route(i, j).size() + 1 : 0;
+        cache_key          = (cache_key ^ word) * 1099511628211ULL;
+      }
+    cache_file = xbt::string_printf("%s/floyd-%016llx.bin", cfg_floyd_cache.get().c_str(),
+                                    static_cast<unsigned long long>(cache_key));
+    if (predecessor_table_->load(cache_file, cache_key)) {
+      if (valid_predecessors(*predecessor_table_, *link_table_, table_size)) {
+        XBT_VERB("Shortest paths of zone %s loaded from the cache (key %016llx)", get_cname(),
+                 static_cast<unsigned long long>(cache_key));
+        return;
+      }
+      XBT_WARN("Ignoring the corrupted shortest paths of zone %s in the cache (key %016llx)", get_cname(),
+               static_cast<unsigned long long>(cache_key));
+      /* Start again from the predecessors of the 1-hop routes, as set by add_route() */
+      for (unsigned int i = 0; i < table_size; i++)
+        for (unsigned int j = 0; j < table_size; j++)
+          predecessor_table_->set(i, j, link_table_->has_route(i, j) ? i + 1 : 0);
+    }
+  }
+
+  /* The costs are the amount of links of the 1-hop routes (the old model assumed 1), and are only needed here */
+  std::vector<double> cost_table(std::size_t(table_size) * table_size, DBL_MAX);
+  for (unsigned int i = 0; i < table_size; i++)
+    for (unsigned int j = 0; j < table_size; j++)
+      if (link_table_->has_route(i, j))
+        cost_table[std::size_t(i) * table_size + j] = link_table_->get_route(i, j).size();
+
+  /* Calculate path costs, by blocks of pivots */
+  std::vector<double> pivot_costs(std::size_t(floyd_block) * table_size);
+  std::vector<std::uint32_t> pivot_preds(std::size_t(floyd_block) * table_size);
+  std::vector<unsigned int> chunks;
+  for (unsigned int a = 0; a < table_size; a += floyd_chunk)
+    chunks.push_back(a);
+  std::unique_ptr<xbt::Parmap<unsigned int>> parmap;
+  // Logging is not thread-safe, and the workers need contexts
+  if (sg_routing_threads > 1 && chunks.size() > 1 && simix_global != nullptr && simix_global->context_factory &&
+      not XBT_LOG_ISENABLED(surf_route_floyd, xbt_log_priority_debug))
+    parmap.reset(new xbt::Parmap<unsigned int>(sg_routing_threads, XBT_PARMAP_DEFAULT));
+
+  for (unsigned int first = 0; first < table_size; first += floyd_block) {
+    unsigned int last = std::min(first + floyd_block, table_size);
+    XBT_DEBUG("Applying the pivots %u to %u", first, last - 1);
+
+    /* The rows of the pivots get the previous pivots of the block, and are saved as they are when used as pivots */
+    for (unsigned int c = first; c < last; c++) {
+      std::copy_n(&cost_table[std::size_t(c) * table_size], table_size,
+                  &pivot_costs[std::size_t(c - first) * table_size]);
+      std::copy_n(predecessor_table_->row(c), table_size, &pivot_preds[std::size_t(c - first) * table_size]);
+      for (unsigned int a = first; a < last; a++)
+        floyd_relax(&cost_table[std::size_t(a) * table_size], predecessor_table_->row(a),
+                    cost_table[std::size_t(a) * table_size + c], &pivot_costs[std::size_t(c - first) * table_size],
+                    &pivot_preds[std::size_t(c - first) * table_size], 0, table_size);
+    }
+
+    /* The other rows get all pivots of the block: first on the columns of the pivots, remembering their cost to the
+     * pivot when it is applied, and then on the other columns, tile by tile */
+    auto relax_rows = [this, table_size, first, last, &cost_table, &pivot_costs, &pivot_preds](unsigned int chunk) {
+      double costs_to_pivots[floyd_block];
+      for (unsigned int a = chunk; a < std::min(chunk + floyd_chunk, table_size); a++) {
+        if (a >= first && a < last)
+          continue;
+        double* cost_a        = &cost_table[std::size_t(a) * table_size];
+        std::uint32_t* pred_a = predecessor_table_->row(a);
+        for (unsigned int c = first; c < last; c++) {
+          costs_to_pivots[c - first] = cost_a[c];
+          floyd_relax(cost_a, pred_a, cost_a[c], &pivot_costs[std::size_t(c - first) * table_size],
+                      &pivot_preds[std::size_t(c - first) * table_size], first, last);
+        }
+        for (unsigned int tile = 0; tile < table_size; tile += floyd_tile) {
+          unsigned int tile_end = std::min(tile + floyd_tile, table_size);
+          for (unsigned int c = first; c < last; c++) {
+            const double* cost_c        = &pivot_costs[std::size_t(c - first) * table_size];
+            const std::uint32_t* pred_c = &pivot_preds[std::size_t(c - first) * table_size];
+            floyd_relax(cost_a, pred_a, costs_to_pivots[c - first], cost_c, pred_c, tile, std::min(tile_end, first));
+            floyd_relax(cost_a, pred_a, costs_to_pivots[c - first], cost_c, pred_c, std::max(tile, last), tile_end);
+          }
         }
       }
+    };
+    if (parmap)
+      parmap->apply(relax_rows, chunks);
+    else
+      for (unsigned int chunk : chunks)
+        relax_rows(chunk);
+  }
+
+  if (not cache_file.empty()) {
+    /* Write a temporary file and rename it, so that the simulations started meanwhile never read a partial file */
+    std::string tmp_file = xbt::string_printf("%s.%d.tmp", cache_file.c_str(), static_cast<int>(getpid()));
+    if (predecessor_table_->save(tmp_file, cache_key) && std::rename(tmp_file.c_str(), cache_file.c_str()) == 0) {
+      XBT_VERB("Shortest paths of zone %s saved in the cache (key %016llx)", get_cname(),
+               static_cast<unsigned long long>(cache_key));
+    } else {
+      XBT_WARN("Cannot save the shortest paths of zone %s to %s: %s", get_cname(), cache_file.c_str(),
+               strerror(errno));
+      std::remove(tmp_file.c_str());
     }
   }
 }
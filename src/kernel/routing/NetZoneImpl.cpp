@@ -7,8 +7,10 @@
 #include "simgrid/kernel/routing/NetPoint.hpp"
 #include "simgrid/s4u/Engine.hpp"
 #include "simgrid/s4u/Host.hpp"
+#include "src/kernel/EngineImpl.hpp"
 #include "src/surf/cpu_interface.hpp"
 #include "src/surf/network_interface.hpp"
+#include "src/surf/surf_interface.hpp"
 #include "src/surf/xml/platf_private.hpp"
 #include "surf/surf.hpp"
 
@@ -32,6 +34,15 @@ NetZoneImpl::NetZoneImpl(NetZoneImpl* father, const std::string& name, resource:
   xbt_assert(nullptr == simgrid::s4u::Engine::get_instance()->netpoint_by_name_or_null(get_name()),
              "Refusing to create a second NetZone called '%s'.", get_cname());
 
+  /* Prepare the search of the common ancestors, by doubling the distance to each next ancestor */
+  if (father != nullptr) {
+    depth_ = father->depth_ + 1;
+    ancestors_.push_back(father);
+    for (unsigned int i = 0; i < ancestors_[i]->ancestors_.size(); i++)
+      ancestors_.push_back(ancestors_[i]->ancestors_[i]);
+  }
+  RouteMemo::invalidate_all();
+
   netpoint_ = new NetPoint(name_, NetPoint::Type::NetZone, father);
   XBT_DEBUG("NetZone '%s' created with the id '%u'", get_cname(), netpoint_->id());
 }
@@ -54,6 +65,15 @@ NetZoneImpl* NetZoneImpl::get_father()
 {
   return father_;
 }
+NetZoneImpl* NetZoneImpl::get_ancestor(unsigned int distance)
+{
+  xbt_assert(distance <= depth_, "NetZone '%s' has no ancestor at distance %u", get_cname(), distance);
+  NetZoneImpl* ancestor = this;
+  for (unsigned int i = 0; distance > 0; i++, distance >>= 1)
+    if (distance & 1)
+      ancestor = ancestor->ancestors_[i];
+  return ancestor;
+}
 void NetZoneImpl::seal()
 {
   sealed_ = true;
@@ -75,6 +95,8 @@ std::vector<s4u::Host*> NetZoneImpl::get_all_hosts()
 {
   std::vector<s4u::Host*> res;
   for (auto const& card : get_vertices()) {
+    if (card == nullptr) // Reserved for a component that is not created yet (see ClusterZone::set_lazy_nodes())
+      continue;
     s4u::Host* host = simgrid::s4u::Host::by_name_or_null(card->get_name());
     if (host != nullptr)
       res.push_back(host);
@@ -85,6 +107,8 @@ int NetZoneImpl::get_host_count()
 {
   int count = 0;
   for (auto const& card : get_vertices()) {
+    if (card == nullptr)
+      continue;
     s4u::Host* host = simgrid::s4u::Host::by_name_or_null(card->get_name());
     if (host != nullptr)
       count++;
@@ -114,9 +138,19 @@ simgrid::s4u::Host* NetZoneImpl::create_host(const char* name, const std::vector
 
 int NetZoneImpl::add_component(kernel::routing::NetPoint* elm)
 {
+  RouteMemo::invalidate_all();
   vertices_.push_back(elm);
   return vertices_.size() - 1; // The rank of the newly created object
 }
+
+int NetZoneImpl::add_component_at(kernel::routing::NetPoint* elm, unsigned int id)
+{
+  xbt_assert(id < vertices_.size() && vertices_[id] == nullptr, "The id %u of the netzone %s is not reserved", id,
+             get_cname());
+  RouteMemo::invalidate_all();
+  vertices_[id] = elm;
+  return id;
+}
 void NetZoneImpl::add_route(kernel::routing::NetPoint* /*src*/, kernel::routing::NetPoint* /*dst*/,
                             kernel::routing::NetPoint* /*gw_src*/, kernel::routing::NetPoint* /*gw_dst*/,
                             std::vector<kernel::resource::LinkImpl*>& /*link_list*/, bool /*symmetrical*/)
@@ -151,6 +185,7 @@ void NetZoneImpl::add_bypass_route(NetPoint* src, NetPoint* dst, NetPoint* gw_sr
 
   /* Store it */
   bypass_routes_.insert({{src, dst}, newRoute});
+  RouteMemo::invalidate_all();
 }
 
 /** @brief Get the common ancestor and its first children in each line leading to src and dst
@@ -216,50 +251,49 @@ static void find_common_ancestors(NetPoint* src, NetPoint* dst,
   }
 
   /* engage the full recursive search */
-
-  /* (1) find the path to root of src and dst*/
   NetZoneImpl* src_as = src->get_englobing_zone();
   NetZoneImpl* dst_as = dst->get_englobing_zone();
 
   xbt_assert(src_as, "Host %s must be in a netzone", src->get_cname());
   xbt_assert(dst_as, "Host %s must be in a netzone", dst->get_cname());
 
-  /* (2) find the path to the root routing component */
-  std::vector<NetZoneImpl*> path_src;
-  NetZoneImpl* current = src->get_englobing_zone();
-  while (current != nullptr) {
-    path_src.push_back(current);
-    current = static_cast<NetZoneImpl*>(current->get_father());
-  }
-  std::vector<NetZoneImpl*> path_dst;
-  current = dst->get_englobing_zone();
-  while (current != nullptr) {
-    path_dst.push_back(current);
-    current = static_cast<NetZoneImpl*>(current->get_father());
+  /* (1) bring the deepest of both netzones up to the depth of the other one */
+  if (src_as->get_depth() > dst_as->get_depth())
+    src_as = src_as->get_ancestor(src_as->get_depth() - dst_as->get_depth());
+  else
+    dst_as = dst_as->get_ancestor(dst_as->get_depth() - src_as->get_depth());
+
+  /* (2) if they meet, src is the ancestor of dst, or the contrary */
+  if (src_as == dst_as) {
+    *common_ancestor = src_as;
+    *src_ancestor    = src_as;
+    *dst_ancestor    = src_as;
+    return;
   }
 
-  /* (3) find the common father.
-   * Before that, index_src and index_dst may be different, they both point to nullptr in path_src/path_dst
-   * So we move them down simultaneously as long as they point to the same content.
+  /* (3) go up simultaneously by decreasing steps, as long as the ancestors differ. This leads to the first different
+   * fathers of src and dst, right below the common father.
    *
-   * This works because all SimGrid platform have a unique root element (that is the last element of both paths).
+   * This works because all SimGrid platform have a unique root element.
    */
-  NetZoneImpl* father = nullptr; // the netzone we dropped on the previous loop iteration
-  while (path_src.size() > 1 && path_dst.size() > 1 &&
-         path_src.at(path_src.size() - 1) == path_dst.at(path_dst.size() - 1)) {
-    father = path_src.at(path_src.size() - 1);
-    path_src.pop_back();
-    path_dst.pop_back();
+  unsigned int step = 1;
+  while (2 * step <= src_as->get_depth())
+    step *= 2;
+  for (; step > 0; step /= 2) {
+    if (step > src_as->get_depth())
+      continue;
+    NetZoneImpl* src_next = src_as->get_ancestor(step);
+    NetZoneImpl* dst_next = dst_as->get_ancestor(step);
+    if (src_next != dst_next) {
+      src_as = src_next;
+      dst_as = dst_next;
+    }
   }
 
   /* (4) we found the difference at least. Finalize the returned values */
-  *src_ancestor = path_src.at(path_src.size() - 1); /* the first different father of src */
-  *dst_ancestor = path_dst.at(path_dst.size() - 1); /* the first different father of dst */
-  if (*src_ancestor == *dst_ancestor) {             // src is the ancestor of dst, or the contrary
-    *common_ancestor = *src_ancestor;
-  } else {
-    *common_ancestor = father;
-  }
+  *src_ancestor    = src_as; /* the first different father of src */
+  *dst_ancestor    = dst_as; /* the first different father of dst */
+  *common_ancestor = src_as->get_father();
 }
 
 /* PRECONDITION: this is the common ancestor of src and dst */
@@ -288,30 +322,19 @@ bool NetZoneImpl::get_bypass_route(routing::NetPoint* src, routing::NetPoint* ds
 
   /* Engage recursive search */
 
-  /* (1) find the path to the root routing component */
-  std::vector<NetZoneImpl*> path_src;
-  NetZoneImpl* current = src->get_englobing_zone();
-  while (current != nullptr) {
-    path_src.push_back(static_cast<NetZoneImpl*>(current));
-    current = current->father_;
-  }
-
-  std::vector<NetZoneImpl*> path_dst;
-  current = dst->get_englobing_zone();
-  while (current != nullptr) {
-    path_dst.push_back(static_cast<NetZoneImpl*>(current));
-    current = current->father_;
-  }
-
-  /* (2) find the common father */
-  while (path_src.size() > 1 && path_dst.size() > 1 &&
-         path_src.at(path_src.size() - 1) == path_dst.at(path_dst.size() - 1)) {
-    path_src.pop_back();
-    path_dst.pop_back();
-  }
+  /* (1) find the first different fathers of src and dst, below the common ancestor */
+  NetZoneImpl* common_ancestor;
+  NetZoneImpl* src_ancestor;
+  NetZoneImpl* dst_ancestor;
+  find_common_ancestors(src, dst, &common_ancestor, &src_ancestor, &dst_ancestor);
 
-  int max_index_src = path_src.size() - 1;
-  int max_index_dst = path_dst.size() - 1;
+  /* (2) the paths to these fathers: path_src(i) is the ancestor of src at distance i */
+  NetZoneImpl* src_as = src->get_englobing_zone();
+  NetZoneImpl* dst_as = dst->get_englobing_zone();
+  auto path_src       = [src_as](int i) { return src_as->get_ancestor(i); };
+  auto path_dst       = [dst_as](int i) { return dst_as->get_ancestor(i); };
+  int max_index_src   = src_as->get_depth() - src_ancestor->get_depth();
+  int max_index_dst   = dst_as->get_depth() - dst_ancestor->get_depth();
 
   int max_index = std::max(max_index_src, max_index_dst);
 
@@ -321,7 +344,7 @@ bool NetZoneImpl::get_bypass_route(routing::NetPoint* src, routing::NetPoint* ds
   for (int max = 0; max <= max_index; max++) {
     for (int i = 0; i < max; i++) {
       if (i <= max_index_src && max <= max_index_dst) {
-        key = {path_src.at(i)->netpoint_, path_dst.at(max)->netpoint_};
+        key = {path_src(i)->netpoint_, path_dst(max)->netpoint_};
         auto bpr = bypass_routes_.find(key);
         if (bpr != bypass_routes_.end()) {
           bypassedRoute = bpr->second;
@@ -329,7 +352,7 @@ bool NetZoneImpl::get_bypass_route(routing::NetPoint* src, routing::NetPoint* ds
         }
       }
       if (max <= max_index_src && i <= max_index_dst) {
-        key = {path_src.at(max)->netpoint_, path_dst.at(i)->netpoint_};
+        key = {path_src(max)->netpoint_, path_dst(i)->netpoint_};
         auto bpr = bypass_routes_.find(key);
         if (bpr != bypass_routes_.end()) {
           bypassedRoute = bpr->second;
@@ -342,7 +365,7 @@ bool NetZoneImpl::get_bypass_route(routing::NetPoint* src, routing::NetPoint* ds
       break;
 
     if (max <= max_index_src && max <= max_index_dst) {
-      key = {path_src.at(max)->netpoint_, path_dst.at(max)->netpoint_};
+      key = {path_src(max)->netpoint_, path_dst(max)->netpoint_};
       auto bpr = bypass_routes_.find(key);
       if (bpr != bypass_routes_.end()) {
         bypassedRoute = bpr->second;
@@ -373,6 +396,29 @@ bool NetZoneImpl::get_bypass_route(routing::NetPoint* src, routing::NetPoint* ds
 
 void NetZoneImpl::get_global_route(NetPoint* src, NetPoint* dst,
                                    /* OUT */ std::vector<resource::LinkImpl*>& links, double* latency)
+{
+  /* Only the routes computed from empty accumulators are memoized, so that the latencies are summed in the same order
+   * with or without the memo */
+  RouteMemo& memo = get_route_memo();
+  if (not memo.is_enabled() || not links.empty() || (latency != nullptr && *latency != 0.0)) {
+    compute_global_route(src, dst, links, latency);
+    return;
+  }
+
+  RouteMemo::Route storage;
+  const RouteMemo::Route& route = memo.get(src, dst, storage);
+  links                         = route.links;
+  if (latency)
+    *latency = route.latency;
+}
+
+RouteMemo& NetZoneImpl::get_route_memo()
+{
+  return s4u::Engine::get_instance()->pimpl->route_memo_;
+}
+
+void NetZoneImpl::compute_global_route(NetPoint* src, NetPoint* dst,
+                                       /* OUT */ std::vector<resource::LinkImpl*>& links, double* latency)
 {
   RouteCreationArgs route;
 
@@ -0,0 +1,78 @@
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#include "src/kernel/routing/RouteMemo.hpp"
+#include "simgrid/kernel/routing/NetPoint.hpp"
+#include "simgrid/kernel/routing/NetZoneImpl.hpp"
+#include "src/surf/surf_interface.hpp"
+#include "xbt/log.h"
+
+#include <algorithm>
+
+XBT_LOG_EXTERNAL_DEFAULT_CATEGORY(surf_route);
+
+int sg_route_cache_size = 65536; /* Change this with --cfg=network/route-cache:VALUE */
+
+namespace simgrid {
+namespace kernel {
+namespace routing {
+
+unsigned long long RouteMemo::generation_ = 0;
+
+bool RouteMemo::is_enabled() const
+{
+  return sg_route_cache_size > 0 && not computing_;
+}
+
+const RouteMemo::Route& RouteMemo::get(NetPoint* src, NetPoint* dst, Route& storage)
+{
+  storage.links.clear();
+  storage.latency = 0.0;
+  if (not is_enabled()) {
+    NetZoneImpl::compute_global_route(src, dst, storage.links, &storage.latency);
+    return storage;
+  }
+
+  if (known_generation_ != generation_) {
+    XBT_DEBUG("The platform changed, flushing the %zu memoized routes", entries_.size());
+    index_.clear();
+    entries_.clear();
+    known_generation_ = generation_;
+  }
+
+  Key key(src, dst);
+  auto known = index_.find(key);
+  if (known != index_.end()) {
+    XBT_DEBUG("Found the route from '%s' to '%s' in the memo", src->get_cname(), dst->get_cname());
+    hits_++;
+    entries_.splice(entries_.begin(), entries_, known->second);
+    return known->second->second;
+  }
+
+  misses_++;
+  /* The routes between the gateways on the way are not memoized, so that this call evicts at most one route */
+  computing_ = true;
+  try {
+    NetZoneImpl::compute_global_route(src, dst, storage.links, &storage.latency);
+  } catch (...) {
+    computing_ = false;
+    throw;
+  }
+  computing_ = false;
+
+  /* Keep room for two routes, so that the route returned by the previous call (e.g. the route of a communication when
+   * looking for its back route) is not evicted */
+  std::size_t capacity = static_cast<std::size_t>(std::max(sg_route_cache_size, 2));
+  while (entries_.size() >= capacity) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(key, std::move(storage));
+  index_.emplace(key, entries_.begin());
+  return entries_.front().second;
+}
+} // namespace routing
+} // namespace kernel
+} // namespace simgrid
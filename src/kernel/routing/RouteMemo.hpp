@@ -0,0 +1,73 @@
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#ifndef SIMGRID_ROUTING_ROUTEMEMO_HPP_
+#define SIMGRID_ROUTING_ROUTEMEMO_HPP_
+
+#include <simgrid/forward.h>
+#include <xbt/base.h>
+
+#include <boost/functional/hash.hpp>
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace simgrid {
+namespace kernel {
+namespace routing {
+
+/** @brief Engine-wide cache of the routes between pairs of netpoints, with their latency (see network/route-cache)
+ *
+ * It serves both NetZoneImpl::get_global_route() and the communications of the network models. It holds a bounded
+ * amount of routes, and the least recently used ones are evicted first. It is flushed whenever the platform changes
+ * (new zones, netpoints or routes, sealing of a zone) or the latency of a link changes, since the latency of the
+ * routes is kept with their links.
+ */
+class XBT_PUBLIC RouteMemo {
+public:
+  struct Route {
+    std::vector<resource::LinkImpl*> links;
+    double latency = 0.0;
+  };
+
+  RouteMemo() = default;
+  RouteMemo(const RouteMemo&) = delete;
+  RouteMemo& operator=(const RouteMemo&) = delete;
+
+  /** @brief Whether the routes are memoized: network/route-cache is positive, and no route is being memoized */
+  bool is_enabled() const;
+  /** @brief Returns the route from src to dst, that is computed and memoized if it is not known yet.
+   *
+   * The route is computed into storage when the memo is disabled. The returned route remains valid until the second
+   * next call, as the memo holds at least two routes and the routes computed on the way are not memoized. */
+  const Route& get(NetPoint* src, NetPoint* dst, Route& storage);
+  /** @brief Flushes the memo (at its next use) */
+  static void invalidate_all() { generation_++; }
+
+  std::size_t get_size() const { return entries_.size(); }
+  /** Amount of routes found in the memo since the beginning of the simulation */
+  unsigned long long get_hits() const { return hits_; }
+  /** Amount of routes looked up but not found in the memo since the beginning of the simulation */
+  unsigned long long get_misses() const { return misses_; }
+
+private:
+  typedef std::pair<const NetPoint*, const NetPoint*> Key;
+  typedef std::list<std::pair<Key, Route>> Entries;
+  static unsigned long long generation_;
+
+  unsigned long long known_generation_ = 0;
+  bool computing_                      = false;
+  unsigned long long hits_             = 0;
+  unsigned long long misses_           = 0;
+  Entries entries_; // the most recently used first
+  std::unordered_map<Key, Entries::iterator, boost::hash<Key>> index_;
+};
+} // namespace routing
+} // namespace kernel
+} // namespace simgrid
+
+#endif /* SIMGRID_ROUTING_ROUTEMEMO_HPP_ */
@@ -0,0 +1,166 @@
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#include "src/kernel/routing/RouteStore.hpp"
+#include "src/internal_config.h"
+#include "xbt/asserts.h"
+
+#include <algorithm>
+#include <boost/functional/hash.hpp>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
+namespace {
+/* Saved tables start with that header, followed by their values in row order */
+constexpr char table_magic[8]            = {'S', 'G', 'P', 'A', 'I', 'R', 'S', '1'};
+constexpr std::uint64_t table_byte_order = 0x0102030405060708ULL;
+struct TableHeader {
+  char magic[8];
+  std::uint64_t byte_order; // table_byte_order, as written by the machine that produced the file
+  std::uint64_t size;       // amount of rows (and of columns)
+  std::uint64_t key;
+};
+} // namespace
+
+namespace simgrid {
+namespace kernel {
+namespace routing {
+
+PairTable::PairTable(unsigned int size) : size_(size)
+{
+  std::size_t bytes = size_ * size_ * sizeof(std::uint32_t);
+#if HAVE_MMAP
+  if (bytes >= mapping_threshold) {
+    void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapping != MAP_FAILED) { // Anonymous mappings are filled with zeros
+      data_         = static_cast<std::uint32_t*>(mapping);
+      mapping_      = mapping;
+      mapping_size_ = bytes;
+      return;
+    }
+  }
+#endif
+  data_ = new std::uint32_t[size_ * size_]();
+}
+
+PairTable::~PairTable()
+{
+#if HAVE_MMAP
+  if (mapping_) {
+    munmap(mapping_, mapping_size_);
+    return;
+  }
+#endif
+  delete[] data_;
+}
+
+bool PairTable::load(const std::string& path, std::uint64_t key)
+{
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  if (file == nullptr)
+    return false;
+  std::size_t bytes = size_ * size_ * sizeof(std::uint32_t);
+  TableHeader header;
+  bool valid = std::fread(&header, sizeof header, 1, file) == 1 &&
+               std::memcmp(header.magic, table_magic, sizeof table_magic) == 0 &&
+               header.byte_order == table_byte_order && header.size == size_ && header.key == key &&
+               std::fseek(file, 0, SEEK_END) == 0 && std::ftell(file) == static_cast<long>(sizeof header + bytes);
+  if (not valid) {
+    std::fclose(file);
+    return false;
+  }
+
+#if HAVE_MMAP
+  void* mapping = mmap(nullptr, sizeof header + bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(file), 0);
+  if (mapping != MAP_FAILED) {
+    std::fclose(file);
+    if (mapping_)
+      munmap(mapping_, mapping_size_);
+    else
+      delete[] data_;
+    mapping_      = mapping;
+    mapping_size_ = sizeof header + bytes;
+    data_         = reinterpret_cast<std::uint32_t*>(static_cast<char*>(mapping) + sizeof header);
+    return true;
+  }
+#endif
+  /* Read everything before overwriting the current values, that must remain untouched on error */
+  std::vector<std::uint32_t> values(size_ * size_);
+  valid = std::fseek(file, sizeof header, SEEK_SET) == 0 && std::fread(values.data(), bytes, 1, file) == 1;
+  std::fclose(file);
+  if (valid)
+    std::copy(values.begin(), values.end(), data_);
+  return valid;
+}
+
+bool PairTable::save(const std::string& path, std::uint64_t key) const
+{
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr)
+    return false;
+  TableHeader header;
+  std::memcpy(header.magic, table_magic, sizeof table_magic);
+  header.byte_order = table_byte_order;
+  header.size       = size_;
+  header.key        = key;
+  bool ok = std::fwrite(&header, sizeof header, 1, file) == 1 &&
+            std::fwrite(data_, sizeof(std::uint32_t), size_ * size_, file) == size_ * size_;
+  return std::fclose(file) == 0 && ok;
+}
+
+RouteStore::Route RouteStore::get_route(unsigned int src, unsigned int dst) const
+{
+  std::uint32_t id = table_.get(src, dst);
+  xbt_assert(id != 0, "No route stored between the netpoints #%u and #%u", src, dst);
+  const Sequence& sequence = routes_[id - 1];
+  Route route;
+  route.gw_src = sequence.gw_src;
+  route.gw_dst = sequence.gw_dst;
+  route.begin_ = links_.data() + sequence.offset;
+  route.end_   = route.begin_ + sequence.size;
+  return route;
+}
+
+void RouteStore::set_route(unsigned int src, unsigned int dst, NetPoint* gw_src, NetPoint* gw_dst,
+                           const std::vector<resource::LinkImpl*>& links)
+{
+  std::size_t hash = boost::hash_range(links.begin(), links.end());
+  boost::hash_combine(hash, gw_src);
+  boost::hash_combine(hash, gw_dst);
+
+  auto candidates = index_.equal_range(hash);
+  for (auto it = candidates.first; it != candidates.second; ++it) {
+    const Sequence& sequence = routes_[it->second];
+    if (sequence.gw_src == gw_src && sequence.gw_dst == gw_dst && sequence.size == links.size() &&
+        std::equal(links.begin(), links.end(), links_.begin() + sequence.offset)) {
+      table_.set(src, dst, it->second + 1);
+      return;
+    }
+  }
+
+  xbt_assert(routes_.size() < std::numeric_limits<std::uint32_t>::max() - 1 &&
+                 links_.size() + links.size() <= std::numeric_limits<std::uint32_t>::max(),
+             "Too many routes in this zone");
+  auto id = static_cast<std::uint32_t>(routes_.size());
+  routes_.push_back(
+      {gw_src, gw_dst, static_cast<std::uint32_t>(links_.size()), static_cast<std::uint32_t>(links.size())});
+  links_.insert(links_.end(), links.begin(), links.end());
+  index_.emplace(hash, id);
+  table_.set(src, dst, id + 1);
+}
+
+void RouteStore::seal()
+{
+  index_ = std::unordered_multimap<std::size_t, std::uint32_t>();
+  routes_.shrink_to_fit();
+  links_.shrink_to_fit();
+}
+} // namespace routing
+} // namespace kernel
+} // namespace simgrid
@@ -0,0 +1,112 @@
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#ifndef SIMGRID_ROUTING_ROUTESTORE_HPP_
+#define SIMGRID_ROUTING_ROUTESTORE_HPP_
+
+#include <simgrid/forward.h>
+#include <xbt/base.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace simgrid {
+namespace kernel {
+namespace routing {
+
+/** @brief A square table of 32-bit values, indexed by pairs of netpoints and initialized to 0
+ *
+ *  Large tables are mapped in memory, so that the pages that remain 0 (the pairs without route) are never allocated.
+ */
+class XBT_PUBLIC PairTable {
+public:
+  /** Size (in bytes) from which the tables are mapped in memory */
+  static constexpr std::size_t mapping_threshold = 1 << 20;
+
+  explicit PairTable(unsigned int size);
+  PairTable(const PairTable&) = delete;
+  PairTable& operator=(const PairTable&) = delete;
+  ~PairTable();
+
+  std::uint32_t get(unsigned int src, unsigned int dst) const { return data_[src * size_ + dst]; }
+  void set(unsigned int src, unsigned int dst, std::uint32_t value) { data_[src * size_ + dst] = value; }
+  /** The values from that source, that are contiguous */
+  std::uint32_t* row(unsigned int src) { return data_ + src * size_; }
+  bool is_mapped() const { return mapping_ != nullptr; }
+
+  /** @brief Replaces the values with the ones written by save() in that file, that is mapped in memory if possible
+   *
+   *  @return false if the file does not exist, or was saved with another key or for another size of table
+   */
+  bool load(const std::string& path, std::uint64_t key);
+  /** @brief Writes the values in that file along with the key that load() expects, or returns false on error */
+  bool save(const std::string& path, std::uint64_t key) const;
+
+private:
+  std::size_t size_;
+  std::uint32_t* data_;
+  void* mapping_            = nullptr; // the anonymous mapping or the mapped file holding data_, if any
+  std::size_t mapping_size_ = 0;
+};
+
+/** @brief The routes between the netpoints of a zone, where the identical routes share their links
+ *
+ *  The links of all routes are stored in a single array, in which identical sequences of links (with the same gateways)
+ *  are interned once. A PairTable gives the route of each pair of netpoints.
+ */
+class XBT_PUBLIC RouteStore {
+public:
+  /** @brief A route of the store, that remains valid as long as no other route is added */
+  class Route {
+  public:
+    NetPoint* gw_src = nullptr;
+    NetPoint* gw_dst = nullptr;
+    resource::LinkImpl* const* begin() const { return begin_; }
+    resource::LinkImpl* const* end() const { return end_; }
+    std::size_t size() const { return end_ - begin_; }
+
+  private:
+    friend RouteStore;
+    resource::LinkImpl* const* begin_ = nullptr;
+    resource::LinkImpl* const* end_   = nullptr;
+  };
+
+  explicit RouteStore(unsigned int size) : table_(size) {}
+
+  bool has_route(unsigned int src, unsigned int dst) const { return table_.get(src, dst) != 0; }
+  /** @brief Returns the route from src to dst, that must exist */
+  Route get_route(unsigned int src, unsigned int dst) const;
+  /** @brief Sets the route from src to dst, sharing its storage with an identical route if any */
+  void set_route(unsigned int src, unsigned int dst, NetPoint* gw_src, NetPoint* gw_dst,
+                 const std::vector<resource::LinkImpl*>& links);
+  /** @brief Drops the index of the routes and trims the storage, once the routes are known */
+  void seal();
+
+  /** Amount of distinct routes */
+  std::size_t get_route_count() const { return routes_.size(); }
+  /** Amount of links in the distinct routes */
+  std::size_t get_link_count() const { return links_.size(); }
+  bool is_mapped() const { return table_.is_mapped(); }
+
+private:
+  struct Sequence {
+    NetPoint* gw_src;
+    NetPoint* gw_dst;
+    std::uint32_t offset; // in links_
+    std::uint32_t size;
+  };
+  PairTable table_;                        // 1 + index in routes_ of each pair, or 0
+  std::vector<Sequence> routes_;           // the distinct routes
+  std::vector<resource::LinkImpl*> links_; // the links of all distinct routes
+  std::unordered_multimap<std::size_t, std::uint32_t> index_; // hash of a route -> its index in routes_
+};
+} // namespace routing
+} // namespace kernel
+} // namespace simgrid
+
+#endif /* SIMGRID_ROUTING_ROUTESTORE_HPP_ */
@@ -0,0 +1,107 @@
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#include "src/kernel/routing/RouteStore.hpp"
+
+#include "catch.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using simgrid::kernel::resource::LinkImpl;
+using simgrid::kernel::routing::NetPoint;
+using simgrid::kernel::routing::PairTable;
+using simgrid::kernel::routing::RouteStore;
+
+/* The store never dereferences the links nor the gateways, so fake addresses are enough */
+static LinkImpl* fake_link(std::uintptr_t i)
+{
+  return reinterpret_cast<LinkImpl*>(0x1000 + 0x10 * i);
+}
+static NetPoint* fake_netpoint(std::uintptr_t i)
+{
+  return reinterpret_cast<NetPoint*>(0x100000 + 0x10 * i);
+}
+
+TEST_CASE("kernel::routing::RouteStore: compact storage of the routes", "[kernel-routing]")
+{
+  SECTION("Routes are given back as they were set")
+  {
+    RouteStore store(3);
+    std::vector<LinkImpl*> links = {fake_link(1), fake_link(2), fake_link(3)};
+    REQUIRE_FALSE(store.has_route(0, 2));
+    store.set_route(0, 2, nullptr, nullptr, links);
+    store.seal();
+
+    REQUIRE(store.has_route(0, 2));
+    REQUIRE_FALSE(store.has_route(2, 0));
+    RouteStore::Route route = store.get_route(0, 2);
+    REQUIRE(route.gw_src == nullptr);
+    REQUIRE(route.gw_dst == nullptr);
+    REQUIRE(std::vector<LinkImpl*>(route.begin(), route.end()) == links);
+  }
+
+  SECTION("Identical routes share their links")
+  {
+    RouteStore store(4);
+    std::vector<LinkImpl*> links   = {fake_link(1), fake_link(2)};
+    std::vector<LinkImpl*> reverse = {fake_link(2), fake_link(1)};
+    store.set_route(0, 1, nullptr, nullptr, links);
+    store.set_route(2, 3, nullptr, nullptr, links);
+    store.set_route(1, 0, nullptr, nullptr, reverse);
+    store.set_route(3, 2, nullptr, nullptr, reverse);
+    REQUIRE(store.get_route_count() == 2);
+    REQUIRE(store.get_link_count() == 4);
+    REQUIRE(store.get_route(0, 1).begin() == store.get_route(2, 3).begin());
+    REQUIRE(*store.get_route(3, 2).begin() == fake_link(2));
+  }
+
+  SECTION("Routes with different gateways are kept apart")
+  {
+    RouteStore store(4);
+    std::vector<LinkImpl*> links = {fake_link(7)};
+    store.set_route(0, 1, fake_netpoint(0), fake_netpoint(1), links);
+    store.set_route(0, 2, fake_netpoint(0), fake_netpoint(2), links);
+    store.set_route(0, 3, fake_netpoint(0), fake_netpoint(1), links);
+    REQUIRE(store.get_route_count() == 2);
+    REQUIRE(store.get_route(0, 2).gw_dst == fake_netpoint(2));
+    REQUIRE(store.get_route(0, 3).gw_dst == fake_netpoint(1));
+  }
+
+  SECTION("Routes can still be set after sealing")
+  {
+    RouteStore store(2);
+    std::vector<LinkImpl*> links = {fake_link(1)};
+    store.set_route(0, 1, nullptr, nullptr, links);
+    store.seal();
+    store.set_route(1, 0, nullptr, nullptr, links);
+    REQUIRE(*store.get_route(1, 0).begin() == fake_link(1));
+    REQUIRE(*store.get_route(0, 1).begin() == fake_link(1));
+  }
+}
+
+TEST_CASE("kernel::routing::PairTable: zero-initialized square tables", "[kernel-routing]")
+{
+  SECTION("Small tables")
+  {
+    PairTable table(10);
+    REQUIRE_FALSE(table.is_mapped());
+    REQUIRE(table.get(3, 4) == 0);
+    table.set(3, 4, 42);
+    REQUIRE(table.get(3, 4) == 42);
+    REQUIRE(table.get(4, 3) == 0);
+  }
+
+  SECTION("Large tables")
+  {
+    PairTable table(2000); // 16MB, but only a few pages get used
+    REQUIRE(table.get(1999, 1999) == 0);
+    table.set(1999, 0, 7);
+    table.set(0, 1999, 8);
+    REQUIRE(table.get(1999, 0) == 7);
+    REQUIRE(table.get(0, 1999) == 8);
+    REQUIRE(table.get(1000, 1000) == 0);
+  }
+}
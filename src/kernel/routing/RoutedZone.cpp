@@ -9,11 +9,15 @@
 #include "xbt/sysdep.h"
 #include "simgrid/kernel/routing/NetPoint.hpp"
 #include "simgrid/kernel/routing/RoutedZone.hpp"
+#include "src/kernel/routing/RouteMemo.hpp"
 #include "src/surf/network_interface.hpp"
+#include "src/surf/surf_interface.hpp"
 #include "src/surf/xml/platf_private.hpp"
 
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(surf_routing_generic, surf_route, "Generic implementation of the surf routing");
 
+int sg_routing_threads = 1; /* Change this with --cfg=routing/threads:VALUE */
+
 /* ***************************************************************** */
 /* *********************** GENERIC METHODS ************************* */
 
@@ -203,6 +207,7 @@ void RoutedZone::add_route_check_params(NetPoint* src, NetPoint* dst, NetPoint*
                dstName, gw_dst->get_cname());
   }
 
+  RouteMemo::invalidate_all();
   simgrid::s4u::NetZone::on_route_creation(symmetrical, src, dst, gw_src, gw_dst, link_list);
 }
 }
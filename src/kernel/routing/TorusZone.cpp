@@ -58,7 +58,7 @@ void TorusZone::create_links_for_node(ClusterCreationArgs* cluster, int id, int
      * Note that position rankId*(xbt_dynar_length(dimensions)+has_loopback?+has_limiter?)
      * holds the link "rankId->rankId"
      */
-    private_links_.insert({position + j, {linkUp, linkDown}});
+    add_private_link_at(position + j, {linkUp, linkDown});
     dim_product *= current_dimension;
   }
   rank++;
@@ -90,95 +90,72 @@ void TorusZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArgs*
     return;
 
   if (src->id() == dst->id() && has_loopback_) {
-    std::pair<resource::LinkImpl*, resource::LinkImpl*> info = private_links_.at(src->id() * num_links_per_node_);
+    resource::LinkImpl* loopback = get_private_link_at(node_pos(src->id())).first;
 
-    route->link_list.push_back(info.first);
+    route->link_list.push_back(loopback);
     if (lat)
-      *lat += info.first->get_latency();
+      *lat += loopback->get_latency();
     return;
   }
 
   /*
    * Dimension based routing routes through each dimension consecutively
    * TODO Change to dynamic assignment
+   *
+   * The coordinate of a node in the j-th dimension is (id / dim_product) % dimensions_[j], where dim_product is the
+   * product of the previous dimensions. So the coordinates are computed on need, without any array.
    */
-
-  /*
-   * Arrays that hold the coordinates of the current node andthe target; comparing the values at the i-th position of
-   * both arrays, we can easily assess whether we need to route into this dimension or not.
-   */
-  const unsigned int dsize = dimensions_.size();
-  unsigned int myCoords[dsize];
-  unsigned int targetCoords[dsize];
-  unsigned int dim_size_product = 1;
-  for (unsigned i = 0; i < dsize; i++) {
-    unsigned cur_dim_size = dimensions_[i];
-    myCoords[i]           = (src->id() / dim_size_product) % cur_dim_size;
-    targetCoords[i]       = (dst->id() / dim_size_product) % cur_dim_size;
-    dim_size_product *= cur_dim_size;
-  }
-
-  /*
-   * linkOffset describes the offset where the link we want to use is stored(+1 is added because each node has a link
-   * from itself to itself, which can only be the case if src->m_id == dst->m_id -- see above for this special case)
-   */
-  int nodeOffset = (dsize + 1) * src->id();
-
-  int linkOffset  = nodeOffset;
-  bool use_lnk_up = false; // Is this link of the form "cur -> next" or "next -> cur"? false means: next -> cur
   unsigned int current_node = src->id();
   while (current_node != dst->id()) {
     unsigned int next_node   = 0;
-    unsigned int dim_product = 1; // First, we will route in x-dimension
-    for (unsigned j = 0; j < dsize; j++) {
-      const unsigned cur_dim = dimensions_[j];
-      // current_node/dim_product = position in current dimension
-      if ((current_node / dim_product) % cur_dim != (dst->id() / dim_product) % cur_dim) {
-
-        if ((targetCoords[j] > myCoords[j] &&
-             targetCoords[j] <= myCoords[j] + cur_dim / 2) // Is the target node on the right, without the wrap-around?
-            || (myCoords[j] > cur_dim / 2 &&
-                (myCoords[j] + cur_dim / 2) % cur_dim >=
-                    targetCoords[j])) { // Or do we need to use the wrap around to reach it?
-          if ((current_node / dim_product) % cur_dim == cur_dim - 1)
+    unsigned int link_owner  = 0;     // The node that holds the link to use, in the last columns of its private links
+    unsigned int link_dim    = 0;     // The dimension of the link to use
+    bool use_lnk_up          = false; // Is this link of the form "cur -> next" or "next -> cur"? false: next -> cur
+    unsigned int dim_product = 1;     // First, we will route in x-dimension
+    for (unsigned j = 0; j < dimensions_.size(); j++) {
+      const unsigned cur_dim       = dimensions_[j];
+      const unsigned current_coord = (current_node / dim_product) % cur_dim;
+      const unsigned target_coord  = (dst->id() / dim_product) % cur_dim;
+      if (current_coord != target_coord) {
+        const unsigned my_coord = (src->id() / dim_product) % cur_dim; // The direction depends on the source
+
+        if ((target_coord > my_coord &&
+             target_coord <= my_coord + cur_dim / 2) // Is the target node on the right, without the wrap-around?
+            || (my_coord > cur_dim / 2 &&
+                (my_coord + cur_dim / 2) % cur_dim >=
+                    target_coord)) { // Or do we need to use the wrap around to reach it?
+          if (current_coord == cur_dim - 1)
             next_node = (current_node + dim_product - dim_product * cur_dim);
           else
             next_node = (current_node + dim_product);
 
           // HERE: We use *CURRENT* node for calculation (as opposed to next_node)
-          nodeOffset = current_node * (num_links_per_node_);
-          linkOffset = nodeOffset + (has_loopback_ ? 1 : 0) + (has_limiter_ ? 1 : 0) + j;
+          link_owner = current_node;
           use_lnk_up = true;
-          assert(linkOffset >= 0);
         } else { // Route to the left
-          if ((current_node / dim_product) % cur_dim == 0)
+          if (current_coord == 0)
             next_node = (current_node - dim_product + dim_product * cur_dim);
           else
             next_node = (current_node - dim_product);
 
           // HERE: We use *next* node for calculation (as opposed to current_node!)
-          nodeOffset = next_node * (num_links_per_node_);
-          linkOffset = nodeOffset + j + (has_loopback_ ? 1 : 0) + (has_limiter_ ? 1 : 0);
+          link_owner = next_node;
           use_lnk_up = false;
-
-          assert(linkOffset >= 0);
         }
-        XBT_DEBUG("torus_get_route_and_latency - current_node: %u, next_node: %u, linkOffset is %i", current_node,
-                  next_node, linkOffset);
+        link_dim = j;
+        XBT_DEBUG("torus_get_route_and_latency - current_node: %u, next_node: %u, link_owner is %u", current_node,
+                  next_node, link_owner);
         break;
       }
 
       dim_product *= cur_dim;
     }
 
-    std::pair<resource::LinkImpl*, resource::LinkImpl*> info;
-
-    if (has_limiter_) { // limiter for sender
-      info = private_links_.at(nodeOffset + (has_loopback_ ? 1 : 0));
-      route->link_list.push_back(info.first);
-    }
+    if (has_limiter_) // limiter for sender
+      route->link_list.push_back(get_private_link_at(node_pos_with_loopback(link_owner)).first);
 
-    info = private_links_.at(linkOffset);
+    const std::pair<resource::LinkImpl*, resource::LinkImpl*>& info =
+        get_private_link_at(node_pos_with_loopback_limiter(link_owner) + link_dim);
     resource::LinkImpl* lnk = use_lnk_up ? info.first : info.second;
 
     route->link_list.push_back(lnk);
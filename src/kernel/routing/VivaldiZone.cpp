@@ -77,7 +77,7 @@ void VivaldiZone::set_peer_link(NetPoint* netpoint, double bw_in, double bw_out,
       network_model_->create_link(link_up, std::vector<double>(1, bw_out), 0, s4u::Link::SharingPolicy::SHARED);
   resource::LinkImpl* linkDown =
       network_model_->create_link(link_down, std::vector<double>(1, bw_in), 0, s4u::Link::SharingPolicy::SHARED);
-  private_links_.insert({netpoint->id(), {linkUp, linkDown}});
+  add_private_link_at(netpoint->id(), {linkUp, linkDown});
 }
 
 void VivaldiZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArgs* route, double* lat)
@@ -92,9 +92,8 @@ void VivaldiZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArg
   }
 
   /* Retrieve the private links */
-  auto src_link = private_links_.find(src->id());
-  if (src_link != private_links_.end()) {
-    std::pair<resource::LinkImpl*, resource::LinkImpl*> info = src_link->second;
+  if (private_link_exists_at(src->id())) {
+    std::pair<resource::LinkImpl*, resource::LinkImpl*> info = get_private_link_at(src->id());
     if (info.first) {
       route->link_list.push_back(info.first);
       if (lat)
@@ -104,9 +103,8 @@ void VivaldiZone::get_local_route(NetPoint* src, NetPoint* dst, RouteCreationArg
     XBT_DEBUG("Source of private link (%u) doesn't exist", src->id());
   }
 
-  auto dst_link = private_links_.find(dst->id());
-  if (dst_link != private_links_.end()) {
-    std::pair<resource::LinkImpl*, resource::LinkImpl*> info = dst_link->second;
+  if (private_link_exists_at(dst->id())) {
+    std::pair<resource::LinkImpl*, resource::LinkImpl*> info = get_private_link_at(dst->id());
     if (info.second) {
       route->link_list.push_back(info.second);
       if (lat)
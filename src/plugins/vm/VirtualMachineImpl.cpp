@@ -128,7 +128,7 @@ double VMModel::next_occuring_event(double now)
   }
 
   /* 2. Ready. Get the next occurring event */
-  return surf_cpu_model_vm->next_occuring_event(now);
+  return surf_cpu_model_vm->poll_next_occuring_event(now);
 }
 
 /************
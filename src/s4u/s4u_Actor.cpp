@@ -375,6 +375,33 @@ void parallel_execute(const std::vector<s4u::Host*>& hosts, const std::vector<do
   exec_init(hosts, flops_amounts, bytes_amounts)->set_timeout(timeout)->wait();
 }
 
+void parallel_execute(const std::vector<s4u::Host*>& hosts, const std::vector<double>& flops_amounts,
+                      const std::vector<ParallelTransfer>& transfers, double timeout)
+{
+  xbt_assert(hosts.size() > 0, "Your parallel executions must span over at least one host.");
+  xbt_assert(hosts.size() == flops_amounts.size() || flops_amounts.empty(),
+             "Host count (%zu) does not match flops_amount count (%zu).", hosts.size(), flops_amounts.size());
+  xbt_assert(std::all_of(transfers.begin(), transfers.end(),
+                         [&hosts](ParallelTransfer const& t) { return t.src < hosts.size() && t.dst < hosts.size(); }),
+             "The transfers must be between the %zu hosts of the parallel execution.", hosts.size());
+  /* Check that we are not mixing VMs and PMs in the parallel task */
+  bool is_a_vm = (nullptr != dynamic_cast<VirtualMachine*>(hosts.front()));
+  xbt_assert(std::all_of(hosts.begin(), hosts.end(),
+                         [is_a_vm](s4u::Host* elm) {
+                           bool tmp_is_a_vm = (nullptr != dynamic_cast<VirtualMachine*>(elm));
+                           return is_a_vm == tmp_is_a_vm;
+                         }),
+             "parallel_execute: mixing VMs and PMs is not supported (yet).");
+  /* checking for infinite values */
+  xbt_assert(std::all_of(flops_amounts.begin(), flops_amounts.end(), [](double elm) { return std::isfinite(elm); }),
+             "flops_amounts comprises infinite values!");
+  xbt_assert(std::all_of(transfers.begin(), transfers.end(),
+                         [](ParallelTransfer const& t) { return std::isfinite(t.bytes); }),
+             "transfers comprises infinite values!");
+
+  exec_init(hosts, flops_amounts, transfers)->set_timeout(timeout)->wait();
+}
+
 // deprecated
 void parallel_execute(int host_nb, s4u::Host* const* host_list, const double* flops_amount, const double* bytes_amount,
                       double timeout)
@@ -407,6 +434,12 @@ ExecPtr exec_init(const std::vector<s4u::Host*>& hosts, const std::vector<double
   return ExecPtr(new ExecPar(hosts, flops_amounts, bytes_amounts));
 }
 
+ExecPtr exec_init(const std::vector<s4u::Host*>& hosts, const std::vector<double>& flops_amounts,
+                  const std::vector<ParallelTransfer>& transfers)
+{
+  return ExecPtr(new ExecPar(hosts, flops_amounts, transfers));
+}
+
 ExecPtr exec_async(double flops)
 {
   ExecPtr res = exec_init(flops);
@@ -6,6 +6,7 @@
  * under the terms of the license (GNU LGPL) which comes with this package. */
 
 #include "mc/mc.h"
+#include "simgrid/kernel/resource/Model.hpp"
 #include "simgrid/kernel/routing/NetPoint.hpp"
 #include "simgrid/kernel/routing/NetZoneImpl.hpp"
 #include "simgrid/s4u/Engine.hpp"
@@ -19,9 +20,20 @@
 #include "src/simix/smx_private.hpp" // For access to simix_global->process_list
 #include "src/surf/network_interface.hpp"
 #include "surf/surf.hpp" // routing_platf. FIXME:KILLME. SOON
+#include "xbt/config.hpp"
 #include <simgrid/Exception.hpp>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 XBT_LOG_NEW_CATEGORY(s4u, "Log channels of the S4U (Simgrid for you) interface");
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(s4u_engine, s4u, "Logging specific to S4U (engine)");
@@ -116,11 +128,16 @@ void Engine::load_deployment(const std::string& deploy)
 /** @brief Returns the amount of hosts in the platform */
 size_t Engine::get_host_count()
 {
-  return pimpl->hosts_.size();
+  return pimpl->hosts_.size() + pimpl->get_lazy_node_count();
 }
 
+/** @brief Returns the list of all hosts found in the platform
+ *
+ *  The nodes of the lazy clusters are all created (see routing/lazy-clusters).
+ */
 std::vector<Host*> Engine::get_all_hosts()
 {
+  create_all_lazy_nodes();
   std::vector<Host*> res;
   for (auto const& kv : pimpl->hosts_)
     res.push_back(kv.second);
@@ -129,6 +146,7 @@ std::vector<Host*> Engine::get_all_hosts()
 
 std::vector<Host*> Engine::get_filtered_hosts(const std::function<bool(Host*)>& filter)
 {
+  create_all_lazy_nodes();
   std::vector<Host*> hosts;
   for (auto const& kv : pimpl->hosts_) {
     if (filter(kv.second))
@@ -154,15 +172,25 @@ void Engine::host_unregister(const std::string& name)
  */
 Host* Engine::host_by_name(const std::string& name)
 {
-  if (pimpl->hosts_.find(name) == pimpl->hosts_.end())
+  Host* host = host_by_name_or_null(name);
+  if (host == nullptr)
     throw std::invalid_argument(std::string("Host not found: '") + name + std::string("'"));
-  return pimpl->hosts_.at(name);
+  return host;
 }
 
-/** @brief Find a host from its name (or nullptr if that host does not exist) */
+/** @brief Find a host from its name (or nullptr if that host does not exist)
+ *
+ *  The node of a lazy cluster is created on its first retrieval (see routing/lazy-clusters).
+ */
 Host* Engine::host_by_name_or_null(const std::string& name)
 {
   auto host = pimpl->hosts_.find(name);
+  if (host != pimpl->hosts_.end())
+    return host->second;
+  if (pimpl->lazy_clusters_.empty() ||
+      not kernel::actor::simcall([this, &name] { return pimpl->create_lazy_host(name); }))
+    return nullptr;
+  host = pimpl->hosts_.find(name);
   return host == pimpl->hosts_.end() ? nullptr : host->second;
 }
 
@@ -172,16 +200,26 @@ Host* Engine::host_by_name_or_null(const std::string& name)
  */
 Link* Engine::link_by_name(const std::string& name)
 {
-  if (pimpl->links_.find(name) == pimpl->links_.end())
+  Link* link = link_by_name_or_null(name);
+  if (link == nullptr)
     throw std::invalid_argument(std::string("Link not found: ") + name);
 
-  return pimpl->links_.at(name);
+  return link;
 }
 
-/** @brief Find an link from its name (or nullptr if that link does not exist) */
+/** @brief Find an link from its name (or nullptr if that link does not exist)
+ *
+ *  The private links of the nodes of a lazy cluster are created with their node (see routing/lazy-clusters).
+ */
 Link* Engine::link_by_name_or_null(const std::string& name)
 {
   auto link = pimpl->links_.find(name);
+  if (link != pimpl->links_.end())
+    return link->second;
+  if (pimpl->lazy_clusters_.empty() ||
+      not kernel::actor::simcall([this, &name] { return pimpl->create_lazy_link(name); }))
+    return nullptr;
+  link = pimpl->links_.find(name);
   return link == pimpl->links_.end() ? nullptr : link->second;
 }
 
@@ -239,15 +277,17 @@ void Engine::storage_unregister(const std::string& name)
   pimpl->storages_.erase(name);
 }
 
-/** @brief Returns the amount of links in the platform */
+/** @brief Returns the amount of links in the platform, once all nodes of the lazy clusters are created */
 size_t Engine::get_link_count()
 {
+  create_all_lazy_nodes();
   return pimpl->links_.size();
 }
 
-/** @brief Returns the list of all links found in the platform */
+/** @brief Returns the list of all links found in the platform, once all nodes of the lazy clusters are created */
 std::vector<Link*> Engine::get_all_links()
 {
+  create_all_lazy_nodes();
   std::vector<Link*> res;
   for (auto const& kv : pimpl->links_)
     res.push_back(kv.second);
@@ -256,6 +296,7 @@ std::vector<Link*> Engine::get_all_links()
 
 std::vector<Link*> Engine::get_filtered_links(const std::function<bool(Link*)>& filter)
 {
+  create_all_lazy_nodes();
   std::vector<Link*> filtered_list;
   for (auto const& kv : pimpl->links_)
     if (filter(kv.second))
@@ -263,6 +304,13 @@ std::vector<Link*> Engine::get_filtered_links(const std::function<bool(Link*)>&
   return filtered_list;
 }
 
+/* The nodes of the lazy clusters are created by the maestro, even when an actor asks for them */
+void Engine::create_all_lazy_nodes()
+{
+  if (not pimpl->lazy_clusters_.empty())
+    kernel::actor::simcall([this] { pimpl->create_all_lazy_nodes(); });
+}
+
 size_t Engine::get_actor_count()
 {
   return simix_global->process_list.size();
@@ -301,6 +349,129 @@ void Engine::run()
   }
 }
 
+#ifndef _WIN32
+/* Runs a variant of a sweep in the forked process, and never returns */
+static void run_sweep_variant(Engine* e, unsigned int variant, const std::vector<std::string>& configs, int fd,
+                              const std::function<void(unsigned int)>& deploy,
+                              const std::function<std::string(unsigned int)>& report)
+{
+  int status = 0;
+  try {
+    for (auto const& config : configs)
+      config::set_parse(config);
+    deploy(variant);
+    e->run();
+    std::string result = report(variant);
+    for (std::size_t done = 0; done < result.size();) {
+      ssize_t written = write(fd, result.data() + done, result.size() - done);
+      if (written < 0 && errno != EINTR)
+        throw std::runtime_error(std::string("Cannot send the report: ") + strerror(errno));
+      done += std::max<ssize_t>(written, 0);
+    }
+  } catch (const std::exception& ex) {
+    XBT_ERROR("Variant %u failed: %s", variant, ex.what());
+    status = 1;
+  }
+  fflush(stdout);
+  fflush(stderr);
+  _exit(status); // The other destructors and atexit handlers belong to the parent process
+}
+#endif
+
+std::vector<std::string> Engine::run_sweep(const std::vector<std::vector<std::string>>& variants,
+                                           const std::function<void(unsigned int)>& deploy,
+                                           const std::function<std::string(unsigned int)>& report, int max_workers)
+{
+#ifdef _WIN32
+  xbt_die("Sweeps need fork(), that is not available on Windows");
+#else
+  if (get_actor_count() != 0)
+    xbt_die("The actors of a sweep must be created by its deploy function");
+  /* fork() only duplicates the calling thread, so the worker pools started by a simulation would be unusable */
+  if (simix_global->has_run || get_clock() != 0)
+    xbt_die("A sweep cannot start after a simulation ran");
+  if (MC_is_active())
+    xbt_die("Sweeps cannot be model-checked");
+  if (max_workers <= 0)
+    max_workers = std::max(1U, std::thread::hardware_concurrency());
+
+  struct Worker {
+    pid_t pid;
+    int fd; // reading end of the pipe
+    unsigned int variant;
+  };
+  std::vector<Worker> workers;
+  std::vector<std::string> reports(variants.size());
+  unsigned int next = 0;
+
+  /* Clean IO before forking, so that the children do not write the pending output again */
+  fflush(stdout);
+  fflush(stderr);
+
+  while (next < variants.size() || not workers.empty()) {
+    while (next < variants.size() && workers.size() < static_cast<unsigned>(max_workers)) {
+      int fds[2];
+      if (pipe(fds) != 0)
+        xbt_die("Cannot create a pipe: %s", strerror(errno));
+      pid_t pid = fork();
+      if (pid < 0)
+        xbt_die("Cannot fork a worker: %s", strerror(errno));
+      if (pid == 0) {
+        close(fds[0]);
+        for (Worker const& w : workers)
+          close(w.fd);
+        run_sweep_variant(this, next, variants[next], fds[1], deploy, report);
+      }
+      close(fds[1]);
+      XBT_DEBUG("Variant %u runs in process %d", next, static_cast<int>(pid));
+      workers.push_back({pid, fds[0], next});
+      next++;
+    }
+
+    /* Read the reports as they come, so that the workers never block on a full pipe */
+    std::vector<pollfd> polled;
+    for (Worker const& w : workers)
+      polled.push_back({w.fd, POLLIN, 0});
+    if (poll(polled.data(), polled.size(), -1) < 0) {
+      if (errno != EINTR)
+        xbt_die("Cannot wait for the workers: %s", strerror(errno));
+      continue;
+    }
+    for (unsigned int i = 0; i < polled.size(); i++) {
+      if (polled[i].revents == 0)
+        continue;
+      Worker& w = workers[i];
+      char buffer[4096];
+      ssize_t received = read(w.fd, buffer, sizeof buffer);
+      if (received > 0) {
+        reports[w.variant].append(buffer, received);
+      } else if (received == 0 || errno != EINTR) { // End of the report
+        close(w.fd);
+        int status  = 0;
+        pid_t ended = waitpid(w.pid, &status, 0);
+        while (ended < 0 && errno == EINTR)
+          ended = waitpid(w.pid, &status, 0);
+        if (ended < 0 || WIFSIGNALED(status) || WEXITSTATUS(status) != 0) {
+          if (ended < 0)
+            XBT_WARN("Cannot get the exit status of variant %u: %s", w.variant, strerror(errno));
+          else if (WIFSIGNALED(status))
+            XBT_WARN("The process of variant %u was killed by signal %d", w.variant, WTERMSIG(status));
+          else
+            XBT_WARN("The process of variant %u exited with status %d", w.variant, WEXITSTATUS(status));
+          reports[w.variant].clear(); // It may be truncated
+        } else {
+          XBT_DEBUG("Variant %u done", w.variant);
+        }
+        w.fd = -1;
+      }
+    }
+    workers.erase(std::remove_if(workers.begin(), workers.end(), [](Worker const& w) { return w.fd < 0; }),
+                  workers.end());
+  }
+  return reports;
+#endif
+}
+
 /** @brief Retrieve the root netzone, containing all others */
 s4u::NetZone* Engine::get_netzone_root()
 {
@@ -337,11 +508,18 @@ NetZone* Engine::netzone_by_name_or_null(const std::string& name)
 kernel::routing::NetPoint* Engine::netpoint_by_name_or_null(const std::string& name)
 {
   auto netp = pimpl->netpoints_.find(name);
+  if (netp != pimpl->netpoints_.end())
+    return netp->second;
+  if (pimpl->lazy_clusters_.empty() ||
+      not kernel::actor::simcall([this, &name] { return pimpl->create_lazy_host(name); }))
+    return nullptr;
+  netp = pimpl->netpoints_.find(name);
   return netp == pimpl->netpoints_.end() ? nullptr : netp->second;
 }
 
 std::vector<kernel::routing::NetPoint*> Engine::get_all_netpoints()
 {
+  create_all_lazy_nodes();
   std::vector<kernel::routing::NetPoint*> res;
   for (auto const& kv : pimpl->netpoints_)
     res.push_back(kv.second);
@@ -365,6 +543,14 @@ void Engine::netpoint_unregister(kernel::routing::NetPoint* point)
   });
 }
 
+std::vector<kernel::resource::ModelStatistics> Engine::get_model_statistics()
+{
+  std::vector<kernel::resource::ModelStatistics> res;
+  for (auto const& model : all_existing_models)
+    res.push_back(model->get_statistics());
+  return res;
+}
+
 bool Engine::is_initialized()
 {
   return Engine::instance_ != nullptr;
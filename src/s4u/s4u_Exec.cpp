@@ -195,6 +195,12 @@ ExecPar::ExecPar(const std::vector<s4u::Host*>& hosts, const std::vector<double>
 {
 }
 
+ExecPar::ExecPar(const std::vector<s4u::Host*>& hosts, const std::vector<double>& flops_amounts,
+                 const std::vector<ParallelTransfer>& transfers)
+    : Exec(), hosts_(hosts), flops_amounts_(flops_amounts), transfers_(transfers)
+{
+}
+
 Exec* ExecPar::start()
 {
   kernel::actor::simcall([this] {
@@ -203,6 +209,7 @@ Exec* ExecPar::start()
         .set_timeout(timeout_)
         .set_flops_amounts(flops_amounts_)
         .set_bytes_amounts(bytes_amounts_)
+        .set_transfers(transfers_)
         .start();
   });
   state_ = State::STARTED;
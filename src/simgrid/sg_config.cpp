@@ -15,6 +15,7 @@
 #include "src/surf/surf_interface.hpp"
 #include "surf/surf.hpp"
 #include "xbt/config.hpp"
+#include "xbt/mallocator.h"
 
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(surf_config, surf, "About the configuration of SimGrid");
 
@@ -265,6 +266,30 @@ void sg_config_init(int *argc, char **argv)
                              "Maximum number of concurrent variables in the maxmim system. Also limits the number of "
                              "processes on each host, at higher level. (default: -1 means no such limitation)");
 
+  simgrid::config::bind_flag(sg_maxmin_components, "maxmin/components",
+                             "Split the maxmin systems into their connected components, and solve them separately");
+
+  simgrid::config::bind_flag(sg_maxmin_threads, "maxmin/threads",
+                             "Number of threads used to solve the connected components of the maxmin systems in parallel "
+                             "(only used with maxmin/components)");
+
+  simgrid::config::bind_flag(sg_surf_model_threads, "surf/model-threads",
+                             "Number of threads used to update the independent models (CPU, network, storage) in "
+                             "parallel");
+
+  simgrid::config::bind_flag(sg_routing_threads, "routing/threads",
+                             "Number of threads used to compute the shortest paths of the Floyd zones, and of the "
+                             "Dijkstra zones with routing/dijkstra-precompute");
+
+  simgrid::config::bind_flag(sg_dijkstra_precompute, "routing/dijkstra-precompute",
+                             "Compute the shortest paths between all points of the Dijkstra zones when they are sealed");
+
+  simgrid::config::bind_flag(sg_dijkstra_cache_size, "routing/dijkstra-cache-size",
+                             "Size (in MiB) of the cache of shortest paths of each DijkstraCache zone (0: no limit)");
+
+  simgrid::config::bind_flag(sg_lazy_clusters, "routing/lazy-clusters",
+                             "Create the nodes of the flat clusters on first use instead of at parsing time");
+
   /* The parameters of network models */
 
   sg_latency_factor = 13.01; // comes from the default LV08 network model
@@ -298,6 +323,22 @@ void sg_config_init(int *argc, char **argv)
                                                                          "default unless optim is set to lazy)",
                                       "no");
   simgrid::config::alias("network/maxmin-selective-update", {"network/maxmin_selective_update"});
+  simgrid::config::declare_flag<bool>("network/maxmin-incremental",
+                                      "Solve the network sharing incrementally from its previous solution (only with "
+                                      "selective update)",
+                                      "no");
+  simgrid::config::bind_flag(sg_route_cache_size, "network/route-cache",
+                             "Amount of routes between two points of the platform that are kept in cache, for the "
+                             "communications and the other route lookups (0 to disable the cache)",
+                             [](int value) {
+                               if (value < 0)
+                                 xbt_die("Invalid value (%d) for 'network/route-cache': it cannot be negative.", value);
+                             });
+  simgrid::config::declare_flag<int>("network/analytic-thresh",
+                                     "Size (in bytes) under which the communications are not shared with the other "
+                                     "ones, but last their latency plus their size over the bottleneck bandwidth "
+                                     "(0 to disable)",
+                                     0);
 
   simgrid::config::declare_flag<int>("contexts/stack-size", "Stack size of contexts in KiB (not with threads)",
                                      8 * 1024, [](int value) { smx_context_stack_size = value * 1024; });
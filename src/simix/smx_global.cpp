@@ -382,6 +382,7 @@ void SIMIX_run()
   }
 
   double time = 0;
+  simix_global->has_run = true;
 
   do {
     XBT_DEBUG("New Schedule Round; size(queue)=%zu", simix_global->actors_to_run.size());
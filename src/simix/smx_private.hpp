@@ -54,6 +54,7 @@ public:
   xbt_dynar_t dead_actors_vector = xbt_dynar_new(sizeof(smx_actor_t), nullptr);
 #endif
   smx_actor_t maestro_process   = nullptr;
+  bool has_run                  = false; // Set by SIMIX_run(), that may start pools of worker threads
 
   // Maps function names to actor code:
   std::unordered_map<std::string, simgrid::simix::ActorCodeFactory> registered_functions;
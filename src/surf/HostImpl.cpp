@@ -69,6 +69,16 @@ kernel::resource::Action* HostModel::execute_parallel(const std::vector<s4u::Hos
   return action;
 }
 
+kernel::resource::Action* HostModel::execute_parallel(const std::vector<s4u::Host*>& host_list,
+                                                      const double* flops_amount,
+                                                      const std::vector<s4u::ParallelTransfer>& transfers, double rate)
+{
+  std::vector<double> bytes_amount(host_list.size() * host_list.size(), 0.0);
+  for (s4u::ParallelTransfer const& transfer : transfers)
+    bytes_amount[transfer.src * host_list.size() + transfer.dst] += transfer.bytes;
+  return execute_parallel(host_list, flops_amount, bytes_amount.data(), rate);
+}
+
 /************
  * Resource *
  ************/
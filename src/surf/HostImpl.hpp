@@ -32,6 +32,10 @@ public:
   virtual kernel::resource::Action* execute_parallel(const std::vector<s4u::Host*>& host_list,
                                                      const double* flops_amount, const double* bytes_amount,
                                                      double rate);
+  /** @brief Same, with a sparse communication matrix. By default, it is expanded into a dense one */
+  virtual kernel::resource::Action* execute_parallel(const std::vector<s4u::Host*>& host_list,
+                                                     const double* flops_amount,
+                                                     const std::vector<s4u::ParallelTransfer>& transfers, double rate);
 };
 
 /************
@@ -164,13 +164,14 @@ void CpuCas01::apply_event(profile::Event* event, double value)
 /** @brief Start a new execution on this CPU lasting @param size flops and using one core */
 CpuAction* CpuCas01::execution_start(double size)
 {
-  return new CpuCas01Action(get_model(), size, not is_on(), speed_.scale * speed_.peak, get_constraint());
+  return new (get_model())
+      CpuCas01Action(get_model(), size, not is_on(), speed_.scale * speed_.peak, get_constraint());
 }
 
 CpuAction* CpuCas01::execution_start(double size, int requested_cores)
 {
-  return new CpuCas01Action(get_model(), size, not is_on(), speed_.scale * speed_.peak, get_constraint(),
-                            requested_cores);
+  return new (get_model()) CpuCas01Action(get_model(), size, not is_on(), speed_.scale * speed_.peak,
+                                          get_constraint(), requested_cores);
 }
 
 CpuAction* CpuCas01::sleep(double duration)
@@ -180,7 +181,7 @@ CpuAction* CpuCas01::sleep(double duration)
 
   XBT_IN("(%s,%g)", get_cname(), duration);
   CpuCas01Action* action =
-      new CpuCas01Action(get_model(), 1.0, not is_on(), speed_.scale * speed_.peak, get_constraint());
+      new (get_model()) CpuCas01Action(get_model(), 1.0, not is_on(), speed_.scale * speed_.peak, get_constraint());
 
   // FIXME: sleep variables should not consume 1.0 in System::expand()
   action->set_max_duration(duration);
@@ -30,6 +30,8 @@ public:
   ~CpuCas01Model() override;
 
   Cpu* create_cpu(s4u::Host* host, const std::vector<double>& speed_per_pstate, int core) override;
+  bool next_occuring_event_is_cacheable() override { return true; }
+  bool is_independent() override { return true; }
 };
 
 /************
@@ -10,6 +10,9 @@
 #include "surf/surf.hpp"
 
 #include <algorithm>
+#include <boost/functional/hash.hpp>
+#include <limits>
+#include <unordered_set>
 
 constexpr double EPSILON = 0.000000001;
 
@@ -23,21 +26,125 @@ namespace resource {
  * Trace *
  *********/
 
+/** @brief Checks an integration interval, and tells whether it is empty */
+static bool is_empty_interval(double a, double b)
+{
+  if ((a < 0.0) || (a > b)) {
+    xbt_die("Error, invalid integration interval [%.2f,%.2f]. "
+            "You probably have a task executing with negative computation amount. Check your code.",
+            a, b);
+  }
+  return fabs(a - b) < EPSILON;
+}
+
+/** @brief Checks the parameters of solve() after fixing very small negative numbers, and tells whether amount is null */
+static bool is_null_amount(double& a, double& amount)
+{
+  if ((a < 0.0) && (a > -EPSILON)) {
+    a = 0.0;
+  }
+  if ((amount < 0.0) && (amount > -EPSILON)) {
+    amount = 0.0;
+  }
+
+  /* Sanity checks */
+  if ((a < 0.0) || (amount < 0.0)) {
+    XBT_CRITICAL("Error, invalid parameters [a = %.2f, amount = %.2f]. "
+                 "You probably have a task executing with negative computation amount. Check your code.",
+                 a, amount);
+    xbt_abort();
+  }
+  return amount < EPSILON;
+}
+
+CpuTiProfile::SearchTree::SearchTree(const std::vector<double>& sorted)
+{
+  std::size_t size = 1;
+  while (size - 1 < sorted.size()) {
+    size *= 2;
+    depth_++;
+  }
+  nodes_.resize(size, std::numeric_limits<double>::infinity());
+  ranks_.resize(size);
+  ranks_[0] = sorted.size();
+  fill(sorted, 0, 1);
+}
+
+/** @brief Stores the sorted values from that rank in the subtree of that node (in order), and returns the next rank */
+std::size_t CpuTiProfile::SearchTree::fill(const std::vector<double>& sorted, std::size_t rank, std::size_t node)
+{
+  if (node >= nodes_.size())
+    return rank;
+  rank = fill(sorted, rank, 2 * node);
+  if (rank < sorted.size())
+    nodes_[node] = sorted[rank];
+  ranks_[node] = rank;
+  return fill(sorted, rank + 1, 2 * node + 1);
+}
+
+/** @brief Converts the leaf reached by a search into the index of the last element lower or equal to the key */
+int CpuTiProfile::SearchTree::index_of(std::size_t node) const
+{
+  /* The upper bound is the last node where the search went left: drop the moves to the right after it, and itself */
+  while (node & 1)
+    node >>= 1;
+  node >>= 1;
+  int upper_bound = ranks_[node];
+  return upper_bound == 0 ? 0 : upper_bound - 1;
+}
+
+int CpuTiProfile::SearchTree::search(double key) const
+{
+  std::size_t node = 1;
+  for (unsigned level = 0; level < depth_; level++)
+    node = 2 * node + (nodes_[node] <= key);
+  return index_of(node);
+}
+
+void CpuTiProfile::SearchTree::search(std::size_t n, const double* keys, int* result) const
+{
+  std::vector<std::size_t> nodes(n, 1);
+  for (unsigned level = 0; level < depth_; level++)
+    for (std::size_t i = 0; i < n; i++)
+      nodes[i] = 2 * nodes[i] + (nodes_[nodes[i]] <= keys[i]);
+  for (std::size_t i = 0; i < n; i++)
+    result[i] = index_of(nodes[i]);
+}
+
 CpuTiProfile::CpuTiProfile(profile::Profile* profile)
 {
   double integral = 0;
   double time = 0;
-  unsigned nb_points = profile->event_list.size() + 1;
+  unsigned nb_points = profile->size() + 1;
   time_points_.reserve(nb_points);
   integral_.reserve(nb_points);
-  for (auto const& val : profile->event_list) {
+  values_.reserve(profile->size());
+  for (std::size_t i = 0; i < profile->size(); i++) {
+    kernel::profile::DatedValue val = profile->at(i);
     time_points_.push_back(time);
     integral_.push_back(integral);
+    values_.push_back(val.value_);
     time += val.date_;
     integral += val.date_ * val.value_;
   }
   time_points_.push_back(time);
   integral_.push_back(integral);
+
+  time_tree_      = SearchTree(time_points_);
+  integral_tree_  = SearchTree(integral_);
+  last_time_      = time;
+  integral_start_ = integral_at(0.0, time_tree_.search(0.0));
+  integral_end_   = integral_at(last_time_, time_tree_.search(last_time_));
+  total_          = integral_end_ - integral_start_;
+  hash_           = boost::hash_range(time_points_.begin(), time_points_.end());
+  boost::hash_combine(hash_, boost::hash_range(values_.begin(), values_.end()));
+
+  XBT_DEBUG("Total integral %f, last_time %f ", total_, last_time_);
+}
+
+bool CpuTiProfile::has_same_values(const CpuTiProfile& other) const
+{
+  return time_points_ == other.time_points_ && values_ == other.values_;
 }
 
 /**
@@ -52,62 +159,91 @@ CpuTiProfile::CpuTiProfile(profile::Profile* profile)
  */
 double CpuTiTmgr::integrate(double a, double b)
 {
-  if ((a < 0.0) || (a > b)) {
-    xbt_die("Error, invalid integration interval [%.2f,%.2f]. "
-        "You probably have a task executing with negative computation amount. Check your code.", a, b);
-  }
-  if (fabs(a - b) < EPSILON)
+  if (type_ == Type::DYNAMIC)
+    return profile_->integrate(a, b);
+  if (is_empty_interval(a, b))
     return 0.0;
+  return (b - a) * value_;
+}
 
-  if (type_ == Type::FIXED) {
-    return (b - a) * value_;
-  }
+double CpuTiProfile::integrate(double a, double b) const
+{
+  if (is_empty_interval(a, b))
+    return 0.0;
 
   int a_index;
+  int b_index;
+  split(a, b, a_index, b_index);
+  return combine(integral_at(a, time_tree_.search(a)), integral_at(b, time_tree_.search(b)), a_index, b_index);
+}
+
+void CpuTiProfile::integrate(std::size_t n, const double* a, const double* b, double* result) const
+{
+  std::vector<double> points(2 * n);
+  std::vector<int> chunks(2 * n);
+  std::vector<int> indices(2 * n);
+  for (std::size_t i = 0; i < n; i++) {
+    points[2 * i]     = a[i];
+    points[2 * i + 1] = b[i];
+    split(points[2 * i], points[2 * i + 1], chunks[2 * i], chunks[2 * i + 1]);
+  }
+  time_tree_.search(2 * n, points.data(), indices.data());
+  for (std::size_t i = 0; i < n; i++) {
+    if (is_empty_interval(a[i], b[i]))
+      result[i] = 0.0;
+    else
+      result[i] = combine(integral_at(points[2 * i], indices[2 * i]), integral_at(points[2 * i + 1], indices[2 * i + 1]),
+                          chunks[2 * i], chunks[2 * i + 1]);
+  }
+}
+
+/**
+ * @brief Moves the bounds of an integration interval into the period of the profile
+ *
+ * @param a        Begin of interval, moved into the period before the chunk a_index
+ * @param b        End of interval, moved into the period of the chunk b_index
+ */
+void CpuTiProfile::split(double& a, double& b, int& a_index, int& b_index) const
+{
   if (fabs(ceil(a / last_time_) - a / last_time_) < EPSILON)
     a_index = 1 + static_cast<int>(ceil(a / last_time_));
   else
     a_index = static_cast<int>(ceil(a / last_time_));
 
-  int b_index = static_cast<int>(floor(b / last_time_));
+  b_index = static_cast<int>(floor(b / last_time_));
+  a       = a - (a_index - 1) * last_time_;
+  b       = b - (b_index)*last_time_;
+}
 
-  if (a_index > b_index) {      /* Same chunk */
-    return profile_->integrate_simple(a - (a_index - 1) * last_time_, b - (b_index)*last_time_);
+/**
+ * @brief Computes an integral from the integrals at the bounds of its interval, once moved into the period
+ */
+double CpuTiProfile::combine(double integral_a, double integral_b, int a_index, int b_index) const
+{
+  if (a_index > b_index) { /* Same chunk */
+    return integral_b - integral_a;
   }
 
-  double first_chunk  = profile_->integrate_simple(a - (a_index - 1) * last_time_, last_time_);
+  double first_chunk  = integral_end_ - integral_a;
   double middle_chunk = (b_index - a_index) * total_;
-  double last_chunk   = profile_->integrate_simple(0.0, b - (b_index)*last_time_);
+  double last_chunk   = integral_b - integral_start_;
 
   XBT_DEBUG("first_chunk=%.2f  middle_chunk=%.2f  last_chunk=%.2f\n", first_chunk, middle_chunk, last_chunk);
 
   return (first_chunk + middle_chunk + last_chunk);
 }
 
-/**
- * @brief Auxiliary function to compute the integral between a and b.
- *     It simply computes the integrals at point a and b and returns the difference between them.
- * @param a  Initial point
- * @param b  Final point
- */
-double CpuTiProfile::integrate_simple(double a, double b)
-{
-  return integrate_simple_point(b) - integrate_simple_point(a);
-}
-
 /**
  * @brief Auxiliary function to compute the integral at point a.
  * @param a        point
+ * @param ind      interval of that point, as found in time_tree_
  */
-double CpuTiProfile::integrate_simple_point(double a)
+double CpuTiProfile::integral_at(double a, int ind) const
 {
-  double integral = 0;
-  double a_aux = a;
-  int ind         = binary_search(time_points_, a);
-  integral += integral_[ind];
+  double integral = integral_[ind];
+  double a_aux    = a;
 
-  XBT_DEBUG("a %f ind %d integral %f ind + 1 %f ind %f time +1 %f time %f", a, ind, integral, integral_[ind + 1],
-            integral_[ind], time_points_[ind + 1], time_points_[ind]);
+  XBT_DEBUG("a %f ind %d integral %f time %f", a, ind, integral, time_points_[ind]);
   double_update(&a_aux, time_points_[ind], sg_maxmin_precision * sg_surf_precision);
   if (a_aux > 0)
     integral +=
@@ -117,6 +253,21 @@ double CpuTiProfile::integrate_simple_point(double a)
   return integral;
 }
 
+/**
+ * @brief Auxiliary function to solve integral.
+ *  It returns the date when the integral reaches the requested value
+ * @param integral  Value of the integral
+ * @param ind       interval of that value, as found in integral_tree_
+ */
+double CpuTiProfile::date_of(double integral, int ind) const
+{
+  double time = time_points_[ind];
+  time += (integral - integral_[ind]) /
+          ((integral_[ind + 1] - integral_[ind]) / (time_points_[ind + 1] - time_points_[ind]));
+
+  return time;
+}
+
 /**
  * @brief Computes the time needed to execute "amount" on cpu.
  *
@@ -128,69 +279,73 @@ double CpuTiProfile::integrate_simple_point(double a)
  */
 double CpuTiTmgr::solve(double a, double amount)
 {
-  /* Fix very small negative numbers */
-  if ((a < 0.0) && (a > -EPSILON)) {
-    a = 0.0;
-  }
-  if ((amount < 0.0) && (amount > -EPSILON)) {
-    amount = 0.0;
-  }
-
-  /* Sanity checks */
-  if ((a < 0.0) || (amount < 0.0)) {
-    XBT_CRITICAL ("Error, invalid parameters [a = %.2f, amount = %.2f]. "
-        "You probably have a task executing with negative computation amount. Check your code.", a, amount);
-    xbt_abort();
-  }
-
-  /* At this point, a and amount are positive */
-  if (amount < EPSILON)
+  if (type_ == Type::DYNAMIC)
+    return profile_->solve(a, amount);
+  if (is_null_amount(a, amount))
     return a;
+  return (a + (amount / value_));
+}
 
-  /* Is the trace fixed ? */
-  if (type_ == Type::FIXED) {
-    return (a + (amount / value_));
-  }
+double CpuTiProfile::solve(double a, double amount) const
+{
+  double result;
+  solve(1, &a, &amount, &result);
+  return result;
+}
 
-  XBT_DEBUG("amount %f total %f", amount, total_);
-  /* Reduce the problem to one where amount <= trace_total */
-  int quotient = static_cast<int>(floor(amount / total_));
-  double reduced_amount = (total_) * ((amount / total_) - floor(amount / total_));
-  double reduced_a      = a - (last_time_) * static_cast<int>(floor(a / last_time_));
+void CpuTiProfile::solve(std::size_t n, const double* a, const double* amount, double* result) const
+{
+  std::vector<double> reduced_a(n);
+  std::vector<double> reduced_amount(n);
+  std::vector<double> period_ends(n, last_time_);
+  std::vector<double> amount_till_end(n);
+  std::vector<int> quotient(n);
+  std::vector<bool> solved(n);
+  std::vector<bool> wraps(n);
 
-  XBT_DEBUG("Quotient: %d reduced_amount: %f reduced_a: %f", quotient, reduced_amount, reduced_a);
+  for (std::size_t i = 0; i < n; i++) {
+    double a_i      = a[i];
+    double amount_i = amount[i];
+    solved[i]       = is_null_amount(a_i, amount_i);
+    if (solved[i]) {
+      result[i] = a_i;
+      continue;
+    }
+    XBT_DEBUG("amount %f total %f", amount_i, total_);
+    /* Reduce the problem to one where amount <= trace_total */
+    quotient[i]       = static_cast<int>(floor(amount_i / total_));
+    reduced_amount[i] = (total_) * ((amount_i / total_) - floor(amount_i / total_));
+    reduced_a[i]      = a_i - (last_time_) * static_cast<int>(floor(a_i / last_time_));
+    result[i]         = (last_time_) * static_cast<int>(floor(a_i / last_time_)) + (quotient[i] * last_time_);
+    XBT_DEBUG("Quotient: %d reduced_amount: %f reduced_a: %f", quotient[i], reduced_amount[i], reduced_a[i]);
+  }
 
   /* Now solve for new_amount which is <= trace_total */
-  double reduced_b;
-  XBT_DEBUG("Solve integral: [%.2f, amount=%.2f]", reduced_a, reduced_amount);
-  double amount_till_end = integrate(reduced_a, last_time_);
-
-  if (amount_till_end > reduced_amount) {
-    reduced_b = profile_->solve_simple(reduced_a, reduced_amount);
-  } else {
-    reduced_b = last_time_ + profile_->solve_simple(0.0, reduced_amount - amount_till_end);
+  integrate(n, reduced_a.data(), period_ends.data(), amount_till_end.data());
+  std::vector<double> starts(reduced_a);
+  std::vector<double> targets(reduced_amount);
+  std::vector<int> indices(n);
+  for (std::size_t i = 0; i < n; i++) {
+    wraps[i] = amount_till_end[i] <= reduced_amount[i];
+    if (wraps[i]) { /* the execution goes on during the next period */
+      starts[i]  = 0.0;
+      targets[i] -= amount_till_end[i];
+    }
   }
+  time_tree_.search(n, starts.data(), indices.data());
+  for (std::size_t i = 0; i < n; i++)
+    targets[i] += integral_at(starts[i], indices[i]);
+  integral_tree_.search(n, targets.data(), indices.data());
 
   /* Re-map to the original b and amount */
-  return (last_time_) * static_cast<int>(floor(a / last_time_)) + (quotient * last_time_) + reduced_b;
-}
-
-/**
- * @brief Auxiliary function to solve integral.
- *  It returns the date when the requested amount of flops is available
- * @param a        Initial point
- * @param amount  Amount of flops
- * @return The date when amount is available.
- */
-double CpuTiProfile::solve_simple(double a, double amount)
-{
-  double integral_a = integrate_simple_point(a);
-  int ind           = binary_search(integral_, integral_a + amount);
-  double time       = time_points_[ind];
-  time += (integral_a + amount - integral_[ind]) /
-          ((integral_[ind + 1] - integral_[ind]) / (time_points_[ind + 1] - time_points_[ind]));
-
-  return time;
+  for (std::size_t i = 0; i < n; i++) {
+    if (solved[i])
+      continue;
+    double reduced_b = date_of(targets[i], indices[i]);
+    if (wraps[i])
+      reduced_b = last_time_ + reduced_b;
+    result[i] = result[i] + reduced_b;
+  }
 }
 
 /**
@@ -202,65 +357,15 @@ double CpuTiProfile::solve_simple(double a, double amount)
  */
 double CpuTiTmgr::get_power_scale(double a)
 {
-  double reduced_a          = a - floor(a / last_time_) * last_time_;
-  int point                       = CpuTiProfile::binary_search(profile_->time_points_, reduced_a);
-  kernel::profile::DatedValue val = speed_profile_->event_list.at(point);
-  return val.value_;
+  if (type_ == Type::FIXED)
+    return value_;
+  return profile_->get_power_scale(a);
 }
 
-/**
- * @brief Creates a new integration trace from a tmgr_trace_t
- *
- * @param  speed_trace    CPU availability trace
- * @param  value          Percentage of CPU speed available (useful to fixed tracing)
- * @return  Integration trace structure
- */
-CpuTiTmgr::CpuTiTmgr(kernel::profile::Profile* speed_profile, double value) : speed_profile_(speed_profile)
+double CpuTiProfile::get_power_scale(double a) const
 {
-  double total_time = 0.0;
-  profile_.reset(nullptr);
-
-  /* no availability file, fixed trace */
-  if (not speed_profile) {
-    type_  = Type::FIXED;
-    value_ = value;
-    XBT_DEBUG("No availability trace. Constant value = %f", value);
-    return;
-  }
-
-  /* only one point available, fixed trace */
-  if (speed_profile->event_list.size() == 1) {
-    type_  = Type::FIXED;
-    value_ = speed_profile->event_list.front().value_;
-    return;
-  }
-
-  type_ = Type::DYNAMIC;
-
-  /* count the total time of trace file */
-  for (auto const& val : speed_profile->event_list)
-    total_time += val.date_;
-
-  profile_.reset(new CpuTiProfile(speed_profile));
-  last_time_ = total_time;
-  total_     = profile_->integrate_simple(0, total_time);
-
-  XBT_DEBUG("Total integral %f, last_time %f ", total_, last_time_);
-}
-
-/**
- * @brief Binary search in array.
- *  It returns the last point of the interval in which "a" is.
- * @param array    Array
- * @param a        Value to search
- * @return Index of point
- */
-int CpuTiProfile::binary_search(const std::vector<double>& array, double a)
-{
-  if (array[0] > a)
-    return 0;
-  auto pos = std::upper_bound(begin(array), end(array), a);
-  return std::distance(begin(array), pos) - 1;
+  double reduced_a = a - floor(a / last_time_) * last_time_;
+  return values_.at(time_tree_.search(reduced_a));
 }
 
 /*********
@@ -291,16 +396,139 @@ kernel::resource::Cpu* CpuTiModel::create_cpu(s4u::Host* host, const std::vector
   return new CpuTi(this, host, speed_per_pstate, core);
 }
 
+/** @brief Returns the integral of that speed profile, shared with the CPUs using the same profile or the same values */
+std::shared_ptr<const CpuTiProfile> CpuTiModel::share_profile(profile::Profile* profile)
+{
+  auto known = profiles_.find(profile);
+  if (known != profiles_.end())
+    return known->second;
+
+  std::shared_ptr<const CpuTiProfile> ti_profile = std::make_shared<CpuTiProfile>(profile);
+  auto same_hash = profiles_by_values_.equal_range(ti_profile->get_hash());
+  auto same      = std::find_if(same_hash.first, same_hash.second,
+                           [&ti_profile](const std::pair<const std::size_t, std::shared_ptr<const CpuTiProfile>>& kv) {
+                             return kv.second->has_same_values(*ti_profile);
+                           });
+  if (same != same_hash.second) {
+    XBT_DEBUG("Profile %p has the same values as a known one, sharing its integral", profile);
+    ti_profile = same->second;
+  } else {
+    profiles_by_values_.emplace(ti_profile->get_hash(), ti_profile);
+  }
+  profiles_.emplace(profile, ti_profile);
+  return ti_profile;
+}
+
+/** @brief Answers the requests (x[i], y[i]) about profiles[i] with one call of op per profile, on all its requests */
+template <class F>
+static void by_profile(const std::vector<const CpuTiProfile*>& profiles, const std::vector<double>& x,
+                       const std::vector<double>& y, std::vector<double>& result, F op)
+{
+  std::unordered_map<const CpuTiProfile*, std::size_t> batch_of;
+  std::vector<std::vector<std::size_t>> batches;
+  for (std::size_t i = 0; i < profiles.size(); i++) {
+    auto batch = batch_of.emplace(profiles[i], batches.size());
+    if (batch.second)
+      batches.emplace_back();
+    batches[batch.first->second].push_back(i);
+  }
+
+  std::vector<double> batch_x;
+  std::vector<double> batch_y;
+  std::vector<double> batch_result;
+  for (std::vector<std::size_t> const& batch : batches) {
+    batch_x.clear();
+    batch_y.clear();
+    for (std::size_t i : batch) {
+      batch_x.push_back(x[i]);
+      batch_y.push_back(y[i]);
+    }
+    batch_result.resize(batch.size());
+    op(profiles[batch.front()], batch.size(), batch_x.data(), batch_y.data(), batch_result.data());
+    for (std::size_t j = 0; j < batch.size(); j++)
+      result[batch[j]] = batch_result[j];
+  }
+}
+
+/** @brief Updates the remaining amount of the actions of these CPUs, integrating the CPUs of the same profile at once */
+void CpuTiModel::update_remaining_amounts(const std::vector<CpuTi*>& cpus, double now)
+{
+  std::vector<CpuTi*> batched_cpus;
+  std::vector<const CpuTiProfile*> profiles;
+  std::vector<double> begins;
+  for (CpuTi* cpu : cpus) {
+    const CpuTiProfile* profile = cpu->speed_integrated_trace_->get_profile();
+    if (cpu->last_update_ >= now) /* already up to date */
+      continue;
+    if (profile == nullptr) {
+      cpu->update_remaining_amount(now);
+      continue;
+    }
+    batched_cpus.push_back(cpu);
+    profiles.push_back(profile);
+    begins.push_back(cpu->last_update_);
+  }
+
+  std::vector<double> ends(batched_cpus.size(), now);
+  std::vector<double> integrals(batched_cpus.size());
+  by_profile(profiles, begins, ends, integrals,
+             [](const CpuTiProfile* profile, std::size_t n, const double* a, const double* b, double* result) {
+               profile->integrate(n, a, b, result);
+             });
+  for (std::size_t i = 0; i < batched_cpus.size(); i++)
+    batched_cpus[i]->update_remaining_amount(now, integrals[i]);
+}
+
+/** @brief Updates the finish date of the actions of these CPUs, solving the CPUs of the same profile at once */
+void CpuTiModel::update_actions_finish_times(const std::vector<CpuTi*>& cpus, double now)
+{
+  std::vector<CpuTiAction*> batched_actions;
+  std::vector<const CpuTiProfile*> profiles;
+  std::vector<double> areas;
+  for (CpuTi* cpu : cpus) {
+    cpu->update_sum_priority();
+    const CpuTiProfile* profile = cpu->speed_integrated_trace_->get_profile();
+    for (CpuTiAction& action : cpu->action_set_) {
+      /* action not running, skip it */
+      if (action.get_state_set() != surf_cpu_model_pm->get_started_action_set())
+        continue;
+      if (not action.is_running() || action.get_sharing_penalty() <= 0)
+        continue;
+
+      double total_area = cpu->get_total_area(action);
+      if (profile == nullptr) {
+        action.set_finish_time(cpu->speed_integrated_trace_->solve(now, total_area));
+      } else {
+        batched_actions.push_back(&action);
+        profiles.push_back(profile);
+        areas.push_back(total_area);
+      }
+    }
+  }
+
+  std::vector<double> begins(batched_actions.size(), now);
+  std::vector<double> finish_times(batched_actions.size());
+  by_profile(profiles, begins, areas, finish_times,
+             [](const CpuTiProfile* profile, std::size_t n, const double* a, const double* amount, double* result) {
+               profile->solve(n, a, amount, result);
+             });
+  for (std::size_t i = 0; i < batched_actions.size(); i++)
+    batched_actions[i]->set_finish_time(finish_times[i]);
+
+  for (CpuTi* cpu : cpus)
+    cpu->update_actions_finish_time(now);
+}
+
 double CpuTiModel::next_occuring_event(double now)
 {
   double min_action_duration = -1;
 
-  /* iterates over modified cpus to update share resources */
-  for (auto it = std::begin(modified_cpus_); it != std::end(modified_cpus_);) {
-    CpuTi& cpu = *it;
-    ++it; // increment iterator here since the following call to ti.update_actions_finish_time() may invalidate it
-    cpu.update_actions_finish_time(now);
-  }
+  /* update the modified cpus to update share resources. The cpus sharing a profile are handled together */
+  std::vector<CpuTi*> cpus;
+  for (CpuTi& cpu : modified_cpus_)
+    cpus.push_back(&cpu);
+  update_remaining_amounts(cpus, now);
+  update_actions_finish_times(cpus, now);
 
   /* get the min next event if heap not empty */
   if (not get_action_heap().empty())
@@ -313,13 +541,17 @@ double CpuTiModel::next_occuring_event(double now)
 
 void CpuTiModel::update_actions_state(double now, double /*delta*/)
 {
+  std::vector<CpuTi*> cpus;
+  std::unordered_set<CpuTi*> known_cpus;
   while (not get_action_heap().empty() && double_equals(get_action_heap().top_date(), now, sg_surf_precision)) {
     CpuTiAction* action = static_cast<CpuTiAction*>(get_action_heap().pop());
     XBT_DEBUG("Action %p: finish", action);
+    if (known_cpus.insert(action->cpu_).second)
+      cpus.push_back(action->cpu_);
     action->finish(kernel::resource::Action::State::FINISHED);
-    /* update remaining amount of all actions */
-    action->cpu_->update_remaining_amount(surf_get_clock());
   }
+  /* update remaining amount of all actions, in one sweep over the cpus sharing a profile */
+  update_remaining_amounts(cpus, surf_get_clock());
 }
 
 /************
@@ -333,7 +565,7 @@ CpuTi::CpuTi(CpuTiModel* model, simgrid::s4u::Host* host, const std::vector<doub
   speed_.peak = speed_per_pstate.front();
   XBT_DEBUG("CPU create: peak=%f", speed_.peak);
 
-  speed_integrated_trace_ = new CpuTiTmgr(nullptr, 1 /*scale*/);
+  speed_integrated_trace_ = new CpuTiTmgr(1.0 /*scale*/);
 }
 
 CpuTi::~CpuTi()
@@ -344,11 +576,18 @@ CpuTi::~CpuTi()
 void CpuTi::set_speed_profile(kernel::profile::Profile* profile)
 {
   delete speed_integrated_trace_;
-  speed_integrated_trace_ = new CpuTiTmgr(profile, speed_.scale);
+  if (not profile) {
+    XBT_DEBUG("No availability trace. Constant value = %f", speed_.scale);
+    speed_integrated_trace_ = new CpuTiTmgr(speed_.scale);
+  } else if (profile->size() == 1) { /* only one point available, fixed trace */
+    speed_integrated_trace_ = new CpuTiTmgr(profile->at(0).value_);
+  } else {
+    speed_integrated_trace_ = new CpuTiTmgr(static_cast<CpuTiModel*>(get_model())->share_profile(profile));
+  }
 
   /* add a fake trace event if periodicity == 0 */
-  if (profile && profile->event_list.size() > 1) {
-    kernel::profile::DatedValue val = profile->event_list.back();
+  if (profile && profile->size() > 1) {
+    kernel::profile::DatedValue val = profile->at(profile->size() - 1);
     if (val.date_ < 1e-12) {
       simgrid::kernel::profile::Profile* prof = new simgrid::kernel::profile::Profile();
       speed_.event                            = prof->schedule(&profile::future_evt_set, this);
@@ -400,13 +639,9 @@ void CpuTi::apply_event(kernel::profile::Event* event, double value)
   }
 }
 
-/** Update the actions that are running on this CPU (which was modified recently) */
-void CpuTi::update_actions_finish_time(double now)
+/** Compute the sum of priorities for the actions running on that CPU */
+void CpuTi::update_sum_priority()
 {
-  /* update remaining amount of actions */
-  update_remaining_amount(now);
-
-  /* Compute the sum of priorities for the actions running on that CPU */
   sum_priority_ = 0.0;
   for (CpuTiAction const& action : action_set_) {
     /* action not running, skip it */
@@ -423,7 +658,18 @@ void CpuTi::update_actions_finish_time(double now)
 
     sum_priority_ += 1.0 / action.get_sharing_penalty();
   }
+}
 
+/** Total area needed to finish that action. Used in trace integration */
+double CpuTi::get_total_area(CpuTiAction& action) const
+{
+  return (action.get_remains() * sum_priority_ * action.get_sharing_penalty()) / speed_.peak;
+}
+
+/** Update the heap of the actions that are running on this CPU (which was modified recently).
+ *  Their remaining amount and finish date must be up to date, see CpuTiModel::update_actions_finish_times() */
+void CpuTi::update_actions_finish_time(double now)
+{
   for (CpuTiAction& action : action_set_) {
     double min_finish = -1;
     /* action not running, skip it */
@@ -432,10 +678,6 @@ void CpuTi::update_actions_finish_time(double now)
 
     /* verify if the action is really running on cpu */
     if (action.is_running() && action.get_sharing_penalty() > 0) {
-      /* total area needed to finish the action. Used in trace integration */
-      double total_area = (action.get_remains() * sum_priority_ * action.get_sharing_penalty()) / speed_.peak;
-
-      action.set_finish_time(speed_integrated_trace_->solve(now, total_area));
       /* verify which event will happen before (max_duration or finish time) */
       if (action.get_max_duration() != NO_MAX_DURATION &&
           action.get_start_time() + action.get_max_duration() < action.get_finish_time())
@@ -478,8 +720,14 @@ void CpuTi::update_remaining_amount(double now)
   if (last_update_ >= now)
     return;
 
+  update_remaining_amount(now, speed_integrated_trace_->integrate(last_update_, now));
+}
+
+/** @brief Update the remaining amount of actions, given the integral of the speed profile since the last update */
+void CpuTi::update_remaining_amount(double now, double integral)
+{
   /* compute the integration area */
-  double area_total = speed_integrated_trace_->integrate(last_update_, now) * speed_.peak;
+  double area_total = integral * speed_.peak;
   XBT_DEBUG("Flops total: %f, Last update %f", area_total, last_update_);
   for (CpuTiAction& action : action_set_) {
     /* action not running, skip it */
@@ -512,7 +760,7 @@ void CpuTi::update_remaining_amount(double now)
 kernel::resource::CpuAction* CpuTi::execution_start(double size)
 {
   XBT_IN("(%s,%g)", get_cname(), size);
-  CpuTiAction* action = new CpuTiAction(this, size);
+  CpuTiAction* action = new (get_model()) CpuTiAction(this, size);
 
   action_set_.push_back(*action); // Actually start the action
 
@@ -526,7 +774,7 @@ kernel::resource::CpuAction* CpuTi::sleep(double duration)
     duration = std::max(duration, sg_surf_precision);
 
   XBT_IN("(%s,%g)", get_cname(), duration);
-  CpuTiAction* action = new CpuTiAction(this, 1.0);
+  CpuTiAction* action = new (get_model()) CpuTiAction(this, 1.0);
 
   action->set_max_duration(duration);
   action->set_suspend_state(kernel::resource::Action::SuspendStates::SLEEPING);
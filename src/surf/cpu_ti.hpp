@@ -11,6 +11,8 @@
 
 #include <boost/intrusive/list.hpp>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace simgrid {
 namespace kernel {
@@ -25,17 +27,67 @@ class XBT_PRIVATE CpuTi;
 /*********
  * Trace *
  *********/
+/** @brief Integral of a speed profile, that repeats itself every period
+ *
+ * The instances are immutable, and shared by all the CPUs whose profiles have the same values (see
+ * CpuTiModel::share_profile()). Besides the scalar integrate() and solve(), they answer batches of requests at once:
+ * the searches of a batch are interleaved, level by level of the search trees.
+ */
 class CpuTiProfile {
 public:
+  /** @brief Sorted array in Eytzinger layout (the breadth-first order of its search tree)
+   *
+   * The children of the node k are the nodes 2k and 2k+1, so each step of a search is a branchless comparison, and the
+   * searches of a batch visit the same levels at the same time.
+   */
+  class SearchTree {
+  public:
+    SearchTree() = default;
+    explicit SearchTree(const std::vector<double>& sorted);
+    /** Index of the last element that is lower or equal to key (or 0 if there is none) */
+    int search(double key) const;
+    /** Same as search(), for n keys at once */
+    void search(std::size_t n, const double* keys, int* result) const;
+
+  private:
+    std::size_t fill(const std::vector<double>& sorted, std::size_t rank, std::size_t node);
+    int index_of(std::size_t node) const;
+
+    std::vector<double> nodes_; // nodes_[0] is unused; the tree is padded with +infinity
+    std::vector<int> ranks_;    // rank of each node in the sorted array; ranks_[0] is the size of that array
+    unsigned depth_ = 0;
+  };
+
   explicit CpuTiProfile(profile::Profile* profile);
+  CpuTiProfile(const CpuTiProfile&) = delete;
+  CpuTiProfile& operator=(const CpuTiProfile&) = delete;
+
+  double integrate(double a, double b) const;
+  double solve(double a, double amount) const;
+  double get_power_scale(double a) const;
+  /* The same for n requests at once */
+  void integrate(std::size_t n, const double* a, const double* b, double* result) const;
+  void solve(std::size_t n, const double* a, const double* amount, double* result) const;
 
-  double integrate_simple(double a, double b);
-  double integrate_simple_point(double a);
-  double solve_simple(double a, double amount);
+  bool has_same_values(const CpuTiProfile& other) const;
+  std::size_t get_hash() const { return hash_; }
 
-  std::vector<double> time_points_;
-  std::vector<double> integral_;
-  static int binary_search(const std::vector<double>& array, double a);
+private:
+  void split(double& a, double& b, int& a_index, int& b_index) const;
+  double combine(double integral_a, double integral_b, int a_index, int b_index) const;
+  double integral_at(double a, int ind) const;
+  double date_of(double integral, int ind) const;
+
+  std::vector<double> time_points_; /*< Starting date of each interval of constant speed */
+  std::vector<double> integral_;    /*< Integral from the beginning of the period to each point */
+  std::vector<double> values_;      /*< Speed scale during each interval */
+  SearchTree time_tree_;
+  SearchTree integral_tree_;
+  double last_time_      = 0.0; /*< Length of the period */
+  double total_          = 0.0; /*< Integral over a whole period */
+  double integral_start_ = 0.0; /*< Integral up to the beginning of the period */
+  double integral_end_   = 0.0; /*< Integral up to the end of the period */
+  std::size_t hash_      = 0;
 };
 
 class CpuTiTmgr {
@@ -46,24 +98,24 @@ class CpuTiTmgr {
 
 public:
   explicit CpuTiTmgr(double value) : type_(Type::FIXED), value_(value){};
-  CpuTiTmgr(profile::Profile* speed_profile, double value);
+  explicit CpuTiTmgr(std::shared_ptr<const CpuTiProfile> profile) : type_(Type::DYNAMIC), profile_(std::move(profile))
+  {
+  }
   CpuTiTmgr(const CpuTiTmgr&) = delete;
   CpuTiTmgr& operator=(const CpuTiTmgr&) = delete;
 
   double integrate(double a, double b);
   double solve(double a, double amount);
   double get_power_scale(double a);
+  /** The shared integral of the speed profile, or nullptr if the speed is fixed */
+  const CpuTiProfile* get_profile() const { return profile_.get(); }
 
 private:
   Type type_;
-  double value_;                 /*< Percentage of cpu speed available. Value fixed between 0 and 1 */
+  double value_ = 0.0; /*< Percentage of cpu speed available. Value fixed between 0 and 1 */
 
   /* Dynamic */
-  double last_time_ = 0.0;             /*< Integral interval last point (discrete time) */
-  double total_    = 0.0;             /*< Integral total between 0 and last_pointn */
-
-  std::unique_ptr<CpuTiProfile> profile_ = nullptr;
-  profile::Profile* speed_profile_       = nullptr;
+  std::shared_ptr<const CpuTiProfile> profile_ = nullptr;
 };
 
 /**********
@@ -107,8 +159,11 @@ public:
   void set_speed_profile(profile::Profile* profile) override;
 
   void apply_event(profile::Event* event, double value) override;
+  void update_sum_priority();
+  double get_total_area(CpuTiAction& action) const;
   void update_actions_finish_time(double now);
   void update_remaining_amount(double now);
+  void update_remaining_amount(double now, double integral);
 
   bool is_used() override;
   CpuAction* execution_start(double size) override;
@@ -147,8 +202,16 @@ public:
   Cpu* create_cpu(s4u::Host* host, const std::vector<double>& speed_per_pstate, int core) override;
   double next_occuring_event(double now) override;
   void update_actions_state(double now, double delta) override;
+  std::shared_ptr<const CpuTiProfile> share_profile(profile::Profile* profile);
 
   CpuTiList modified_cpus_;
+
+private:
+  void update_remaining_amounts(const std::vector<CpuTi*>& cpus, double now);
+  void update_actions_finish_times(const std::vector<CpuTi*>& cpus, double now);
+
+  std::unordered_map<profile::Profile*, std::shared_ptr<const CpuTiProfile>> profiles_;
+  std::unordered_multimap<std::size_t, std::shared_ptr<const CpuTiProfile>> profiles_by_values_;
 };
 
 } // namespace resource
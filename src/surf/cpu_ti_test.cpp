@@ -0,0 +1,108 @@
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#include "catch.hpp"
+
+#include "src/kernel/resource/profile/Profile.hpp"
+#include "src/surf/cpu_ti.hpp"
+#include "src/surf/surf_interface.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using simgrid::kernel::profile::Profile;
+using simgrid::kernel::resource::CpuTiProfile;
+
+/* A looping profile of random speeds, that starts at date 0 */
+static Profile* random_profile(const std::string& name, std::mt19937& gen, int nb_events)
+{
+  std::uniform_real_distribution<double> delay(0.1, 10.0);
+  std::uniform_real_distribution<double> speed(0.05, 1.0);
+  std::string input;
+  double date = 0.0;
+  for (int i = 0; i < nb_events; i++) {
+    input += std::to_string(date) + " " + std::to_string(speed(gen)) + "\n";
+    date += delay(gen);
+  }
+  input += "LOOPAFTER " + std::to_string(delay(gen)) + "\n";
+  return Profile::from_string(name, input, -1);
+}
+
+TEST_CASE("surf::cpu_ti: Search trees find the same points as a binary search", "cpu_ti")
+{
+  std::mt19937 gen(42);
+  for (unsigned size = 1; size < 70; size++) {
+    INFO("Array of " << size << " elements");
+    std::vector<double> sorted(size);
+    std::uniform_int_distribution<int> value(0, size / 2); // with duplicates
+    for (double& v : sorted)
+      v = value(gen);
+    std::sort(sorted.begin(), sorted.end());
+    CpuTiProfile::SearchTree tree(sorted);
+
+    std::vector<double> keys;
+    for (double k = -1.0; k <= size / 2 + 1; k += 0.5)
+      keys.push_back(k);
+    std::vector<int> found(keys.size());
+    tree.search(keys.size(), keys.data(), found.data());
+    for (unsigned i = 0; i < keys.size(); i++) {
+      auto pos     = std::upper_bound(sorted.begin(), sorted.end(), keys[i]);
+      int expected = pos == sorted.begin() ? 0 : std::distance(sorted.begin(), pos) - 1;
+      REQUIRE(tree.search(keys[i]) == expected);
+      REQUIRE(found[i] == expected);
+    }
+  }
+}
+
+TEST_CASE("surf::cpu_ti: Batched integrals and solutions are the scalar ones", "cpu_ti")
+{
+  std::mt19937 gen(4242);
+  for (int nb_events : {1, 2, 5, 30, 200}) {
+    CpuTiProfile profile(random_profile("profile " + std::to_string(nb_events), gen, nb_events));
+
+    std::uniform_real_distribution<double> date(0.0, 3000.0);
+    std::uniform_real_distribution<double> amount(0.0, 500.0);
+    const int n = 500;
+    std::vector<double> a(n);
+    std::vector<double> b(n);
+    std::vector<double> amounts(n);
+    for (int i = 0; i < n; i++) {
+      a[i]       = date(gen);
+      b[i]       = i % 10 == 0 ? a[i] : a[i] + amount(gen);
+      amounts[i] = i % 10 == 1 ? 0.0 : amount(gen);
+    }
+    std::vector<double> integrals(n);
+    std::vector<double> finish_dates(n);
+    profile.integrate(n, a.data(), b.data(), integrals.data());
+    profile.solve(n, a.data(), amounts.data(), finish_dates.data());
+
+    for (int i = 0; i < n; i++) {
+      INFO("Profile of " << nb_events << " events, request " << i);
+      REQUIRE(integrals[i] == profile.integrate(a[i], b[i]));
+      REQUIRE(finish_dates[i] == profile.solve(a[i], amounts[i]));
+      REQUIRE(finish_dates[i] >= a[i]);
+      REQUIRE(profile.integrate(a[i], finish_dates[i]) == Approx(amounts[i]).margin(1e-6));
+    }
+  }
+  tmgr_finalize();
+}
+
+TEST_CASE("surf::cpu_ti: Profiles of the same values are recognized", "cpu_ti")
+{
+  const char* values = "0 1.0\n"
+                       "2 0.5\n"
+                       "LOOPAFTER 3\n";
+  CpuTiProfile first(Profile::from_string("first", values, -1));
+  CpuTiProfile same(Profile::from_string("same", values, -1));
+  CpuTiProfile other(Profile::from_string("other", "0 1.0\n2 0.25\nLOOPAFTER 3\n", -1));
+
+  REQUIRE(first.get_hash() == same.get_hash());
+  REQUIRE(first.has_same_values(same));
+  REQUIRE(not first.has_same_values(other));
+  REQUIRE(first.integrate(0, 10) == same.integrate(0, 10));
+  tmgr_finalize();
+}
@@ -32,10 +32,15 @@ HostCLM03Model::HostCLM03Model()
 }
 double HostCLM03Model::next_occuring_event(double now)
 {
-  double min_by_cpu = surf_cpu_model_pm->next_occuring_event(now);
-  double min_by_net =
-      surf_network_model->next_occuring_event_is_idempotent() ? surf_network_model->next_occuring_event(now) : -1;
-  double min_by_sto = surf_storage_model->next_occuring_event(now);
+  bool with_net = surf_network_model->next_occuring_event_is_idempotent();
+  std::vector<kernel::resource::Model*> models{surf_cpu_model_pm, surf_storage_model};
+  if (with_net)
+    models.insert(models.begin() + 1, surf_network_model);
+  std::vector<double> dates = poll_next_occuring_events(models, now);
+
+  double min_by_cpu = dates.front();
+  double min_by_net = with_net ? dates[1] : -1;
+  double min_by_sto = dates.back();
 
   XBT_DEBUG("model %p, %s min_by_cpu %f, %s min_by_net %f, %s min_by_sto %f",
       this, typeid(surf_cpu_model_pm).name(), min_by_cpu,
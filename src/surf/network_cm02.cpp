@@ -4,13 +4,16 @@
  * under the terms of the license (GNU LGPL) which comes with this package. */
 
 #include "network_cm02.hpp"
+#include "simgrid/kernel/routing/NetZoneImpl.hpp"
 #include "simgrid/s4u/Host.hpp"
 #include "simgrid/sg_config.hpp"
 #include "src/kernel/resource/profile/Event.hpp"
+#include "src/kernel/routing/RouteMemo.hpp"
 #include "src/surf/surf_interface.hpp"
 #include "surf/surf.hpp"
 
 #include <algorithm>
+#include <limits>
 #include <numeric>
 
 XBT_LOG_EXTERNAL_DEFAULT_CATEGORY(surf_network);
@@ -73,6 +76,7 @@ namespace resource {
 NetworkCm02Model::NetworkCm02Model(kernel::lmm::System* (*make_new_lmm_system)(bool))
     : NetworkModel(simgrid::config::get_value<std::string>("network/optim") == "Full" ? Model::UpdateAlgo::FULL
                                                                                       : Model::UpdateAlgo::LAZY)
+    , analytic_thresh_(simgrid::config::get_value<int>("network/analytic-thresh"))
 {
   all_existing_models.push_back(this);
 
@@ -86,6 +90,7 @@ NetworkCm02Model::NetworkCm02Model(kernel::lmm::System* (*make_new_lmm_system)(b
   }
 
   set_maxmin_system(make_new_lmm_system(select));
+  get_maxmin_system()->set_incremental(select && simgrid::config::get_value<bool>("network/maxmin-incremental"));
   loopback_ = NetworkCm02Model::create_link("__loopback__", std::vector<double>(1, 498000000), 0.000015,
                                             s4u::Link::SharingPolicy::FATPIPE);
 }
@@ -131,6 +136,16 @@ void NetworkCm02Model::update_actions_state_full(double /*now*/, double delta)
     NetworkCm02Action& action = static_cast<NetworkCm02Action&>(*it);
     ++it; // increment iterator here since the following calls to action.finish() may invalidate it
     XBT_DEBUG("Something happened to action %p", &action);
+    if (action.is_analytic()) {
+      if (action.is_running())
+        action.update_analytic_time_left(delta);
+      if (action.get_max_duration() != NO_MAX_DURATION)
+        action.update_max_duration(delta);
+      if ((action.is_running() && action.get_analytic_time_left() <= 0) ||
+          ((action.get_max_duration() != NO_MAX_DURATION) && (action.get_max_duration() <= 0)))
+        action.finish(Action::State::FINISHED);
+      continue;
+    }
     double deltap = delta;
     if (action.latency_ > 0) {
       if (action.latency_ > deltap) {
@@ -162,29 +177,83 @@ void NetworkCm02Model::update_actions_state_full(double /*now*/, double delta)
   }
 }
 
+double NetworkCm02Model::next_occuring_event_full(double now)
+{
+  double min = NetworkModel::next_occuring_event_full(now);
+  if (analytic_communications_ > 0) {
+    for (Action const& action : *get_started_action_set()) {
+      const NetworkCm02Action& net_action = static_cast<const NetworkCm02Action&>(action);
+      if (net_action.is_analytic() && net_action.is_running() &&
+          (min < 0 || net_action.get_analytic_time_left() < min))
+        min = net_action.get_analytic_time_left();
+    }
+  }
+  return min;
+}
+
+ModelStatistics NetworkCm02Model::get_statistics() const
+{
+  ModelStatistics stats        = NetworkModel::get_statistics();
+  routing::RouteMemo const& routes = routing::NetZoneImpl::get_route_memo();
+  stats.route_cache_hits           = routes.get_hits();
+  stats.route_cache_misses         = routes.get_misses();
+  stats.analytic_communications = analytic_communications_;
+  return stats;
+}
+
+/** @brief The rate that a communication would get alone on that route, with that bound (or -1 if not bounded) */
+double NetworkCm02Model::get_lone_rate(const std::vector<LinkImpl*>& route, const std::vector<LinkImpl*>& back_route,
+                                       double bound) const
+{
+  double rate = bound;
+  for (LinkImpl* const& link : route) {
+    /* The communication uses the link with a weight of 1, plus 0.05 for each use by the back route. These weights add
+     * up on shared links, while each use is bounded separately by the capacity of fatpipe links */
+    double weight = 1.0;
+    if (link->get_sharing_policy() != s4u::Link::SharingPolicy::FATPIPE)
+      weight += .05 * std::count(back_route.begin(), back_route.end(), link);
+    double link_rate = link->get_constraint()->bound_ / weight;
+    rate             = rate < 0 ? link_rate : std::min(rate, link_rate);
+  }
+  for (LinkImpl* const& link : back_route) {
+    if (std::find(route.begin(), route.end(), link) != route.end())
+      continue;
+    double weight = link->get_sharing_policy() == s4u::Link::SharingPolicy::FATPIPE
+                        ? .05
+                        : .05 * std::count(back_route.begin(), back_route.end(), link);
+    double link_rate = link->get_constraint()->bound_ / weight;
+    rate             = rate < 0 ? link_rate : std::min(rate, link_rate);
+  }
+  return rate;
+}
+
 Action* NetworkCm02Model::communicate(s4u::Host* src, s4u::Host* dst, double size, double rate)
 {
-  double latency = 0.0;
-  std::vector<LinkImpl*> back_route;
-  std::vector<LinkImpl*> route;
+  static const std::vector<LinkImpl*> no_route;
+  routing::RouteMemo& routes = routing::NetZoneImpl::get_route_memo();
+  routing::RouteMemo::Route route_storage;
+  routing::RouteMemo::Route back_route_storage;
 
   XBT_IN("(%s,%s,%g,%g)", src->get_cname(), dst->get_cname(), size, rate);
 
-  src->route_to(dst, route, &latency);
+  const routing::RouteMemo::Route& cached_route = routes.get(src->pimpl_netpoint, dst->pimpl_netpoint, route_storage);
+  const std::vector<LinkImpl*>& route           = cached_route.links;
+  double latency                                = cached_route.latency;
   xbt_assert(not route.empty() || latency > 0,
              "You're trying to send data from %s to %s but there is no connecting path between these two hosts.",
              src->get_cname(), dst->get_cname());
 
   bool failed = std::any_of(route.begin(), route.end(), [](const LinkImpl* link) { return not link->is_on(); });
 
+  const std::vector<LinkImpl*>& back_route =
+      cfg_crosstraffic ? routes.get(dst->pimpl_netpoint, src->pimpl_netpoint, back_route_storage).links : no_route;
   if (cfg_crosstraffic) {
-    dst->route_to(src, back_route, nullptr);
     if (not failed)
       failed =
           std::any_of(back_route.begin(), back_route.end(), [](const LinkImpl* link) { return not link->is_on(); });
   }
 
-  NetworkCm02Action *action = new NetworkCm02Action(this, size, failed);
+  NetworkCm02Action *action = new (this) NetworkCm02Action(this, size, failed);
   action->sharing_penalty_  = latency;
   action->latency_ = latency;
   action->rate_ = rate;
@@ -209,6 +278,40 @@ Action* NetworkCm02Model::communicate(s4u::Host* src, s4u::Host* dst, double siz
   action->latency_ *= get_latency_factor(size);
   action->rate_ = get_bandwidth_constraint(action->rate_, bandwidth_bound, size);
 
+  double variable_bound;
+  if (action->rate_ < 0)
+    variable_bound = (action->lat_current_ > 0) ? cfg_tcp_gamma / (2.0 * action->lat_current_) : -1.0;
+  else
+    variable_bound = (action->lat_current_ > 0) ? std::min(action->rate_, cfg_tcp_gamma / (2.0 * action->lat_current_))
+                                                : action->rate_;
+
+  /* Small messages may bypass the sharing system: they last their latency plus their size over the rate that they
+   * would get alone. Wifi links are not concerned, as their bandwidth depends on the hosts. */
+  if (size < analytic_thresh_ && not failed &&
+      std::none_of(route.begin(), route.end(), [](LinkImpl* const& link) {
+        return link->get_sharing_policy() == s4u::Link::SharingPolicy::WIFI;
+      })) {
+    double lone_rate = get_lone_rate(route, back_route, variable_bound);
+    if (lone_rate < 0) // no link and no bound, as with vivaldi: only the latency counts
+      lone_rate = std::numeric_limits<double>::infinity();
+    if (lone_rate > 0) {
+      action->analytic_           = true;
+      action->analytic_rate_      = lone_rate;
+      action->analytic_time_left_ = action->latency_ + size / lone_rate;
+      action->latency_            = 0.0;
+      analytic_communications_++;
+      XBT_DEBUG("Action %p of %g bytes is analytic: it lasts %g seconds", action, size, action->analytic_time_left_);
+      if (get_update_algorithm() == Model::UpdateAlgo::LAZY)
+        action->schedule_analytic_end();
+      else
+        invalidate_next_event();
+      XBT_OUT();
+
+      simgrid::s4u::Link::on_communicate(*action, src, dst);
+      return action;
+    }
+  }
+
   size_t constraints_per_variable = route.size();
   constraints_per_variable += back_route.size();
 
@@ -226,15 +329,7 @@ Action* NetworkCm02Model::communicate(s4u::Host* src, s4u::Host* dst, double siz
   } else
     action->set_variable(get_maxmin_system()->variable_new(action, 1.0, -1.0, constraints_per_variable));
 
-  if (action->rate_ < 0) {
-    get_maxmin_system()->update_variable_bound(
-        action->get_variable(), (action->lat_current_ > 0) ? cfg_tcp_gamma / (2.0 * action->lat_current_) : -1.0);
-  } else {
-    get_maxmin_system()->update_variable_bound(
-        action->get_variable(), (action->lat_current_ > 0)
-                                    ? std::min(action->rate_, cfg_tcp_gamma / (2.0 * action->lat_current_))
-                                    : action->rate_);
-  }
+  get_maxmin_system()->update_variable_bound(action->get_variable(), variable_bound);
 
   for (auto const& link : route) {
     // Handle WIFI links
@@ -357,6 +452,7 @@ void NetworkCm02Link::set_latency(double value)
   int numelem                  = 0;
 
   latency_.peak = value;
+  routing::RouteMemo::invalidate_all(); // the cached routes include the latency of their links
 
   while ((var = get_constraint()->get_variable_safe(&elem, &nextelem, &numelem))) {
     NetworkCm02Action* action = static_cast<NetworkCm02Action*>(var->get_id());
@@ -423,6 +519,82 @@ s4u::Link::SharingPolicy NetworkWifiLink::get_sharing_policy()
  * Action *
  **********/
 
+void NetworkCm02Action::update_analytic_time_left(double delta)
+{
+  double_update(&analytic_time_left_, delta, sg_surf_precision);
+  /* The bytes only flow once the latency is paid, at the end of the communication */
+  set_remains(analytic_time_left_ > 0 ? std::min(get_cost(), analytic_rate_ * analytic_time_left_) : 0.0);
+}
+
+/* Inserts a running analytic communication in the heap of its (lazy) model, at the date of its end or at the end of
+ * its max duration if it comes first */
+void NetworkCm02Action::schedule_analytic_end()
+{
+  double duration       = analytic_time_left_;
+  ActionHeap::Type type = ActionHeap::Type::normal;
+  if (get_max_duration() != NO_MAX_DURATION && get_max_duration() < duration) {
+    duration = get_max_duration();
+    type     = ActionHeap::Type::max_duration;
+  }
+  get_model()->get_action_heap().insert(this, get_last_update() + duration, type);
+}
+
+void NetworkCm02Action::suspend()
+{
+  if (not is_analytic()) {
+    NetworkAction::suspend();
+    return;
+  }
+  if (not is_running())
+    return;
+  if (get_model()->get_update_algorithm() == Model::UpdateAlgo::LAZY) {
+    update_remains_lazy(surf_get_clock());
+    get_model()->get_action_heap().remove(this);
+  }
+  set_suspend_state(Action::SuspendStates::SUSPENDED);
+  get_model()->invalidate_next_event();
+}
+
+void NetworkCm02Action::resume()
+{
+  if (not is_analytic()) {
+    NetworkAction::resume();
+    return;
+  }
+  if (not is_suspended())
+    return;
+  set_suspend_state(Action::SuspendStates::RUNNING);
+  if (get_model()->get_update_algorithm() == Model::UpdateAlgo::LAZY) {
+    set_last_update();
+    schedule_analytic_end();
+  }
+  get_model()->invalidate_next_event();
+}
+
+void NetworkCm02Action::set_max_duration(double duration)
+{
+  if (not is_analytic()) {
+    NetworkAction::set_max_duration(duration);
+    return;
+  }
+  bool lazy = get_model()->get_update_algorithm() == Model::UpdateAlgo::LAZY;
+  if (lazy)
+    update_remains_lazy(surf_get_clock());
+  Action::set_max_duration(duration); // removes the action from the heap of lazy models
+  if (lazy && is_running())
+    schedule_analytic_end();
+}
+
+void NetworkCm02Action::set_sharing_penalty(double sharing_penalty)
+{
+  if (not is_analytic()) {
+    NetworkAction::set_sharing_penalty(sharing_penalty);
+    return;
+  }
+  /* The analytic communications do not share the links, so their penalty does not change their end */
+  set_sharing_penalty_no_update(sharing_penalty);
+}
+
 void NetworkCm02Action::update_remains_lazy(double now)
 {
   if (not is_running())
@@ -430,6 +602,15 @@ void NetworkCm02Action::update_remains_lazy(double now)
 
   double delta = now - get_last_update();
 
+  if (is_analytic()) {
+    if (get_finish_time() < 0) { // finished actions keep the remains set by finish(), even at their max duration
+      update_analytic_time_left(delta);
+      update_max_duration(delta);
+    }
+    set_last_update();
+    return;
+  }
+
   if (get_remains_no_update() > 0) {
     XBT_DEBUG("Updating action(%p): remains was %f, last_update was: %f", this, get_remains_no_update(),
               get_last_update());
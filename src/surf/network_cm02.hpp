@@ -36,7 +36,21 @@ public:
                         s4u::Link::SharingPolicy policy) override;
   void update_actions_state_lazy(double now, double delta) override;
   void update_actions_state_full(double now, double delta) override;
+  bool next_occuring_event_is_cacheable() override { return true; }
+  bool is_independent() override { return true; }
   Action* communicate(s4u::Host* src, s4u::Host* dst, double size, double rate) override;
+  double next_occuring_event_full(double now) override;
+  ModelStatistics get_statistics() const override;
+
+protected:
+  /** @brief Size under which the communications are simulated analytically (see network/analytic-thresh) */
+  double analytic_thresh_;
+
+private:
+  double get_lone_rate(const std::vector<LinkImpl*>& route, const std::vector<LinkImpl*>& back_route,
+                       double bound) const;
+
+  unsigned long long analytic_communications_ = 0;
 };
 
 /************
@@ -80,6 +94,27 @@ public:
   NetworkCm02Action(Model* model, double cost, bool failed) : NetworkAction(model, cost, failed){};
   virtual ~NetworkCm02Action() = default;
   void update_remains_lazy(double now) override;
+  void suspend() override;
+  void resume() override;
+  void set_max_duration(double duration) override;
+  void set_sharing_penalty(double sharing_penalty) override;
+
+  /** @brief Whether this communication is simulated analytically, without any variable in the sharing system
+   *
+   * Such a communication lasts its latency plus its size over the rate that it would get alone on its route. It is not
+   * slowed down by the other communications, and does not slow them down either.
+   */
+  bool is_analytic() const { return analytic_; }
+  /** @brief Time until the end of an analytic communication (not counting the time spent suspended) */
+  double get_analytic_time_left() const { return analytic_time_left_; }
+  void update_analytic_time_left(double delta);
+
+private:
+  void schedule_analytic_end();
+
+  bool analytic_             = false;
+  double analytic_rate_      = 0.0;
+  double analytic_time_left_ = 0.0;
 };
 }
 }
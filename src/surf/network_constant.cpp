@@ -72,7 +72,7 @@ void NetworkConstantModel::update_actions_state(double /*now*/, double delta)
 
 Action* NetworkConstantModel::communicate(s4u::Host* src, s4u::Host* dst, double size, double)
 {
-  NetworkConstantAction* action = new NetworkConstantAction(this, size, sg_latency_factor);
+  NetworkConstantAction* action = new (this) NetworkConstantAction(this, size, sg_latency_factor);
 
   s4u::Link::on_communicate(*action, src, dst);
   return action;
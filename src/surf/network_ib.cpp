@@ -85,6 +85,9 @@ NetworkIBModel::NetworkIBModel() : NetworkSmpiModel()
 {
   /* Do not add this into all_existing_models: our ancestor already does so */
 
+  /* The penalties of this model are applied to the variables of the communications, that all need one */
+  analytic_thresh_ = 0;
+
   std::string IB_factors_string = config::get_value<std::string>("smpi/IB-penalty-factors");
   std::vector<std::string> radical_elements;
   boost::split(radical_elements, IB_factors_string, boost::is_any_of(";"));
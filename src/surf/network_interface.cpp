@@ -185,6 +185,8 @@ void NetworkAction::set_state(Action::State state)
 std::list<LinkImpl*> NetworkAction::links() const
 {
   std::list<LinkImpl*> retlist;
+  if (get_variable() == nullptr) // analytic communications use no link of the sharing system
+    return retlist;
   int llen = get_variable()->get_number_of_constraint();
 
   for (int i = 0; i < llen; i++) {
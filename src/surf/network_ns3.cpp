@@ -182,7 +182,7 @@ LinkImpl* NetworkNS3Model::create_link(const std::string& name, const std::vecto
 
 Action* NetworkNS3Model::communicate(s4u::Host* src, s4u::Host* dst, double size, double rate)
 {
-  return new NetworkNS3Action(this, size, src, dst);
+  return new (this) NetworkNS3Action(this, size, src, dst);
 }
 
 double NetworkNS3Model::next_occuring_event(double now)
@@ -5,9 +5,12 @@
 
 #include "ptask_L07.hpp"
 #include "src/kernel/resource/profile/Event.hpp"
+#include "src/kernel/routing/RouteMemo.hpp"
 #include "surf/surf.hpp"
 #include "xbt/config.hpp"
 
+#include <boost/functional/hash.hpp>
+#include <unordered_map>
 #include <unordered_set>
 
 XBT_LOG_EXTERNAL_DEFAULT_CATEGORY(surf_host);
@@ -137,44 +140,66 @@ kernel::resource::CpuAction* HostL07Model::execute_parallel(const std::vector<s4
                                                             const double* flops_amount, const double* bytes_amount,
                                                             double rate)
 {
-  return new L07Action(this, host_list, flops_amount, bytes_amount, rate);
+  /* Only keep the non-empty cells of the matrix, in the order of the rows */
+  std::vector<s4u::ParallelTransfer> transfers;
+  if (bytes_amount != nullptr) {
+    size_t host_nb = host_list.size();
+    for (size_t k = 0; k < host_nb * host_nb; k++)
+      if (bytes_amount[k] > 0.0)
+        transfers.push_back({k / host_nb, k % host_nb, bytes_amount[k]});
+  }
+  return new (this) L07Action(this, host_list, flops_amount, transfers, rate);
+}
+
+kernel::resource::CpuAction* HostL07Model::execute_parallel(const std::vector<s4u::Host*>& host_list,
+                                                            const double* flops_amount,
+                                                            const std::vector<s4u::ParallelTransfer>& transfers,
+                                                            double rate)
+{
+  return new (this) L07Action(this, host_list, flops_amount, transfers, rate);
 }
 
 L07Action::L07Action(kernel::resource::Model* model, const std::vector<s4u::Host*>& host_list,
-                     const double* flops_amount, const double* bytes_amount, double rate)
-    : CpuAction(model, 1, 0), computationAmount_(flops_amount), communicationAmount_(bytes_amount), rate_(rate)
+                     const double* flops_amount, const std::vector<s4u::ParallelTransfer>& transfers, double rate)
+    : CpuAction(model, 1, 0), hostList_(host_list), rate_(rate)
 {
-  size_t link_nb      = 0;
   size_t used_host_nb = 0; /* Only the hosts with something to compute (>0 flops) are counted) */
   double latency = 0.0;
   this->set_last_update();
 
-  hostList_.insert(hostList_.end(), host_list.begin(), host_list.end());
-
   if (flops_amount != nullptr)
     used_host_nb += std::count_if(flops_amount, flops_amount + host_list.size(), [](double x) { return x > 0.0; });
 
-  /* Compute the number of affected resources... */
-  if(bytes_amount != nullptr) {
-    std::unordered_set<const char*> affected_links;
-
-    for (size_t k = 0; k < host_list.size() * host_list.size(); k++) {
-      if (bytes_amount[k] <= 0)
-        continue;
-
-      double lat = 0.0;
-      std::vector<kernel::resource::LinkImpl*> route;
-      hostList_[k / host_list.size()]->route_to(hostList_[k % host_list.size()], route, &lat);
-      latency = std::max(latency, lat);
-
-      for (auto const& link : route)
-        affected_links.insert(link->get_cname());
+  /* Group the transfers by pair of hosts, so that each route is only computed once */
+  std::unordered_map<std::pair<s4u::Host*, s4u::Host*>, size_t, boost::hash<std::pair<s4u::Host*, s4u::Host*>>>
+      flow_ids;
+  std::vector<double> flow_bytes;
+  for (s4u::ParallelTransfer const& transfer : transfers) {
+    if (transfer.bytes <= 0.0)
+      continue;
+    auto elm = flow_ids.emplace(std::make_pair(hostList_[transfer.src], hostList_[transfer.dst]), flows_.size());
+    if (elm.second) {
+      flows_.push_back({hostList_[transfer.src], hostList_[transfer.dst], transfer.bytes, 0.0});
+      flow_bytes.push_back(transfer.bytes);
+    } else {
+      Flow& flow     = flows_[elm.first->second];
+      flow.max_bytes = std::max(flow.max_bytes, transfer.bytes);
+      flow_bytes[elm.first->second] += transfer.bytes;
     }
+  }
 
-    link_nb = affected_links.size();
+  /* Compute the number of affected resources... */
+  std::vector<std::vector<kernel::resource::LinkImpl*>> routes(flows_.size());
+  std::unordered_set<kernel::resource::LinkImpl*> affected_links;
+  for (size_t i = 0; i < flows_.size(); i++) {
+    flows_[i].src->route_to(flows_[i].dst, routes[i], &flows_[i].latency);
+    latency = std::max(latency, flows_[i].latency);
+    affected_links.insert(routes[i].begin(), routes[i].end());
   }
+  size_t link_nb = affected_links.size();
 
-  XBT_DEBUG("Creating a parallel task (%p) with %zu hosts and %zu unique links.", this, host_list.size(), link_nb);
+  XBT_DEBUG("Creating a parallel task (%p) with %zu hosts, %zu flows and %zu unique links.", this, host_list.size(),
+            flows_.size(), link_nb);
   latency_ = latency;
 
   set_variable(
@@ -189,17 +214,9 @@ L07Action::L07Action(kernel::resource::Model* model, const std::vector<s4u::Host
     model->get_maxmin_system()->expand(host_list[i]->pimpl_cpu->get_constraint(), get_variable(),
                                        (flops_amount == nullptr ? 0.0 : flops_amount[i]));
 
-  if (bytes_amount != nullptr) {
-    for (size_t k = 0; k < host_list.size() * host_list.size(); k++) {
-      if (bytes_amount[k] <= 0.0)
-        continue;
-      std::vector<kernel::resource::LinkImpl*> route;
-      hostList_[k / host_list.size()]->route_to(hostList_[k % host_list.size()], route, nullptr);
-
-      for (auto const& link : route)
-        model->get_maxmin_system()->expand_add(link->get_constraint(), this->get_variable(), bytes_amount[k]);
-    }
-  }
+  for (size_t i = 0; i < flows_.size(); i++)
+    for (auto const& link : routes[i])
+      model->get_maxmin_system()->expand_add(link->get_constraint(), this->get_variable(), flow_bytes[i]);
 
   if (link_nb + used_host_nb == 0) {
     this->set_cost(1.0);
@@ -210,14 +227,9 @@ L07Action::L07Action(kernel::resource::Model* model, const std::vector<s4u::Host
 kernel::resource::Action* NetworkL07Model::communicate(s4u::Host* src, s4u::Host* dst, double size, double rate)
 {
   std::vector<s4u::Host*> host_list = {src, dst};
-  double* flops_amount = new double[2]();
-  double* bytes_amount = new double[4]();
+  std::vector<s4u::ParallelTransfer> transfers = {{0, 1, size}};
 
-  bytes_amount[1] = size;
-
-  kernel::resource::Action* res = hostModel_->execute_parallel(host_list, flops_amount, bytes_amount, rate);
-  static_cast<L07Action*>(res)->free_arrays_ = true;
-  return res;
+  return hostModel_->execute_parallel(host_list, nullptr, transfers, rate);
 }
 
 kernel::resource::Cpu* CpuL07Model::create_cpu(s4u::Host* host, const std::vector<double>& speed_per_pstate, int core)
@@ -261,13 +273,7 @@ kernel::resource::CpuAction* CpuL07::execution_start(double size)
 {
   std::vector<s4u::Host*> host_list = {get_host()};
 
-  double* flops_amount = new double[host_list.size()]();
-  flops_amount[0] = size;
-
-  kernel::resource::CpuAction* res =
-      static_cast<CpuL07Model*>(get_model())->hostModel_->execute_parallel(host_list, flops_amount, nullptr, -1);
-  static_cast<L07Action*>(res)->free_arrays_ = true;
-  return res;
+  return static_cast<CpuL07Model*>(get_model())->hostModel_->execute_parallel(host_list, &size, nullptr, -1);
 }
 
 kernel::resource::CpuAction* CpuL07::sleep(double duration)
@@ -367,8 +373,10 @@ void LinkL07::set_latency(double value)
   const kernel::lmm::Element* elem = nullptr;
 
   latency_.peak = value;
+  kernel::routing::RouteMemo::invalidate_all(); // the memoized routes include the latency of their links
   while ((var = get_constraint()->get_variable(&elem))) {
     action = static_cast<L07Action*>(var->get_id());
+    action->update_latencies();
     action->updateBound();
   }
 }
@@ -378,34 +386,22 @@ LinkL07::~LinkL07() = default;
  * Action *
  **********/
 
-L07Action::~L07Action()
+L07Action::~L07Action() = default;
+
+void L07Action::update_latencies()
 {
-  if (free_arrays_) {
-    delete[] computationAmount_;
-    delete[] communicationAmount_;
+  for (Flow& flow : flows_) {
+    std::vector<kernel::resource::LinkImpl*> route;
+    flow.latency = 0.0;
+    flow.src->route_to(flow.dst, route, &flow.latency);
   }
 }
 
 void L07Action::updateBound()
 {
   double lat_current = 0.0;
-
-  size_t host_count = hostList_.size();
-
-  if (communicationAmount_ != nullptr) {
-    for (size_t i = 0; i < host_count; i++) {
-      for (size_t j = 0; j < host_count; j++) {
-
-        if (communicationAmount_[i * host_count + j] > 0) {
-          double lat = 0.0;
-          std::vector<kernel::resource::LinkImpl*> route;
-          hostList_.at(i)->route_to(hostList_.at(j), route, &lat);
-
-          lat_current = std::max(lat_current, lat * communicationAmount_[i * host_count + j]);
-        }
-      }
-    }
-  }
+  for (Flow const& flow : flows_)
+    lat_current = std::max(lat_current, flow.latency * flow.max_bytes);
   double lat_bound = kernel::resource::NetworkModel::cfg_tcp_gamma / (2.0 * lat_current);
   XBT_DEBUG("action (%p) : lat_bound = %g", this, lat_bound);
   if ((latency_ <= 0.0) && is_running()) {
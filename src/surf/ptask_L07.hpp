@@ -44,6 +44,9 @@ public:
   void update_actions_state(double now, double delta) override;
   kernel::resource::CpuAction* execute_parallel(const std::vector<s4u::Host*>& host_list, const double* flops_amount,
                                                 const double* bytes_amount, double rate) override;
+  kernel::resource::CpuAction* execute_parallel(const std::vector<s4u::Host*>& host_list, const double* flops_amount,
+                                                const std::vector<s4u::ParallelTransfer>& transfers,
+                                                double rate) override;
 };
 
 class CpuL07Model : public kernel::resource::CpuModel {
@@ -112,32 +115,31 @@ public:
  * Action *
  **********/
 class L07Action : public kernel::resource::CpuAction {
-  friend CpuAction* CpuL07::execution_start(double size);
-  friend CpuAction* CpuL07::sleep(double duration);
-  friend CpuAction* HostL07Model::execute_parallel(const std::vector<s4u::Host*>& host_list, const double* flops_amount,
-                                                   const double* bytes_amount, double rate);
-  friend Action* NetworkL07Model::communicate(s4u::Host* src, s4u::Host* dst, double size, double rate);
-
 public:
+  /** The amounts of flops are only read by the constructor, while the transfers are grouped by pair of hosts */
   L07Action(kernel::resource::Model* model, const std::vector<s4u::Host*>& host_list, const double* flops_amount,
-            const double* bytes_amount, double rate);
+            const std::vector<s4u::ParallelTransfer>& transfers, double rate);
   L07Action(const L07Action&) = delete;
   L07Action& operator=(const L07Action&) = delete;
   ~L07Action();
 
   void updateBound();
+  /** @brief Recompute the latency of the routes, after a change of latency of one of their links */
+  void update_latencies();
 
   std::vector<s4u::Host*> hostList_;
-  const double* computationAmount_;   /* pointer to the data that lives in s4u action -- do not free unless if
-                                       * free_arrays */
-  const double* communicationAmount_; /* pointer to the data that lives in s4u action -- do not free unless if
-                                       * free_arrays */
   double latency_;
   double rate_;
 
 private:
-  bool free_arrays_ = false; // By default, computationAmount_ and friends are freed by caller. But not for sequential
-                             // exec and regular comms
+  /* The transfers between a given pair of hosts, that share a single route */
+  struct Flow {
+    s4u::Host* src;
+    s4u::Host* dst;
+    double max_bytes; // the largest of these transfers, that bounds the rate with the latency
+    double latency;   // of the route
+  };
+  std::vector<Flow> flows_;
 };
 
 } // namespace surf
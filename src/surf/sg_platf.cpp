@@ -18,6 +18,7 @@
 #include "simgrid/s4u/Engine.hpp"
 #include "src/include/simgrid/sg_config.hpp"
 #include "src/include/surf/surf.hpp"
+#include "src/instr/instr_private.hpp"
 #include "src/kernel/EngineImpl.hpp"
 #include "src/kernel/resource/profile/Profile.hpp"
 #include "src/simix/smx_private.hpp"
@@ -138,6 +139,92 @@ void sg_platf_new_link(simgrid::kernel::routing::LinkCreationArgs* link)
   delete link->properties;
 }
 
+/** @brief Add a node to a cluster: its host, its private links and the links of its topology */
+void sg_platf_new_cluster_node(simgrid::kernel::routing::ClusterZone* current_as,
+                               simgrid::kernel::routing::ClusterCreationArgs* cluster, int radical, int rank)
+{
+  using simgrid::kernel::routing::FatTreeZone;
+
+  /* The lazy nodes are created once the platform is parsed, so they have to be created in their own zone */
+  simgrid::kernel::routing::NetZoneImpl* parsed_zone = current_routing;
+  current_routing                                    = current_as;
+
+  std::string host_id = std::string(cluster->prefix) + std::to_string(radical) + cluster->suffix;
+  std::string link_id = std::string(cluster->id) + "_link_" + std::to_string(radical);
+
+  XBT_DEBUG("<host\tid=\"%s\"\tpower=\"%f\">", host_id.c_str(), cluster->speeds.front());
+
+  simgrid::kernel::routing::HostCreationArgs host;
+  host.id = host_id.c_str();
+  if ((cluster->properties != nullptr) && (not cluster->properties->empty())) {
+    host.properties = new std::unordered_map<std::string, std::string>;
+
+    for (auto const& elm : *cluster->properties)
+      host.properties->insert({elm.first, elm.second});
+  }
+
+  host.speed_per_pstate = cluster->speeds;
+  host.pstate = 0;
+  host.core_amount = cluster->core_amount;
+  host.coord = "";
+  sg_platf_new_host(&host);
+  XBT_DEBUG("</host>");
+
+  XBT_DEBUG("<link\tid=\"%s\"\tbw=\"%f\"\tlat=\"%f\"/>", link_id.c_str(), cluster->bw, cluster->lat);
+
+  // All links are saved in a matrix;
+  // every row describes a single node; every node may have multiple links.
+  // the first column may store a link from x to x if p_has_loopback is set
+  // the second column may store a limiter link if p_has_limiter is set
+  // other columns are to store one or more link for the node
+
+  //add a loopback link
+  simgrid::s4u::Link* linkUp   = nullptr;
+  simgrid::s4u::Link* linkDown = nullptr;
+  if(cluster->loopback_bw > 0 || cluster->loopback_lat > 0){
+    std::string tmp_link = link_id + "_loopback";
+    XBT_DEBUG("<loopback\tid=\"%s\"\tbw=\"%f\"/>", tmp_link.c_str(), cluster->loopback_bw);
+
+    simgrid::kernel::routing::LinkCreationArgs link;
+    link.id        = tmp_link;
+    link.bandwidths.push_back(cluster->loopback_bw);
+    link.latency   = cluster->loopback_lat;
+    link.policy    = simgrid::s4u::Link::SharingPolicy::FATPIPE;
+    sg_platf_new_link(&link);
+    linkUp   = simgrid::s4u::Link::by_name_or_null(tmp_link);
+    linkDown = simgrid::s4u::Link::by_name_or_null(tmp_link);
+
+    current_as->add_private_link_at(current_as->node_pos(rank), {linkUp->get_impl(), linkDown->get_impl()});
+  }
+
+  //add a limiter link (shared link to account for maximal bandwidth of the node)
+  linkUp   = nullptr;
+  linkDown = nullptr;
+  if(cluster->limiter_link > 0){
+    std::string tmp_link = std::string(link_id) + "_limiter";
+    XBT_DEBUG("<limiter\tid=\"%s\"\tbw=\"%f\"/>", tmp_link.c_str(), cluster->limiter_link);
+
+    simgrid::kernel::routing::LinkCreationArgs link;
+    link.id        = tmp_link;
+    link.bandwidths.push_back(cluster->limiter_link);
+    link.latency = 0;
+    link.policy    = simgrid::s4u::Link::SharingPolicy::SHARED;
+    sg_platf_new_link(&link);
+    linkDown = simgrid::s4u::Link::by_name_or_null(tmp_link);
+    linkUp   = linkDown;
+    current_as->add_private_link_at(current_as->node_pos_with_loopback(rank),
+                                    {linkUp->get_impl(), linkDown->get_impl()});
+  }
+
+  //call the cluster function that adds the others links
+  if (cluster->topology == simgrid::kernel::routing::ClusterTopology::FAT_TREE) {
+    static_cast<FatTreeZone*>(current_as)->add_processing_node(radical);
+  } else {
+    current_as->create_links_for_node(cluster, radical, rank, current_as->node_pos_with_loopback_limiter(rank));
+  }
+  current_routing = parsed_zone;
+}
+
 void sg_platf_new_cluster(simgrid::kernel::routing::ClusterCreationArgs* cluster)
 {
   using simgrid::kernel::routing::ClusterZone;
@@ -181,82 +268,14 @@ void sg_platf_new_cluster(simgrid::kernel::routing::ClusterCreationArgs* cluster
     current_as->has_limiter_ = true;
   }
 
-  for (int const& i : *cluster->radicals) {
-    std::string host_id = std::string(cluster->prefix) + std::to_string(i) + cluster->suffix;
-    std::string link_id = std::string(cluster->id) + "_link_" + std::to_string(i);
-
-    XBT_DEBUG("<host\tid=\"%s\"\tpower=\"%f\">", host_id.c_str(), cluster->speeds.front());
-
-    simgrid::kernel::routing::HostCreationArgs host;
-    host.id = host_id.c_str();
-    if ((cluster->properties != nullptr) && (not cluster->properties->empty())) {
-      host.properties = new std::unordered_map<std::string, std::string>;
-
-      for (auto const& elm : *cluster->properties)
-        host.properties->insert({elm.first, elm.second});
-    }
-
-    host.speed_per_pstate = cluster->speeds;
-    host.pstate = 0;
-    host.core_amount = cluster->core_amount;
-    host.coord = "";
-    sg_platf_new_host(&host);
-    XBT_DEBUG("</host>");
-
-    XBT_DEBUG("<link\tid=\"%s\"\tbw=\"%f\"\tlat=\"%f\"/>", link_id.c_str(), cluster->bw, cluster->lat);
-
-    // All links are saved in a matrix;
-    // every row describes a single node; every node may have multiple links.
-    // the first column may store a link from x to x if p_has_loopback is set
-    // the second column may store a limiter link if p_has_limiter is set
-    // other columns are to store one or more link for the node
-
-    //add a loopback link
-    simgrid::s4u::Link* linkUp   = nullptr;
-    simgrid::s4u::Link* linkDown = nullptr;
-    if(cluster->loopback_bw > 0 || cluster->loopback_lat > 0){
-      std::string tmp_link = link_id + "_loopback";
-      XBT_DEBUG("<loopback\tid=\"%s\"\tbw=\"%f\"/>", tmp_link.c_str(), cluster->loopback_bw);
-
-      simgrid::kernel::routing::LinkCreationArgs link;
-      link.id        = tmp_link;
-      link.bandwidths.push_back(cluster->loopback_bw);
-      link.latency   = cluster->loopback_lat;
-      link.policy    = simgrid::s4u::Link::SharingPolicy::FATPIPE;
-      sg_platf_new_link(&link);
-      linkUp   = simgrid::s4u::Link::by_name_or_null(tmp_link);
-      linkDown = simgrid::s4u::Link::by_name_or_null(tmp_link);
-
-      auto* as_cluster = static_cast<ClusterZone*>(current_as);
-      as_cluster->private_links_.insert({as_cluster->node_pos(rankId), {linkUp->get_impl(), linkDown->get_impl()}});
-    }
-
-    //add a limiter link (shared link to account for maximal bandwidth of the node)
-    linkUp   = nullptr;
-    linkDown = nullptr;
-    if(cluster->limiter_link > 0){
-      std::string tmp_link = std::string(link_id) + "_limiter";
-      XBT_DEBUG("<limiter\tid=\"%s\"\tbw=\"%f\"/>", tmp_link.c_str(), cluster->limiter_link);
-
-      simgrid::kernel::routing::LinkCreationArgs link;
-      link.id        = tmp_link;
-      link.bandwidths.push_back(cluster->limiter_link);
-      link.latency = 0;
-      link.policy    = simgrid::s4u::Link::SharingPolicy::SHARED;
-      sg_platf_new_link(&link);
-      linkDown = simgrid::s4u::Link::by_name_or_null(tmp_link);
-      linkUp   = linkDown;
-      current_as->private_links_.insert(
-          {current_as->node_pos_with_loopback(rankId), {linkUp->get_impl(), linkDown->get_impl()}});
-    }
-
-    //call the cluster function that adds the others links
-    if (cluster->topology == simgrid::kernel::routing::ClusterTopology::FAT_TREE) {
-      static_cast<FatTreeZone*>(current_as)->add_processing_node(i);
-    } else {
-      current_as->create_links_for_node(cluster, i, rankId, current_as->node_pos_with_loopback_limiter(rankId));
+  if (sg_lazy_clusters && cluster->topology == simgrid::kernel::routing::ClusterTopology::FLAT &&
+      not TRACE_is_enabled()) {
+    current_as->set_lazy_nodes(cluster);
+  } else {
+    for (int const& i : *cluster->radicals) {
+      sg_platf_new_cluster_node(current_as, cluster, i, rankId);
+      rankId++;
     }
-    rankId++;
   }
   delete cluster->properties;
 
@@ -631,6 +650,7 @@ void sg_platf_new_Zone_seal()
 {
   xbt_assert(current_routing, "Cannot seal the current AS: none under construction");
   current_routing->seal();
+  simgrid::kernel::routing::RouteMemo::invalidate_all();
   simgrid::s4u::NetZone::on_seal(*current_routing->get_iface());
   current_routing = static_cast<simgrid::kernel::routing::NetZoneImpl*>(current_routing->get_father());
 }
@@ -651,11 +671,11 @@ void sg_platf_new_hostlink(simgrid::kernel::routing::HostLinkCreationArgs* hostl
 
   auto* as_cluster = static_cast<simgrid::kernel::routing::ClusterZone*>(current_routing);
 
-  if (as_cluster->private_links_.find(netpoint->id()) != as_cluster->private_links_.end())
+  if (as_cluster->private_link_exists_at(netpoint->id()))
     surf_parse_error(std::string("Host_link for '") + hostlink->id.c_str() + "' is already defined!");
 
   XBT_DEBUG("Push Host_link for host '%s' to position %u", netpoint->get_cname(), netpoint->id());
-  as_cluster->private_links_.insert({netpoint->id(), {linkUp->get_impl(), linkDown->get_impl()}});
+  as_cluster->add_private_link_at(netpoint->id(), {linkUp->get_impl(), linkDown->get_impl()});
 }
 
 void sg_platf_new_trace(simgrid::kernel::routing::ProfileCreationArgs* profile)
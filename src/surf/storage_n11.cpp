@@ -101,17 +101,17 @@ StorageN11::StorageN11(StorageModel* model, const std::string& name, lmm::System
 
 StorageAction* StorageN11::io_start(sg_size_t size, s4u::Io::OpType type)
 {
-  return new StorageN11Action(get_model(), size, not is_on(), this, type);
+  return new (get_model()) StorageN11Action(get_model(), size, not is_on(), this, type);
 }
 
 StorageAction* StorageN11::read(sg_size_t size)
 {
-  return new StorageN11Action(get_model(), size, not is_on(), this, s4u::Io::OpType::READ);
+  return new (get_model()) StorageN11Action(get_model(), size, not is_on(), this, s4u::Io::OpType::READ);
 }
 
 StorageAction* StorageN11::write(sg_size_t size)
 {
-  return new StorageN11Action(get_model(), size, not is_on(), this, s4u::Io::OpType::WRITE);
+  return new (get_model()) StorageN11Action(get_model(), size, not is_on(), this, s4u::Io::OpType::WRITE);
 }
 
 /**********
@@ -33,6 +33,7 @@ public:
                              const std::string& attach) override;
   double next_occuring_event(double now) override;
   void update_actions_state(double now, double delta) override;
+  bool is_independent() override { return true; }
 };
 
 /************
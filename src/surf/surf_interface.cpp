@@ -9,7 +9,9 @@
 #include "simgrid/sg_config.hpp"
 #include "src/kernel/resource/profile/FutureEvtSet.hpp"
 #include "src/kernel/resource/profile/Profile.hpp"
+#include "src/include/xbt/parmap.hpp"
 #include "src/simgrid/version.h"
+#include "src/simix/smx_private.hpp"
 #include "src/surf/HostImpl.hpp"
 #include "src/surf/xml/platf.hpp"
 #include "surf/surf.hpp"
@@ -24,6 +26,13 @@
 
 XBT_LOG_NEW_CATEGORY(surf, "All SURF categories");
 XBT_LOG_NEW_DEFAULT_SUBCATEGORY(surf_kernel, surf, "Logging specific to SURF (kernel)");
+XBT_LOG_EXTERNAL_CATEGORY(surf_cpu);
+XBT_LOG_EXTERNAL_CATEGORY(surf_cpu_cas);
+XBT_LOG_EXTERNAL_CATEGORY(surf_network);
+XBT_LOG_EXTERNAL_CATEGORY(surf_storage);
+XBT_LOG_EXTERNAL_CATEGORY(surf_maxmin);
+XBT_LOG_EXTERNAL_CATEGORY(resource);
+XBT_LOG_EXTERNAL_CATEGORY(resource_heap);
 
 /*********
  * Utils *
@@ -39,6 +48,84 @@ extern std::map<std::string, simgrid::kernel::resource::StorageType*> storage_ty
 
 std::vector<surf_model_description_t>* surf_plugin_description = nullptr;
 
+int sg_surf_model_threads = 1; /* Change this with --cfg=surf/model-threads:VALUE */
+static std::unique_ptr<simgrid::xbt::Parmap<std::size_t>> models_parmap;
+
+namespace simgrid {
+namespace surf {
+
+/* Whether the debug messages of the independent models are shown. The categories of every independent model must be
+ * checked here, as well as the ones of the code that they all share (actions, heaps and lmm systems). */
+static bool models_debug_enabled()
+{
+  return XBT_LOG_ISENABLED(surf_kernel, xbt_log_priority_debug) ||
+         XBT_LOG_ISENABLED(surf_cpu, xbt_log_priority_debug) ||
+         XBT_LOG_ISENABLED(surf_cpu_cas, xbt_log_priority_debug) ||
+         XBT_LOG_ISENABLED(surf_network, xbt_log_priority_debug) ||
+         XBT_LOG_ISENABLED(surf_storage, xbt_log_priority_debug) ||
+         XBT_LOG_ISENABLED(surf_maxmin, xbt_log_priority_debug) ||
+         XBT_LOG_ISENABLED(resource, xbt_log_priority_debug) ||
+         XBT_LOG_ISENABLED(resource_heap, xbt_log_priority_debug);
+}
+
+/* Returns the positions of the models to handle on the worker threads, if any */
+static std::vector<std::size_t> independent_models(const std::vector<kernel::resource::Model*>& models)
+{
+  std::vector<std::size_t> res;
+  // Logging is not thread-safe, so only go parallel when nobody watches the details. The workers also need contexts.
+  if (sg_surf_model_threads <= 1 || simix_global == nullptr || not simix_global->context_factory ||
+      models_debug_enabled())
+    return res;
+
+  for (std::size_t i = 0; i < models.size(); i++)
+    if (models[i]->is_independent())
+      res.push_back(i);
+  if (res.size() < 2) {
+    res.clear();
+    return res;
+  }
+  if (not models_parmap)
+    models_parmap.reset(new xbt::Parmap<std::size_t>(sg_surf_model_threads, XBT_PARMAP_DEFAULT));
+  for (std::size_t i : res)
+    models[i]->defer_state_changes();
+  return res;
+}
+
+std::vector<double> poll_next_occuring_events(const std::vector<kernel::resource::Model*>& models, double now)
+{
+  std::vector<double> res(models.size());
+  std::vector<std::size_t> parallel = independent_models(models);
+  if (not parallel.empty())
+    models_parmap->apply([&models, &res, now](std::size_t i) { res[i] = models[i]->poll_next_occuring_event(now); },
+                         parallel);
+
+  for (std::size_t i = 0; i < models.size(); i++) {
+    if (models[i]->is_deferring_state_changes())
+      models[i]->apply_deferred_state_changes();
+    else
+      res[i] = models[i]->poll_next_occuring_event(now);
+  }
+  return res;
+}
+
+void poll_update_actions_states(const std::vector<kernel::resource::Model*>& models, double now, double delta)
+{
+  std::vector<std::size_t> parallel = independent_models(models);
+  if (not parallel.empty())
+    models_parmap->apply([&models, now, delta](std::size_t i) { models[i]->poll_update_actions_state(now, delta); },
+                         parallel);
+
+  for (kernel::resource::Model* model : models) {
+    if (model->is_deferring_state_changes())
+      model->apply_deferred_state_changes();
+    else
+      model->poll_update_actions_state(now, delta);
+  }
+}
+
+} // namespace surf
+} // namespace simgrid
+
 static void XBT_ATTRIB_DESTRUCTOR(800) simgrid_free_plugin_description()
 {
   delete surf_plugin_description;
@@ -146,6 +233,7 @@ std::ifstream* surf_ifsopen(const std::string& name)
   std::ifstream* fs = new std::ifstream();
   if (is_absolute_file_path(name)) { /* don't mess with absolute file names */
     fs->open(name.c_str(), std::ifstream::in);
+    return fs;
   }
 
   /* search relative files in the path */
@@ -311,6 +399,7 @@ void surf_exit()
     delete stype;
   }
 
+  models_parmap.reset();
   for (auto const& model : all_existing_models)
     delete model;
 
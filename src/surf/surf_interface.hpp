@@ -23,6 +23,14 @@
 XBT_PUBLIC_DATA double sg_maxmin_precision;
 XBT_PUBLIC_DATA double sg_surf_precision;
 XBT_PUBLIC_DATA int sg_concurrency_limit;
+XBT_PUBLIC_DATA bool sg_maxmin_components;
+XBT_PUBLIC_DATA int sg_maxmin_threads;
+XBT_PUBLIC_DATA int sg_surf_model_threads;
+XBT_PUBLIC_DATA int sg_routing_threads;
+XBT_PUBLIC_DATA bool sg_dijkstra_precompute;
+XBT_PUBLIC_DATA int sg_dijkstra_cache_size;
+XBT_PUBLIC_DATA int sg_route_cache_size;
+XBT_PUBLIC_DATA bool sg_lazy_clusters;
 
 extern XBT_PRIVATE double sg_latency_factor;
 extern XBT_PRIVATE double sg_bandwidth_factor;
@@ -53,6 +61,22 @@ static inline int double_equals(double value1, double value2, double precision)
   return (fabs(value1 - value2) < precision);
 }
 
+namespace simgrid {
+namespace surf {
+/** @brief Poll the next event of these models (see Model::poll_next_occuring_event()), in that order
+ *
+ * With surf/model-threads, the independent models are polled on worker threads first. The state changes of the
+ * actions that finish meanwhile are then applied in the order of the models, so that the result does not depend on
+ * the amount of threads.
+ */
+XBT_PRIVATE std::vector<double> poll_next_occuring_events(const std::vector<kernel::resource::Model*>& models,
+                                                          double now);
+/** @brief Update these models (see Model::poll_update_actions_state()), in that order, possibly on worker threads */
+XBT_PRIVATE void poll_update_actions_states(const std::vector<kernel::resource::Model*>& models, double now,
+                                            double delta);
+} // namespace surf
+} // namespace simgrid
+
 /** @ingroup SURF_models
  *  @brief Initializes the CPU model with the model Cas01
  *
@@ -195,6 +195,9 @@ XBT_PUBLIC void sg_platf_new_link(simgrid::kernel::routing::LinkCreationArgs* li
 XBT_PUBLIC void sg_platf_new_peer(simgrid::kernel::routing::PeerCreationArgs* peer);          // Add a peer      to the current Zone
 XBT_PUBLIC void sg_platf_new_cluster(simgrid::kernel::routing::ClusterCreationArgs* clust);   // Add a cluster   to the current Zone
 XBT_PUBLIC void sg_platf_new_cabinet(simgrid::kernel::routing::CabinetCreationArgs* cabinet); // Add a cabinet   to the current Zone
+XBT_PRIVATE void sg_platf_new_cluster_node(simgrid::kernel::routing::ClusterZone* zone, // Add a node to that cluster
+                                           simgrid::kernel::routing::ClusterCreationArgs* cluster, int radical,
+                                           int rank);
 XBT_PUBLIC simgrid::kernel::routing::NetPoint* // Add a router    to the current Zone
     sg_platf_new_router(const std::string&, const char* coords);
 
@@ -0,0 +1,150 @@
+/* slab_arena - recycle fixed-size blocks carved out of large slabs          */
+
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#include "xbt/slab_arena.hpp"
+#include "simgrid/config.h"
+#include "simgrid/modelchecker.h" /* bypass the arenas when model-checking, as the mallocators */
+#include "xbt/log.h"
+
+#include <algorithm>
+#include <new>
+
+XBT_LOG_NEW_DEFAULT_SUBCATEGORY(xbt_arena, xbt, "Slab arenas");
+
+namespace simgrid {
+namespace xbt {
+
+namespace {
+/* Precedes every block. The free blocks are chained through it, while the allocated ones point to their size class. */
+union alignas(std::max_align_t) BlockHeader {
+  void* size_class;
+  BlockHeader* next_free;
+};
+
+constexpr std::size_t max_slab_blocks = 65536;
+} // namespace
+
+class SlabArena::SizeClass {
+public:
+  SizeClass(SlabArena* arena, std::size_t block_size) : arena_(arena), block_size_(block_size) {}
+  SizeClass(const SizeClass&) = delete;
+  SizeClass& operator=(const SizeClass&) = delete;
+  ~SizeClass()
+  {
+    for (void* slab : slabs_)
+      ::operator delete(slab);
+  }
+
+  BlockHeader* get()
+  {
+    if (free_ == nullptr)
+      grow();
+    BlockHeader* header = free_;
+    free_               = header->next_free;
+    header->size_class  = this;
+    arena_->occupancy_.used++;
+    arena_->occupancy_.peak = std::max(arena_->occupancy_.peak, arena_->occupancy_.used);
+    return header;
+  }
+
+  void release(BlockHeader* header)
+  {
+    header->next_free = free_;
+    free_             = header;
+    if (arena_ != nullptr)
+      arena_->occupancy_.used--;
+  }
+
+  SlabArena* arena_;             // nullptr once the arena is gone
+  const std::size_t block_size_; // header included, 0 for the blocks allocated outside of the slabs
+
+private:
+  /* Add a slab as large as all the previous ones together, and thread its blocks into the free list */
+  void grow()
+  {
+    std::size_t blocks = std::min(std::max(arena_->initial_blocks_, capacity_), max_slab_blocks);
+    auto* slab         = static_cast<unsigned char*>(::operator new(blocks * block_size_));
+    XBT_DEBUG("Arena '%s': new slab of %zu blocks of %zu bytes", arena_->name_.c_str(), blocks, block_size_);
+    slabs_.push_back(slab);
+    for (std::size_t i = blocks; i-- > 0;) {
+      auto* header      = reinterpret_cast<BlockHeader*>(slab + i * block_size_);
+      header->next_free = free_;
+      free_             = header;
+    }
+    capacity_ += blocks;
+    arena_->occupancy_.slabs++;
+    arena_->occupancy_.bytes += blocks * block_size_;
+    arena_->occupancy_.capacity += blocks;
+  }
+
+  std::size_t capacity_ = 0;
+  BlockHeader* free_    = nullptr;
+  std::vector<void*> slabs_;
+};
+
+SlabArena::SlabArena(const std::string& name, std::size_t initial_blocks)
+    : name_(name), initial_blocks_(std::max<std::size_t>(initial_blocks, 1)), outside_(new SizeClass(this, 0))
+{
+}
+
+SlabArena::~SlabArena()
+{
+  if (occupancy_.used > 0 || occupancy_.outside > 0) {
+    /* Some blocks are still in use, and may be released later on: keep their slabs and size classes alive */
+    XBT_DEBUG("Arena '%s' destroyed while %zu blocks are still in use. Leaking them.", name_.c_str(),
+              occupancy_.used + occupancy_.outside);
+    for (auto& size_class : size_classes_)
+      if (size_class) {
+        size_class->arena_ = nullptr;
+        size_class.release();
+      }
+    outside_->arena_ = nullptr;
+    outside_.release();
+  }
+}
+
+void* SlabArena::allocate(std::size_t size)
+{
+  std::size_t index      = (size + 2 * sizeof(BlockHeader) - 1) / sizeof(BlockHeader);
+  std::size_t block_size = index * sizeof(BlockHeader);
+  BlockHeader* header;
+  if (not SIMGRID_HAVE_MALLOCATOR || MC_is_active() || block_size > max_block_size + sizeof(BlockHeader)) {
+    header             = static_cast<BlockHeader*>(::operator new(block_size));
+    header->size_class = outside_.get();
+    occupancy_.outside++;
+  } else {
+    if (index >= size_classes_.size())
+      size_classes_.resize(index + 1);
+    if (not size_classes_[index])
+      size_classes_[index].reset(new SizeClass(this, block_size));
+    header = size_classes_[index]->get();
+  }
+  return header + 1;
+}
+
+void SlabArena::deallocate(void* block)
+{
+  if (block == nullptr)
+    return;
+  BlockHeader* header   = static_cast<BlockHeader*>(block) - 1;
+  SizeClass* size_class = static_cast<SizeClass*>(header->size_class);
+  if (size_class->block_size_ == 0) {
+    if (size_class->arena_ != nullptr)
+      size_class->arena_->occupancy_.outside--;
+    ::operator delete(header);
+  } else {
+    size_class->release(header);
+  }
+}
+
+ArenaOccupancy SlabArena::get_occupancy() const
+{
+  return occupancy_;
+}
+
+} // namespace xbt
+} // namespace simgrid
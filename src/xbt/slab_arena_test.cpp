@@ -0,0 +1,82 @@
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#include "xbt/slab_arena.hpp"
+
+#include "catch.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+TEST_CASE("xbt::SlabArena: recycling fixed-size blocks", "[xbt-slab-arena]")
+{
+  SECTION("Blocks are recycled through the free list")
+  {
+    simgrid::xbt::SlabArena arena("test", 4);
+    void* first = arena.allocate(40);
+    std::memset(first, 0x5a, 40);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(first) % alignof(std::max_align_t) == 0);
+    simgrid::xbt::SlabArena::deallocate(first);
+    REQUIRE(arena.allocate(40) == first);
+    REQUIRE(arena.allocate(33) != first); // same size class, but the first block is in use
+    auto occupancy = arena.get_occupancy();
+    REQUIRE(occupancy.slabs == 1);
+    REQUIRE(occupancy.capacity == 4);
+    REQUIRE(occupancy.used == 2);
+    REQUIRE(occupancy.peak == 2);
+  }
+
+  SECTION("Slabs follow the peak of allocated blocks")
+  {
+    simgrid::xbt::SlabArena arena("test", 4);
+    std::vector<void*> blocks;
+    for (int i = 0; i < 100; i++)
+      blocks.push_back(arena.allocate(24));
+    auto occupancy = arena.get_occupancy();
+    REQUIRE(occupancy.used == 100);
+    REQUIRE(occupancy.capacity >= 100);
+    REQUIRE(occupancy.capacity < 200);
+    REQUIRE(occupancy.slabs == 6); // 4, 4, 8, 16, 32, 64
+
+    for (void* block : blocks)
+      simgrid::xbt::SlabArena::deallocate(block);
+    occupancy = arena.get_occupancy();
+    REQUIRE(occupancy.used == 0);
+    REQUIRE(occupancy.peak == 100);
+
+    // No new slab is needed to reach the same peak again
+    for (int i = 0; i < 100; i++)
+      blocks[i] = arena.allocate(24);
+    REQUIRE(arena.get_occupancy().slabs == 6);
+    for (void* block : blocks)
+      simgrid::xbt::SlabArena::deallocate(block);
+  }
+
+  SECTION("Large blocks are allocated outside of the slabs")
+  {
+    simgrid::xbt::SlabArena arena("test");
+    void* block = arena.allocate(simgrid::xbt::SlabArena::max_block_size + 1);
+    REQUIRE(arena.get_occupancy().outside == 1);
+    REQUIRE(arena.get_occupancy().slabs == 0);
+    simgrid::xbt::SlabArena::deallocate(block);
+    REQUIRE(arena.get_occupancy().outside == 0);
+  }
+
+  SECTION("Containers can be allocated in an arena")
+  {
+    simgrid::xbt::SlabArena arena("test");
+    {
+      std::vector<double, simgrid::xbt::ArenaAllocator<double>> values(
+          (simgrid::xbt::ArenaAllocator<double>(arena)));
+      values.reserve(10);
+      for (int i = 0; i < 10; i++)
+        values.push_back(i);
+      REQUIRE(values[9] == 9.0);
+      REQUIRE(arena.get_occupancy().used == 1);
+    }
+    REQUIRE(arena.get_occupancy().used == 0);
+  }
+}
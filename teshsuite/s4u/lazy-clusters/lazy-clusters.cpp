@@ -0,0 +1,71 @@
+/* Checks that the nodes of the lazy clusters are only created when they are used */
+
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+/* A sender exchanges messages with two nodes of a cluster, and looks for a third one. With routing/lazy-clusters, only the nodes that get
+ * actors are created, and the others are created when they are retrieved by name or listed. The communication times
+ * must not depend on that option. */
+
+#include "simgrid/s4u.hpp"
+
+#include <string>
+#include <vector>
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(lazy_clusters, "Messages specific for this test");
+
+static const std::vector<std::string> peers = {"node-1.simgrid.org", "node-42.simgrid.org"};
+static int created_hosts                    = 0;
+static int created_links                    = 0;
+
+static void receiver()
+{
+  simgrid::s4u::Mailbox::by_name(simgrid::s4u::this_actor::get_host()->get_name())->get();
+}
+
+static void sender()
+{
+  static int payload = 42;
+  for (std::string const& peer : peers) {
+    double start = simgrid::s4u::Engine::get_clock();
+    simgrid::s4u::Mailbox::by_name(peer)->put(&payload, 1e6);
+    XBT_INFO("Sent to %s in %f", peer.c_str(), simgrid::s4u::Engine::get_clock() - start);
+  }
+  /* The lazy nodes retrieved by the actors are created by the maestro */
+  XBT_INFO("node-99.simgrid.org computes %.0f flops per second",
+           simgrid::s4u::Host::by_name("node-99.simgrid.org")->get_speed());
+}
+
+static void report(const char* step)
+{
+  XBT_INFO("%s: %d hosts and %d links created", step, created_hosts, created_links);
+}
+
+int main(int argc, char* argv[])
+{
+  simgrid::s4u::Engine e(&argc, argv);
+  xbt_assert(argc == 2, "Usage: %s platform_file\n", argv[0]);
+  simgrid::s4u::Host::on_creation.connect([](simgrid::s4u::Host&) { created_hosts++; });
+  simgrid::s4u::Link::on_creation.connect([](simgrid::s4u::Link&) { created_links++; });
+
+  e.load_platform(argv[1]);
+  XBT_INFO("The platform has %zu hosts", e.get_host_count());
+  report("Platform loaded");
+
+  simgrid::s4u::Actor::create("sender", simgrid::s4u::Host::by_name("node-0.simgrid.org"), sender);
+  for (std::string const& peer : peers)
+    simgrid::s4u::Actor::create("receiver", simgrid::s4u::Host::by_name(peer), receiver);
+  report("Actors placed");
+  e.run();
+
+  simgrid::s4u::Link* link = simgrid::s4u::Link::by_name("cluster0_link_7_DOWN");
+  XBT_INFO("Link %s: latency %f", link->get_cname(), link->get_latency());
+  xbt_assert(simgrid::s4u::Host::by_name_or_null("node-100.simgrid.org") == nullptr, "node-100 should not exist");
+  report("Link retrieved");
+
+  XBT_INFO("Listed %zu hosts", e.get_all_hosts().size());
+  report("Hosts listed");
+  return 0;
+}
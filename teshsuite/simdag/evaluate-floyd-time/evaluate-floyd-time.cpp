@@ -0,0 +1,112 @@
+/* Measures the time needed to load a platform with a large Floyd zone */
+
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+/* The generated zone links each host to the next one, and to a pseudo-random other host. Most of the time goes into
+ * the computation of the shortest paths when the zone gets sealed. Run it with several values of
+ * --cfg=routing/threads: the checksum of the routes must not change.
+ */
+
+#include "simgrid/s4u.hpp"
+#include "xbt/xbt_os_time.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(evaluate_floyd_time, "Messages specific for this benchmark");
+
+static int usage(const char* name)
+{
+  fprintf(stderr,
+          "Usage: %s [--hosts n] [--time]\n"
+          "  Loads a Floyd zone of n hosts (default: 300), and displays a checksum of its routes.\n"
+          "  The loading time is only displayed with --time, as it depends on the machine.\n",
+          name);
+  return 2;
+}
+
+/* Writes the platform in a temporary file, and returns its name */
+static std::string write_platform(int nb_hosts)
+{
+  char filename[] = "/tmp/evaluate-floyd-time-XXXXXX";
+  int fd          = mkstemp(filename);
+  xbt_assert(fd >= 0, "Cannot create a temporary file");
+  FILE* file = fdopen(fd, "w");
+
+  fprintf(file, "<?xml version='1.0'?>\n<!DOCTYPE platform SYSTEM \"https://simgrid.org/simgrid.dtd\">\n"
+                "<platform version=\"4.1\">\n<zone id=\"floyd\" routing=\"Floyd\">\n");
+  for (int i = 0; i < nb_hosts; i++)
+    fprintf(file, "  <host id=\"host%d\" speed=\"1Gf\"/>\n", i);
+
+  std::set<std::pair<int, int>> edges;
+  for (int i = 0; i < nb_hosts; i++)
+    for (int j : {(i + 1) % nb_hosts, (i * 7 + 3) % nb_hosts})
+      if (i != j)
+        edges.insert(std::make_pair(std::min(i, j), std::max(i, j)));
+  for (unsigned link = 0; link < edges.size(); link++)
+    fprintf(file, "  <link id=\"link%u\" bandwidth=\"1GBps\" latency=\"10us\"/>\n", link);
+  unsigned link = 0;
+  for (auto const& edge : edges)
+    fprintf(file, "  <route src=\"host%d\" dst=\"host%d\"><link_ctn id=\"link%u\"/></route>\n", edge.first,
+            edge.second, link++);
+  fprintf(file, "</zone>\n</platform>\n");
+  fclose(file);
+  return filename;
+}
+
+int main(int argc, char* argv[])
+{
+  simgrid::s4u::Engine e(&argc, argv);
+
+  int nb_hosts   = 300;
+  bool with_time = false;
+  for (int i = 1; i < argc; i++) {
+    if (not strcmp(argv[i], "--hosts") && i + 1 < argc)
+      nb_hosts = atoi(argv[++i]);
+    else if (not strcmp(argv[i], "--time"))
+      with_time = true;
+    else
+      return usage(argv[0]);
+  }
+  if (nb_hosts < 2)
+    return usage(argv[0]);
+
+  std::string platform = write_platform(nb_hosts);
+  xbt_os_timer_t timer = xbt_os_timer_new();
+  xbt_os_walltimer_start(timer);
+  e.load_platform(platform);
+  xbt_os_walltimer_stop(timer);
+  unlink(platform.c_str());
+
+  /* Checksum the routes, to make sure that they do not depend on the way they are computed */
+  std::vector<simgrid::s4u::Host*> hosts = e.get_all_hosts();
+  std::uint64_t checksum = 14695981039346656037ULL; // FNV-1a of the link names, route after route
+  std::size_t hops       = 0;
+  for (simgrid::s4u::Host* src : hosts)
+    for (simgrid::s4u::Host* dst : hosts) {
+      std::vector<simgrid::s4u::Link*> links;
+      src->route_to(dst, links, nullptr);
+      hops += links.size();
+      for (simgrid::s4u::Link* l : links)
+        for (char c : l->get_name() + ";")
+          checksum = (checksum ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+
+  XBT_INFO("Floyd zone of %zu hosts and %zu links: %zu hops in total, route checksum %016llx", hosts.size(),
+           e.get_link_count(), hops, static_cast<unsigned long long>(checksum));
+  if (with_time)
+    printf("Loaded in %f seconds\n", xbt_os_timer_elapsed(timer));
+  xbt_os_timer_free(timer);
+  return 0;
+}
@@ -0,0 +1,127 @@
+/* Measures the time needed to compute the routes within the Fat-Tree, Torus and Dragonfly clusters */
+
+/* Copyright (c) 2008-2019. The SimGrid Team. All rights reserved.          */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+/* The generated platform holds a cluster of each topology, with 256 hosts each by default. The routes between all pairs
+ * of hosts of each cluster are computed several times, as in a simulation asking for the same routes over and over.
+ * The checksum of the routes does not depend on the amount of rounds.
+ */
+
+#include "simgrid/s4u.hpp"
+#include "xbt/xbt_os_time.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(evaluate_get_route_time, "Messages specific for this benchmark");
+
+static int usage(const char* name)
+{
+  fprintf(stderr,
+          "Usage: %s [--scale n] [--rounds r] [--time]\n"
+          "  Computes r times (default: 1) the routes between all hosts of a Fat-Tree, a Torus and a Dragonfly\n"
+          "  cluster of 256*n^2 hosts each (default: n=1), and displays a checksum of these routes.\n"
+          "  The computation time is only displayed with --time, as it depends on the machine.\n",
+          name);
+  return 2;
+}
+
+/* Writes the platform in a temporary file, and returns its name */
+static std::string write_platform(int scale)
+{
+  char filename[] = "/tmp/evaluate-get-route-time-XXXXXX";
+  int fd          = mkstemp(filename);
+  xbt_assert(fd >= 0, "Cannot create a temporary file");
+  FILE* file = fdopen(fd, "w");
+
+  /* 16n*16n hosts in a 2-level fat tree; 4*8n*8n in a torus; 4n groups of 4 chassis of 4n blades of 4 nodes */
+  fprintf(file, "<?xml version='1.0'?>\n<!DOCTYPE platform SYSTEM \"https://simgrid.org/simgrid.dtd\">\n"
+                "<platform version=\"4.1\">\n<zone id=\"world\" routing=\"Full\">\n");
+  fprintf(file,
+          "  <cluster id=\"FAT_TREE\" prefix=\"fat-tree-\" suffix=\"\" radical=\"0-%d\" speed=\"1Gf\" bw=\"125MBps\" "
+          "lat=\"50us\" topology=\"FAT_TREE\" topo_parameters=\"2;%d,%d;1,%d;1,1\"/>\n",
+          256 * scale * scale - 1, 16 * scale, 16 * scale, 4 * scale);
+  fprintf(file,
+          "  <cluster id=\"TORUS\" prefix=\"torus-\" suffix=\"\" radical=\"0-%d\" speed=\"1Gf\" bw=\"125MBps\" "
+          "lat=\"50us\" topology=\"TORUS\" topo_parameters=\"4,%d,%d\"/>\n",
+          256 * scale * scale - 1, 8 * scale, 8 * scale);
+  fprintf(file,
+          "  <cluster id=\"DRAGONFLY\" prefix=\"dragonfly-\" suffix=\"\" radical=\"0-%d\" speed=\"1Gf\" bw=\"125MBps\" "
+          "lat=\"50us\" topology=\"DRAGONFLY\" topo_parameters=\"%d,1;4,1;%d,1;4\"/>\n",
+          256 * scale * scale - 1, 4 * scale, 4 * scale);
+  fprintf(file, "</zone>\n</platform>\n");
+  fclose(file);
+  return filename;
+}
+
+int main(int argc, char* argv[])
+{
+  simgrid::s4u::Engine e(&argc, argv);
+
+  int scale      = 1;
+  int rounds     = 1;
+  bool with_time = false;
+  for (int i = 1; i < argc; i++) {
+    if (not strcmp(argv[i], "--scale") && i + 1 < argc)
+      scale = atoi(argv[++i]);
+    else if (not strcmp(argv[i], "--rounds") && i + 1 < argc)
+      rounds = atoi(argv[++i]);
+    else if (not strcmp(argv[i], "--time"))
+      with_time = true;
+    else
+      return usage(argv[0]);
+  }
+  if (scale < 1 || rounds < 1)
+    return usage(argv[0]);
+
+  std::string platform = write_platform(scale);
+  e.load_platform(platform);
+  unlink(platform.c_str());
+
+  xbt_os_timer_t timer = xbt_os_timer_new();
+  for (const char* topology : {"FAT_TREE", "TORUS", "DRAGONFLY"}) {
+    std::vector<simgrid::s4u::Host*> hosts = e.netzone_by_name_or_null(topology)->get_all_hosts();
+    std::uint64_t checksum = 14695981039346656037ULL; // FNV-1a of the link names, route after route
+    std::size_t hops       = 0;
+    std::vector<simgrid::s4u::Link*> links;
+    double elapsed = 0;
+
+    for (int round = 0; round < rounds; round++) {
+      xbt_os_walltimer_start(timer);
+      for (simgrid::s4u::Host* src : hosts)
+        for (simgrid::s4u::Host* dst : hosts) {
+          links.clear();
+          src->route_to(dst, links, nullptr);
+          if (round == 0)
+            hops += links.size();
+        }
+      xbt_os_walltimer_stop(timer);
+      elapsed += xbt_os_timer_elapsed(timer);
+    }
+
+    /* Checksum the routes outside of the timed part, that must only measure the route computations */
+    for (simgrid::s4u::Host* src : hosts)
+      for (simgrid::s4u::Host* dst : hosts) {
+        links.clear();
+        src->route_to(dst, links, nullptr);
+        for (simgrid::s4u::Link* l : links)
+          for (char c : l->get_name() + ";")
+            checksum = (checksum ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+      }
+
+    XBT_INFO("%s cluster of %zu hosts: %zu hops in total, route checksum %016llx", topology, hosts.size(), hops,
+             static_cast<unsigned long long>(checksum));
+    if (with_time)
+      printf("%s routes computed %d times in %f seconds\n", topology, rounds, elapsed);
+  }
+  xbt_os_timer_free(timer);
+  return 0;
+}
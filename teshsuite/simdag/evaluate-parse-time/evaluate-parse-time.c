@@ -4,31 +4,101 @@
  * under the terms of the license (GNU LGPL) which comes with this package. */
 
 //teshsuite/simdag/platforms/evaluate_parse_time ../examples/platforms/nancy.xml
+//teshsuite/simdag/platforms/evaluate_parse_time --floyd-cache ../examples/platforms/nancy.xml
 
+#include <dirent.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "simgrid/simdag.h"
 #include "xbt/xbt_os_time.h"
 
-int main(int argc, char **argv)
+/* Returns the CPU time spent in the creation of the environment */
+static double timed_environment(const char* platform)
 {
   xbt_os_timer_t timer = xbt_os_timer_new();
+  xbt_os_cputimer_start(timer);
+  SD_create_environment(platform);
+  xbt_os_cputimer_stop(timer);
+
+  double elapsed = xbt_os_timer_elapsed(timer);
+  free(timer);
+  return elapsed;
+}
+
+/* Creates the environment in a child process, with the Floyd zones using the cache of that directory */
+static int timed_environment_with_cache(const char* name, const char* platform, const char* dir, const char* label)
+{
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    return 0;
+  }
+  if (pid == 0) {
+    char option[1024];
+    snprintf(option, sizeof option, "--cfg=routing/floyd-cache:%s", dir);
+    char* args[] = {(char*)name, option, NULL};
+    int nb_args  = 2;
+    SD_init(&nb_args, args);
+    double elapsed = timed_environment(platform);
+    printf("%s: %f\n", label, elapsed);
+    printf("Workstation number: %zu, link number: %d\n", sg_host_count(), sg_link_count());
+    fflush(stdout);
+    _exit(0);
+  }
+  int status;
+  return waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/* Loads the platform twice with a new Floyd cache: the first (cold) load computes and saves the shortest paths of the
+ * Floyd zones, while the second (warm) one loads them from the cache. Only the Floyd zones are cached: the platform
+ * file is parsed both times. */
+static int compare_floyd_cache(const char* name, const char* platform)
+{
+  char dir[] = "/tmp/evaluate-parse-time-XXXXXX";
+  if (mkdtemp(dir) == NULL) {
+    perror("mkdtemp");
+    return 1;
+  }
+  int ok = timed_environment_with_cache(name, platform, dir, "Cold load (computing the Floyd shortest paths)") &&
+           timed_environment_with_cache(name, platform, dir, "Warm load (from the Floyd cache)");
+
+  DIR* entries = opendir(dir);
+  if (entries != NULL) {
+    const struct dirent* entry;
+    while ((entry = readdir(entries)) != NULL) {
+      char path[sizeof dir + 256];
+      snprintf(path, sizeof path, "%s/%s", dir, entry->d_name);
+      if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, ".."))
+        unlink(path);
+    }
+    closedir(entries);
+  }
+  rmdir(dir);
+  return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc > 2 && !strcmp(argv[1], "--floyd-cache"))
+    return compare_floyd_cache(argv[0], argv[2]);
+
   SD_init(&argc, argv);
 
   /* creation of the environment, timed */
-  xbt_os_cputimer_start(timer);
-  SD_create_environment(argv[1]);
-  xbt_os_cputimer_stop(timer);
+  double elapsed = timed_environment(argv[1]);
 
   /* Display the result and exit after cleanup */
-  printf( "%f\n", xbt_os_timer_elapsed(timer) );
+  printf("%f\n", elapsed);
   printf("Workstation number: %zu, link number: %d\n", sg_host_count(), sg_link_count());
   if(argv[2]){
     printf("Wait for %ss\n",argv[2]);
     xbt_os_sleep(atoi(argv[2]));
   }
 
-
-  free(timer);
   return 0;
 }
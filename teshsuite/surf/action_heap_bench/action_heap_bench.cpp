@@ -0,0 +1,280 @@
+/* Replays the action heap operations recorded during real simulations */
+
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+/* The traces are the debug logs of the resource_heap category, as produced by:
+ *   ./my_simulator platform.xml deployment.xml --log=resource_heap.thres:debug --log=resource_heap.fmt:%m%n
+ * Each line names a heap, an operation and an action, and the date for insertions and updates. Any other line is
+ * ignored, so the whole output of the simulation can be used as a trace.
+ *
+ * Every trace is replayed on the ActionHeap of this build (4-ary heap or boost pairing heap, see enable_dary_heap) and
+ * on a plain boost pairing heap, that is the reference implementation. Both must pop the actions that were popped
+ * during the recorded run, in the same order. With --copies, several copies of the trace are interleaved on the same
+ * heaps, to get much larger heaps than the recorded ones.
+ */
+
+#include "simgrid/kernel/resource/Action.hpp"
+#include "simgrid/kernel/resource/Model.hpp"
+#include "simgrid/s4u/Engine.hpp"
+#include "xbt/utility.hpp"
+#include "xbt/xbt_os_time.h"
+
+#include <boost/heap/pairing_heap.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace resource = simgrid::kernel::resource;
+
+struct Operation {
+  enum class Kind { insert, update, remove, pop } kind;
+  int heap;
+  int action;
+  double date;
+};
+
+struct Trace {
+  std::vector<Operation> operations;
+  int heaps   = 0;
+  int actions = 0;
+};
+
+static bool load_trace(const std::string& filename, Trace& trace)
+{
+  std::ifstream in(filename);
+  if (not in.is_open()) {
+    fprintf(stderr, "Cannot open %s\n", filename.c_str());
+    return false;
+  }
+  std::unordered_map<std::string, int> heaps;
+  std::unordered_map<std::string, int> actions; // actions of different heaps may share an address, after a free
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream words(line);
+    std::string heap;
+    std::string kind;
+    std::string action;
+    std::string date;
+    if (not(words >> heap >> kind >> action) || heap.compare(0, 2, "0x") || action.compare(0, 2, "0x"))
+      continue;
+    Operation op;
+    if (kind == "insert")
+      op.kind = Operation::Kind::insert;
+    else if (kind == "update")
+      op.kind = Operation::Kind::update;
+    else if (kind == "remove")
+      op.kind = Operation::Kind::remove;
+    else if (kind == "pop")
+      op.kind = Operation::Kind::pop;
+    else
+      continue;
+    op.date = 0.0;
+    if (op.kind == Operation::Kind::insert || op.kind == Operation::Kind::update) {
+      if (not(words >> date))
+        continue;
+      op.date = std::strtod(date.c_str(), nullptr); // the dates are in hexadecimal, so that they are exact
+    }
+    op.heap   = heaps.emplace(heap, heaps.size()).first->second;
+    op.action = actions.emplace(heap + " " + action, actions.size()).first->second;
+    trace.operations.push_back(op);
+  }
+  trace.heaps   = heaps.size();
+  trace.actions = actions.size();
+  return true;
+}
+
+/* What a replay found: the recorded pops that were not reproduced are mismatches */
+struct Replay {
+  size_t operations = 0;
+  size_t max_size   = 0;
+  size_t mismatches = 0;
+  double time       = 0.0;
+};
+
+class TraceAction : public resource::Action {
+public:
+  explicit TraceAction(resource::Model* model) : Action(model, 1.0, false) {}
+  void update_remains_lazy(double) override {}
+};
+
+/* The ActionHeap of this build, used with actual actions */
+static Replay replay_action_heap(const Trace& trace, int copies)
+{
+  std::vector<std::unique_ptr<resource::Model>> models;
+  for (int i = 0; i < trace.heaps; i++)
+    models.emplace_back(new resource::Model(resource::Model::UpdateAlgo::LAZY));
+  std::vector<std::unique_ptr<TraceAction>> actions;
+  std::vector<int> heap_of(trace.actions);
+  for (Operation const& op : trace.operations)
+    heap_of[op.action] = op.heap;
+  for (int copy = 0; copy < copies; copy++)
+    for (int action = 0; action < trace.actions; action++) {
+      resource::Model* model = models[heap_of[action]].get();
+      actions.emplace_back(new (model) TraceAction(model));
+    }
+  std::vector<size_t> sizes(trace.heaps);
+
+  Replay replay;
+  double start = xbt_os_time();
+  for (Operation const& op : trace.operations) {
+    resource::ActionHeap& heap = models[op.heap]->get_action_heap();
+    for (int copy = 0; copy < copies; copy++) {
+      TraceAction* action = actions[copy * trace.actions + op.action].get();
+      switch (op.kind) {
+        case Operation::Kind::insert:
+          heap.insert(action, op.date, resource::ActionHeap::Type::normal);
+          sizes[op.heap]++;
+          break;
+        case Operation::Kind::update:
+          if (action->get_type() == resource::ActionHeap::Type::unset)
+            sizes[op.heap]++;
+          heap.update(action, op.date, resource::ActionHeap::Type::normal);
+          break;
+        case Operation::Kind::remove:
+          heap.remove(action);
+          sizes[op.heap]--;
+          break;
+        case Operation::Kind::pop:
+          if (heap.empty() || heap.pop() != action) {
+            replay.mismatches++;
+          } else {
+            heap.remove(action); // pop() keeps the type of the action, that tells here whether it is queued
+            sizes[op.heap]--;
+          }
+          break;
+      }
+      replay.max_size = std::max(replay.max_size, sizes[op.heap]);
+    }
+  }
+  replay.time       = xbt_os_time() - start;
+  replay.operations = trace.operations.size() * copies;
+  return replay; // the actions leave their heap when destroyed, before their model
+}
+
+/* The reference: a stable pairing heap of (date, action rank), as ActionHeap used to be */
+static Replay replay_pairing_heap(const Trace& trace, int copies)
+{
+  typedef std::pair<double, int> element_type;
+  typedef boost::heap::pairing_heap<element_type, boost::heap::constant_time_size<false>, boost::heap::stable<true>,
+                                    boost::heap::compare<simgrid::xbt::HeapComparator<element_type>>>
+      pairing_heap;
+  std::vector<pairing_heap> heaps(trace.heaps);
+  std::vector<pairing_heap::handle_type> handles(trace.actions * copies);
+  std::vector<bool> queued(trace.actions * copies, false);
+  std::vector<size_t> sizes(trace.heaps);
+
+  Replay replay;
+  double start = xbt_os_time();
+  for (Operation const& op : trace.operations) {
+    pairing_heap& heap = heaps[op.heap];
+    for (int copy = 0; copy < copies; copy++) {
+      int action = copy * trace.actions + op.action;
+      switch (op.kind) {
+        case Operation::Kind::insert:
+          handles[action] = heap.emplace(op.date, action);
+          queued[action]  = true;
+          sizes[op.heap]++;
+          break;
+        case Operation::Kind::update:
+          if (queued[action]) {
+            heap.update(handles[action], std::make_pair(op.date, action));
+          } else {
+            handles[action] = heap.emplace(op.date, action);
+            queued[action]  = true;
+            sizes[op.heap]++;
+          }
+          break;
+        case Operation::Kind::remove:
+          heap.erase(handles[action]);
+          queued[action] = false;
+          sizes[op.heap]--;
+          break;
+        case Operation::Kind::pop:
+          if (heap.empty() || heap.top().second != action) {
+            replay.mismatches++;
+          } else {
+            heap.pop();
+            queued[action] = false;
+            sizes[op.heap]--;
+          }
+          break;
+      }
+      replay.max_size = std::max(replay.max_size, sizes[op.heap]);
+    }
+  }
+  replay.time       = xbt_os_time() - start;
+  replay.operations = trace.operations.size() * copies;
+  return replay;
+}
+
+static int usage(const char* name)
+{
+  fprintf(stderr,
+          "Usage: %s [--copies n] [--repeat n] [--time] trace...\n"
+          "  Replays n interleaved copies of each trace (default: 1), the given amount of times (default: 1).\n"
+          "  The replay times are only displayed with --time, as they depend on the machine.\n",
+          name);
+  return 2;
+}
+
+int main(int argc, char** argv)
+{
+  simgrid::s4u::Engine e(&argc, argv);
+
+  int copies     = 1;
+  int repeat     = 1;
+  bool with_time = false;
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; i++) {
+    if (not strcmp(argv[i], "--copies") && i + 1 < argc)
+      copies = std::max(1, atoi(argv[++i]));
+    else if (not strcmp(argv[i], "--repeat") && i + 1 < argc)
+      repeat = std::max(1, atoi(argv[++i]));
+    else if (not strcmp(argv[i], "--time"))
+      with_time = true;
+    else if (argv[i][0] == '-')
+      return usage(argv[0]);
+    else
+      files.push_back(argv[i]);
+  }
+  if (files.empty())
+    return usage(argv[0]);
+
+  int status = 0;
+  for (std::string const& file : files) {
+    Trace trace;
+    if (not load_trace(file, trace))
+      return 1;
+    const char* basename = strrchr(file.c_str(), '/');
+    printf("%s: %zu operations on %d heap(s) and %d action(s)\n", basename ? basename + 1 : file.c_str(),
+           trace.operations.size(), trace.heaps, trace.actions);
+
+    for (const char* name : {"pairing", "ActionHeap"}) {
+      Replay replay;
+      double time = 0.0;
+      for (int i = 0; i < repeat; i++) {
+        replay = strcmp(name, "pairing") ? replay_action_heap(trace, copies) : replay_pairing_heap(trace, copies);
+        time += replay.time;
+      }
+      printf("  %-10s %zu operations, up to %zu queued actions, %zu pop mismatch(es)", name, replay.operations,
+             replay.max_size, replay.mismatches);
+      if (with_time)
+        printf(", %.3f ns per operation", 1e9 * time / (repeat * static_cast<double>(replay.operations)));
+      printf("\n");
+      if (replay.mismatches > 0)
+        status = 1;
+    }
+  }
+  return status;
+}
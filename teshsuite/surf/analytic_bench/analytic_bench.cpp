@@ -0,0 +1,94 @@
+/* Measures how many small messages per second the network models simulate */
+
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+/* Every host of the platform sends the same amount of small messages to the next host, while receiving the messages of
+ * the previous one. Run it with and without --cfg=network/analytic-thresh to compare the speed of the simulation when
+ * the small messages share the links, and when they are simulated analytically.
+ */
+
+#include "simgrid/kernel/resource/Model.hpp"
+#include "simgrid/s4u.hpp"
+#include "xbt/xbt_os_time.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(analytic_bench, "Messages specific for this benchmark");
+
+static int nb_messages = 100;
+static double size     = 1000;
+
+static void sender(simgrid::s4u::Host* peer)
+{
+  static int payload           = 42;
+  simgrid::s4u::Mailbox* mailbox = simgrid::s4u::Mailbox::by_name(peer->get_name());
+  for (int i = 0; i < nb_messages; i++)
+    mailbox->put(&payload, size);
+}
+
+static void receiver()
+{
+  simgrid::s4u::Mailbox* mailbox = simgrid::s4u::Mailbox::by_name(simgrid::s4u::this_actor::get_host()->get_name());
+  for (int i = 0; i < nb_messages; i++)
+    mailbox->get();
+}
+
+static int usage(const char* name)
+{
+  fprintf(stderr,
+          "Usage: %s platform [--messages n] [--size bytes] [--time]\n"
+          "  Every host sends n messages (default: 100) of that size (default: 1000) to the next host.\n"
+          "  The amount of messages simulated per second is only displayed with --time, as it depends on the machine.\n",
+          name);
+  return 2;
+}
+
+int main(int argc, char* argv[])
+{
+  simgrid::s4u::Engine e(&argc, argv);
+
+  bool with_time = false;
+  std::string platform;
+  for (int i = 1; i < argc; i++) {
+    if (not strcmp(argv[i], "--messages") && i + 1 < argc)
+      nb_messages = atoi(argv[++i]);
+    else if (not strcmp(argv[i], "--size") && i + 1 < argc)
+      size = atof(argv[++i]);
+    else if (not strcmp(argv[i], "--time"))
+      with_time = true;
+    else if (argv[i][0] == '-' || not platform.empty())
+      return usage(argv[0]);
+    else
+      platform = argv[i];
+  }
+  if (platform.empty())
+    return usage(argv[0]);
+  e.load_platform(platform);
+
+  std::vector<simgrid::s4u::Host*> hosts = e.get_all_hosts();
+  for (unsigned i = 0; i < hosts.size(); i++) {
+    simgrid::s4u::Actor::create("sender", hosts[i], sender, hosts[(i + 1) % hosts.size()]);
+    simgrid::s4u::Actor::create("receiver", hosts[i], receiver);
+  }
+
+  double start = xbt_os_time();
+  e.run();
+  double elapsed = xbt_os_time() - start;
+
+  unsigned long long analytic = 0;
+  for (simgrid::kernel::resource::ModelStatistics const& stats : e.get_model_statistics())
+    analytic += stats.analytic_communications;
+  double total = static_cast<double>(nb_messages) * hosts.size();
+  XBT_INFO("%zu hosts exchanged %.0f messages of %g bytes, %llu of them analytically", hosts.size(), total, size,
+           analytic);
+  if (with_time)
+    printf("%.0f messages per second\n", total / elapsed);
+  return 0;
+}
@@ -0,0 +1,55 @@
+/* Changes the penalty and the max duration of analytic communications (see network/analytic-thresh) */
+
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#include "simgrid/host.h"
+#include "src/surf/network_interface.hpp"
+#include "src/surf/surf_interface.hpp"
+#include "surf/surf.hpp"
+#include "xbt/config.hpp"
+
+#include <map>
+#include <string>
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(surf_test, "Messages specific for surf example");
+
+int main(int argc, char** argv)
+{
+  surf_init(&argc, argv); /* Initialize some common structures */
+  simgrid::config::set_parse("network/model:CM02");
+  simgrid::config::set_parse("network/analytic-thresh:65536");
+
+  xbt_assert(argc > 1, "Usage: %s platform.xml\n", argv[0]);
+  parse_platform_file(argv[1]);
+
+  simgrid::s4u::Host* hostA = sg_host_by_name("Tremblay");
+  simgrid::s4u::Host* hostB = sg_host_by_name("Jupiter");
+
+  std::map<simgrid::kernel::resource::Action*, std::string> names;
+  names[surf_network_model->communicate(hostA, hostB, 1000.0, -1.0)] = "unchanged";
+  simgrid::kernel::resource::Action* action = surf_network_model->communicate(hostA, hostB, 1000.0, -1.0);
+  action->set_sharing_penalty(4.0);
+  names[action] = "penalty of 4";
+  action = surf_network_model->communicate(hostA, hostB, 1000.0, -1.0);
+  action->set_max_duration(1e-4);
+  names[action] = "max duration of 1e-4";
+  action = surf_network_model->communicate(hostA, hostB, 1000.0, -1.0);
+  action->set_max_duration(1.0);
+  names[action] = "max duration of 1";
+
+  surf_solve(-1.0);
+  do {
+    XBT_INFO("Next Event : %g", surf_get_clock());
+    while ((action = surf_network_model->extract_done_action()) != nullptr) {
+      XBT_INFO("   * Done Action: %s", names[action].c_str());
+      action->unref();
+    }
+  } while (not surf_network_model->get_started_action_set()->empty() && surf_solve(-1.0) >= 0.0);
+
+  XBT_INFO("Simulation Terminated with %zu communications still running",
+           surf_network_model->get_started_action_set()->size());
+  return 0;
+}
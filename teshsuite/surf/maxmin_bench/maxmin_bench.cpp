@@ -7,6 +7,8 @@
 
 #include "src/kernel/lmm/maxmin.hpp"
 #include "simgrid/msg.h"
+#include "src/surf/surf_interface.hpp"
+#include "xbt/config.hpp"
 #include "xbt/module.h"
 #include "xbt/sysdep.h" /* time manipulation for benchmarking */
 #include "xbt/xbt_os_time.h"
@@ -14,8 +16,13 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <vector>
 
 double date;
+double date_seq;
+double date_other;
+double date_conversion[2]; // of the compact backend, at the first solve and at a solve after disabling a variable
+double date_saturation[2];
 int64_t seedx = 0;
 
 static int myrand() {
@@ -34,15 +41,32 @@ static unsigned int int_random(int max)
   return static_cast<uint32_t>(float_random(max));
 }
 
-static void test(int nb_cnst, int nb_var, int nb_elem, unsigned int pw_base_limit, unsigned int pw_max_limit,
-                 float rate_no_limit, int max_share, int mode)
+/* int_random() only produces 1000 different values, which is not enough to spread the elements over the constraints of
+ * the largest classes. Keep using it for the historical classes, so that their systems remain the same. */
+static unsigned int wide_int_random(int max)
 {
-  simgrid::kernel::lmm::Constraint* cnst[nb_cnst];
-  simgrid::kernel::lmm::Variable* var[nb_var];
-  int used[nb_cnst];
+  if (max <= 20000)
+    return int_random(max);
+  return static_cast<uint32_t>((1000 * static_cast<int64_t>(myrand()) + myrand()) % max);
+}
 
+static simgrid::kernel::lmm::System* build_system(int nb_cnst, int nb_var, int nb_elem, unsigned int pw_base_limit,
+                                                  unsigned int pw_max_limit, float rate_no_limit, int max_share,
+                                                  int nb_clusters, bool compact,
+                                                  std::vector<simgrid::kernel::lmm::Constraint*>& cnst,
+                                                  std::vector<simgrid::kernel::lmm::Variable*>& var)
+{
   /* We cannot activate the selective update as we pass nullptr as an Action when creating the variables */
-  simgrid::kernel::lmm::System* Sys = new simgrid::kernel::lmm::System(false);
+  simgrid::kernel::lmm::System* Sys;
+  if (compact)
+    Sys = new simgrid::kernel::lmm::CompactSystem(false);
+  else
+    Sys = new simgrid::kernel::lmm::System(false);
+
+  cnst.resize(nb_cnst);
+  var.resize(nb_var);
+  std::vector<int> used(nb_cnst); // Reset after each variable, only where needed (see picked)
+  std::vector<int> picked;
 
   for (int i = 0; i < nb_cnst; i++) {
     cnst[i] = Sys->constraint_new(NULL, float_random(10.0));
@@ -57,16 +81,19 @@ static void test(int nb_cnst, int nb_var, int nb_elem, unsigned int pw_base_limi
     cnst[i]->set_concurrency_limit(l);
   }
 
+  // Variable i only uses the constraints of its cluster, that is the constraints k such that k%nb_clusters == i%nb_clusters
+  int cluster_size = nb_cnst / nb_clusters;
+  if (nb_elem > cluster_size)
+    nb_elem = cluster_size;
+
   for (int i = 0; i < nb_var; i++) {
     var[i] = Sys->variable_new(NULL, 1.0, -1.0, nb_elem);
     //Have a few variables with a concurrency share of two (e.g. cross-traffic in some cases)
     int concurrency_share = 1 + int_random(max_share);
     var[i]->set_concurrency_share(concurrency_share);
 
-    for (int j = 0; j < nb_cnst; j++)
-      used[j] = 0;
     for (int j = 0; j < nb_elem; j++) {
-      int k = int_random(nb_cnst);
+      int k = i % nb_clusters + nb_clusters * wide_int_random(cluster_size);
       if (used[k]>=concurrency_share) {
         j--;
         continue;
@@ -74,14 +101,86 @@ static void test(int nb_cnst, int nb_var, int nb_elem, unsigned int pw_base_limi
       Sys->expand(cnst[k], var[i], float_random(1.5));
       Sys->expand_add(cnst[k], var[i], float_random(1.5));
       used[k]++;
+      picked.push_back(k);
     }
+    for (int const& k : picked)
+      used[k] = 0;
+    picked.clear();
   }
 
+  return Sys;
+}
+
+static void test(int nb_cnst, int nb_var, int nb_elem, unsigned int pw_base_limit, unsigned int pw_max_limit,
+                 float rate_no_limit, int max_share, int mode, int nb_clusters)
+{
+  std::vector<simgrid::kernel::lmm::Constraint*> cnst;
+  std::vector<simgrid::kernel::lmm::Variable*> var;
+  int64_t seed = seedx;
+  bool compact = simgrid::config::get_value<std::string>("maxmin/backend") == "compact";
+
+  simgrid::kernel::lmm::System* Sys = build_system(nb_cnst, nb_var, nb_elem, pw_base_limit, pw_max_limit, rate_no_limit,
+                                                   max_share, nb_clusters, compact, cnst, var);
+
   fprintf(stderr,"Starting to solve(%i)\n",myrand()%1000);
   date = xbt_os_time() * 1000000;
   Sys->solve();
   date = xbt_os_time() * 1000000 - date;
 
+  if (mode == 3 && sg_maxmin_components && sg_maxmin_threads > 1 && not compact) {
+    /* Solve the very same system on a single thread, to measure the speedup and check that the result is identical */
+    std::vector<simgrid::kernel::lmm::Constraint*> cnst2;
+    std::vector<simgrid::kernel::lmm::Variable*> var2;
+    seedx = seed;
+    simgrid::kernel::lmm::System* Sys2 = build_system(nb_cnst, nb_var, nb_elem, pw_base_limit, pw_max_limit,
+                                                      rate_no_limit, max_share, nb_clusters, compact, cnst2, var2);
+    Sys2->set_solve_components(true, 1);
+    date_seq = xbt_os_time() * 1000000;
+    Sys2->solve();
+    date_seq = xbt_os_time() * 1000000 - date_seq;
+
+    for (int i = 0; i < nb_var; i++)
+      xbt_assert(var[i]->get_value() == var2[i]->get_value(),
+                 "Variable %d differs between the sequential (%.17g) and parallel (%.17g) solvers", i,
+                 var2[i]->get_value(), var[i]->get_value());
+    for (int i = 0; i < nb_var; i++)
+      Sys2->variable_free(var2[i]);
+    delete Sys2;
+  }
+
+  if (mode == 3) {
+    /* Solve the very same system with the other backend, to compare them */
+    std::vector<simgrid::kernel::lmm::Constraint*> cnst3;
+    std::vector<simgrid::kernel::lmm::Variable*> var3;
+    seedx = seed;
+    simgrid::kernel::lmm::System* Sys3 = build_system(nb_cnst, nb_var, nb_elem, pw_base_limit, pw_max_limit,
+                                                      rate_no_limit, max_share, nb_clusters, not compact, cnst3, var3);
+    date_other = xbt_os_time() * 1000000;
+    Sys3->solve();
+    date_other = xbt_os_time() * 1000000 - date_other;
+
+    // Both backends saturate the constraints in the same order, and so do the components
+    for (int i = 0; i < nb_var; i++)
+      xbt_assert(var[i]->get_value() == var3[i]->get_value(),
+                 "Variable %d differs between the default (%.17g) and compact (%.17g) backends", i,
+                 (compact ? var3 : var)[i]->get_value(), (compact ? var : var3)[i]->get_value());
+
+    /* Split the time of the compact backend between the update of its arrays and the saturation, then solve it again
+     * after disabling a variable: only the rows of the constraints of that variable have to be updated */
+    simgrid::kernel::lmm::System* compact_sys = compact ? Sys : Sys3;
+    const simgrid::kernel::lmm::SolverStatistics& stats = compact_sys->get_statistics();
+    date_conversion[0] = stats.conversion_time * 1000000;
+    date_saturation[0] = (stats.solve_time - stats.conversion_time) * 1000000;
+    compact_sys->update_variable_penalty((compact ? var : var3)[0], 0);
+    compact_sys->solve();
+    date_conversion[1] = stats.conversion_time * 1000000 - date_conversion[0];
+    date_saturation[1] = (stats.solve_time - stats.conversion_time) * 1000000 - date_saturation[0];
+
+    for (int i = 0; i < nb_var; i++)
+      Sys3->variable_free(var3[i]);
+    delete Sys3;
+  }
+
   if(mode==2){
     fprintf(stderr,"Max concurrency:\n");
     int l=0;
@@ -102,8 +201,41 @@ static void test(int nb_cnst, int nb_var, int nb_elem, unsigned int pw_base_limi
     Sys->print();
   }
 
+  if (mode == 3 && sg_maxmin_components && not compact) {
+    /* Solve the very same system in one piece: splitting it into components must not change a single bit, neither
+     * before nor after removing half of the variables (which splits the components again) */
+    std::vector<simgrid::kernel::lmm::Constraint*> cnst4;
+    std::vector<simgrid::kernel::lmm::Variable*> var4;
+    seedx = seed;
+    simgrid::kernel::lmm::System* Sys4 = build_system(nb_cnst, nb_var, nb_elem, pw_base_limit, pw_max_limit,
+                                                      rate_no_limit, max_share, nb_clusters, compact, cnst4, var4);
+    Sys4->set_solve_components(false);
+    Sys4->solve();
+    for (int i = 0; i < nb_var; i++)
+      xbt_assert(var[i]->get_value() == var4[i]->get_value(),
+                 "Variable %d differs between the monolithic (%.17g) and component (%.17g) solvers", i,
+                 var4[i]->get_value(), var[i]->get_value());
+
+    for (int i = 0; i < nb_var; i += 2) {
+      Sys->variable_free(var[i]);
+      Sys4->variable_free(var4[i]);
+      var[i] = nullptr;
+    }
+    Sys->solve();
+    Sys4->solve();
+    for (int i = 1; i < nb_var; i += 2)
+      xbt_assert(var[i]->get_value() == var4[i]->get_value(),
+                 "Variable %d differs between the monolithic (%.17g) and component (%.17g) solvers after removals", i,
+                 var4[i]->get_value(), var[i]->get_value());
+
+    for (int i = 1; i < nb_var; i += 2)
+      Sys4->variable_free(var4[i]);
+    delete Sys4;
+  }
+
   for (int i = 0; i < nb_var; i++)
-    Sys->variable_free(var[i]);
+    if (var[i])
+      Sys->variable_free(var[i]);
   delete Sys;
 }
 
@@ -112,7 +244,8 @@ unsigned int TestClasses [][4]=
   {{  10  ,10    ,1        ,2 }, //small
    {  100 ,100   ,3        ,6 }, //medium
    {  2000,2000  ,5        ,8 }, //big
-   { 20000,20000 ,7        ,10}  //huge
+   { 20000,20000 ,7        ,10}, //huge
+   {100000,100000,1        ,2 }  //sparse: many constraints with few elements each, needing many saturation rounds
   };
 
 int main(int argc, char **argv)
@@ -122,10 +255,19 @@ int main(int argc, char **argv)
   float rate_no_limit=0.2;
   float acc_date=0;
   float acc_date2=0;
+  float acc_date_seq    = 0;
+  float acc_date_seq2   = 0;
+  float acc_date_other  = 0;
+  float acc_date_other2 = 0;
+  float acc_conversion[2] = {0, 0};
+  float acc_saturation[2] = {0, 0};
   int testclass;
 
   if(argc<3) {
-    fprintf(stderr, "Syntax: <small|medium|big|huge> <count> [test|debug|perf]\n");
+    fprintf(stderr, "Syntax: <small|medium|big|huge|sparse> <count> [test|debug|perf] [clusters]\n"
+                    "  In perf mode, the default and compact backends are compared (see --cfg=maxmin/backend).\n"
+                    "  Pass --cfg=maxmin/components:yes --cfg=maxmin/threads:N in perf mode to compare the parallel and"
+                    " sequential component solvers.\n");
     return -1;
   }
 
@@ -138,6 +280,8 @@ int main(int argc, char **argv)
     testclass = 2;
   else if (not strcmp(argv[1], "huge"))
     testclass = 3;
+  else if (not strcmp(argv[1], "sparse"))
+    testclass = 4;
   else {
     fprintf(stderr, "Unknown class \"%s\", aborting!\n",argv[1]);
     return -2;
@@ -155,6 +299,12 @@ int main(int argc, char **argv)
   if(argc>=4 && strcmp(argv[3],"perf")==0)
     mode=3;
 
+  //How many independent clusters of constraints?
+  int nb_clusters = 1;
+  if (argc >= 5)
+    nb_clusters = atoi(argv[4]);
+  xbt_assert(nb_clusters > 0, "The amount of clusters should be positive");
+
   if(mode==1)
     xbt_log_control_set("surf/maxmin.threshold:DEBUG surf/maxmin.fmt:\'[%r]: [%c/%p] %m%n\' "
                         "surf.threshold:DEBUG surf.fmt:\'[%r]: [%c/%p] %m%n\' ");
@@ -167,6 +317,10 @@ int main(int argc, char **argv)
   unsigned int pw_base_limit= TestClasses[testclass][2];
   unsigned int pw_max_limit= TestClasses[testclass][3];
   unsigned int max_share    = 2; // 1<<(pw_base_limit/2+1)
+  if (static_cast<unsigned>(nb_clusters) > nb_cnst) { // Each cluster needs at least one constraint
+    fprintf(stderr, "Cannot make %d clusters of the %u constraints of this class, aborting!\n", nb_clusters, nb_cnst);
+    return -2;
+  }
 
   //If you want to test concurrency, you need nb_elem >> 2^pw_base_limit:
   unsigned int nb_elem= (1<<pw_base_limit)+(1<<(8*pw_max_limit/10));
@@ -176,9 +330,17 @@ int main(int argc, char **argv)
   for(int i=0;i<testcount;i++){
     seedx=i+1;
     fprintf(stderr, "Starting %i: (%i)\n",i,myrand()%1000);
-    test(nb_cnst, nb_var, nb_elem, pw_base_limit, pw_max_limit, rate_no_limit,max_share,mode);
+    test(nb_cnst, nb_var, nb_elem, pw_base_limit, pw_max_limit, rate_no_limit, max_share, mode, nb_clusters);
     acc_date+=date;
     acc_date2+=date*date;
+    acc_date_seq += date_seq;
+    acc_date_seq2 += date_seq * date_seq;
+    acc_date_other += date_other;
+    acc_date_other2 += date_other * date_other;
+    for (int j = 0; j < 2; j++) {
+      acc_conversion[j] += date_conversion[j];
+      acc_saturation[j] += date_saturation[j];
+    }
   }
 
   float mean_date= acc_date/(float)testcount;
@@ -188,8 +350,28 @@ int main(int argc, char **argv)
                   "%u variables with %u active constraint each, concurrency in [%i,%i] and max concurrency share %u\n",
           testcount, nb_cnst, nb_var, nb_elem, (1 << pw_base_limit), (1 << pw_base_limit) + (1 << pw_max_limit),
           max_share);
-  if(mode==3)
+  if(mode==3) {
     fprintf(stderr, "Execution time: %g +- %g  microseconds \n",mean_date, stdev_date);
 
+    float mean_date_other  = acc_date_other / (float)testcount;
+    float stdev_date_other = sqrt(acc_date_other2 / (float)testcount - mean_date_other * mean_date_other);
+    bool compact           = simgrid::config::get_value<std::string>("maxmin/backend") == "compact";
+    fprintf(stderr, "Execution time with the %s backend: %g +- %g  microseconds (ratio: %.2f)\n",
+            compact ? "default" : "compact", mean_date_other, stdev_date_other, mean_date_other / mean_date);
+    fprintf(stderr,
+            "Compact backend: %g microseconds to update its arrays and %g to saturate, then %g and %g after disabling "
+            "a variable\n",
+            acc_conversion[0] / testcount, acc_saturation[0] / testcount, acc_conversion[1] / testcount,
+            acc_saturation[1] / testcount);
+  }
+
+  if (mode == 3 && sg_maxmin_components && sg_maxmin_threads > 1 &&
+      simgrid::config::get_value<std::string>("maxmin/backend") != "compact") {
+    float mean_date_seq  = acc_date_seq / (float)testcount;
+    float stdev_date_seq = sqrt(acc_date_seq2 / (float)testcount - mean_date_seq * mean_date_seq);
+    fprintf(stderr, "Sequential execution time: %g +- %g  microseconds (speedup with %d threads on %d clusters: %.2f)\n",
+            mean_date_seq, stdev_date_seq, sg_maxmin_threads, nb_clusters, mean_date_seq / mean_date);
+  }
+
   return 0;
 }
@@ -0,0 +1,430 @@
+/* Benchmark suite of the maxmin solvers, with a regression check against a baseline */
+
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+#include "simgrid/s4u/Engine.hpp"
+#include "src/kernel/lmm/maxmin.hpp"
+#include "xbt/xbt_os_time.h"
+
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace lmm = simgrid::kernel::lmm;
+
+/* Fills a system with links (constraints) and flows (variables), and counts what it creates */
+class Builder {
+public:
+  Builder(lmm::System* sys, unsigned seed) : sys_(sys), rng_(seed) {}
+
+  /* std::mt19937 produces the same sequence everywhere, while the standard distributions do not */
+  unsigned random(unsigned max) { return rng_() % max; }
+  double uniform(double min, double max) { return min + (max - min) * (rng_() / 4294967296.0); }
+
+  lmm::Constraint* link(double bound, bool fatpipe = false, int concurrency_limit = -1)
+  {
+    lmm::Constraint* cnst = sys_->constraint_new(nullptr, bound);
+    if (fatpipe)
+      cnst->unshare();
+    cnst->set_concurrency_limit(concurrency_limit);
+    constraints++;
+    return cnst;
+  }
+
+  /* A flow using every link of the route, bounded one time out of ten and with a higher penalty one time out of four */
+  void flow(const std::vector<lmm::Constraint*>& route)
+  {
+    double penalty     = random(4) == 0 ? 2.0 : 1.0;
+    double bound       = random(10) == 0 ? uniform(1e6, 1e8) : -1.0;
+    lmm::Variable* var = sys_->variable_new(nullptr, penalty, bound, route.size());
+    for (lmm::Constraint* cnst : route)
+      sys_->expand(cnst, var, 1.0);
+    variables++;
+    elements += route.size();
+  }
+
+  size_t constraints = 0;
+  size_t variables   = 0;
+  size_t elements    = 0;
+
+private:
+  lmm::System* sys_;
+  std::mt19937 rng_;
+};
+
+static constexpr double host_bandwidth = 1.25e8;
+
+/* Hosts attached to a single backbone, much thinner than the sum of their links: the backbone is the hot spot */
+static void build_star(Builder& b, int nb_flows)
+{
+  int nb_hosts = std::max(2, nb_flows / 10);
+  std::vector<lmm::Constraint*> up;
+  std::vector<lmm::Constraint*> down;
+  for (int i = 0; i < nb_hosts; i++) {
+    up.push_back(b.link(b.uniform(0.5, 1.5) * host_bandwidth));
+    down.push_back(b.link(b.uniform(0.5, 1.5) * host_bandwidth));
+  }
+  lmm::Constraint* backbone = b.link(host_bandwidth * nb_hosts / 20);
+  for (int i = 0; i < nb_flows; i++) {
+    int src = b.random(nb_hosts);
+    int dst = (src + 1 + b.random(nb_hosts - 1)) % nb_hosts;
+    b.flow({up[src], backbone, down[dst]});
+  }
+}
+
+/* Every host sends to every other one through a crossbar */
+static void build_alltoall(Builder& b, int nb_flows)
+{
+  int nb_hosts = 2;
+  while (nb_hosts * (nb_hosts - 1) < nb_flows)
+    nb_hosts++;
+  std::vector<lmm::Constraint*> up;
+  std::vector<lmm::Constraint*> down;
+  for (int i = 0; i < nb_hosts; i++) {
+    up.push_back(b.link(b.uniform(0.5, 1.5) * host_bandwidth));
+    down.push_back(b.link(b.uniform(0.5, 1.5) * host_bandwidth));
+  }
+  int created = 0;
+  for (int src = 0; src < nb_hosts && created < nb_flows; src++)
+    for (int dst = 0; dst < nb_hosts && created < nb_flows; dst++)
+      if (src != dst) {
+        b.flow({up[src], down[dst]});
+        created++;
+      }
+}
+
+/* A k-ary fat-tree (k pods of k/2 edge and k/2 aggregation switches, (k/2)^2 core switches), 2:1 oversubscribed, with
+ * about 8 flows per host routed through a random aggregation and core switch */
+static void build_fattree(Builder& b, int nb_flows)
+{
+  int k = 2;
+  while (k * k * k / 4 < nb_flows / 8)
+    k += 2;
+  int half                = k / 2;
+  int nb_hosts            = k * k * k / 4;
+  double fabric_bandwidth = host_bandwidth * half / 2;
+
+  std::vector<lmm::Constraint*> host_up;
+  std::vector<lmm::Constraint*> host_down;
+  for (int i = 0; i < nb_hosts; i++) {
+    host_up.push_back(b.link(host_bandwidth));
+    host_down.push_back(b.link(host_bandwidth));
+  }
+  /* Indexed by [pod][edge][aggregation], and by [pod][aggregation][core] */
+  std::vector<lmm::Constraint*> edge_up;
+  std::vector<lmm::Constraint*> edge_down;
+  std::vector<lmm::Constraint*> aggr_up;
+  std::vector<lmm::Constraint*> aggr_down;
+  for (int i = 0; i < k * half * half; i++) {
+    edge_up.push_back(b.link(fabric_bandwidth));
+    edge_down.push_back(b.link(fabric_bandwidth));
+    aggr_up.push_back(b.link(fabric_bandwidth));
+    aggr_down.push_back(b.link(fabric_bandwidth));
+  }
+
+  for (int i = 0; i < nb_flows; i++) {
+    int src      = b.random(nb_hosts);
+    int dst      = (src + 1 + b.random(nb_hosts - 1)) % nb_hosts;
+    int src_edge = src / half; // global edge switch index: pod * half + local index
+    int dst_edge = dst / half;
+    int src_pod  = src_edge / half;
+    int dst_pod  = dst_edge / half;
+    std::vector<lmm::Constraint*> route{host_up[src]};
+    if (src_edge != dst_edge) {
+      int aggr = b.random(half);
+      route.push_back(edge_up[src_edge * half + aggr]);
+      if (src_pod != dst_pod) {
+        int core = b.random(half);
+        route.push_back(aggr_up[(src_pod * half + aggr) * half + core]);
+        route.push_back(aggr_down[(dst_pod * half + aggr) * half + core]);
+      }
+      route.push_back(edge_down[dst_edge * half + aggr]);
+    }
+    route.push_back(host_down[dst]);
+    b.flow(route);
+  }
+}
+
+/* A star where the links of the hosts only accept a few flows at once: the other flows get staged */
+static void build_concurrency(Builder& b, int nb_flows)
+{
+  int nb_hosts = std::max(2, nb_flows / 10);
+  std::vector<lmm::Constraint*> up;
+  std::vector<lmm::Constraint*> down;
+  for (int i = 0; i < nb_hosts; i++) {
+    up.push_back(b.link(host_bandwidth, false, 4 + b.random(12)));
+    down.push_back(b.link(host_bandwidth, false, 4 + b.random(12)));
+  }
+  lmm::Constraint* backbone = b.link(host_bandwidth * nb_hosts / 20);
+  for (int i = 0; i < nb_flows; i++) {
+    int src = b.random(nb_hosts);
+    int dst = (src + 1 + b.random(nb_hosts - 1)) % nb_hosts;
+    b.flow({up[src], backbone, down[dst]});
+  }
+}
+
+/* A star with a FATPIPE backbone, where a third of the host links are FATPIPE too */
+static void build_fatpipe(Builder& b, int nb_flows)
+{
+  int nb_hosts = std::max(2, nb_flows / 10);
+  std::vector<lmm::Constraint*> up;
+  std::vector<lmm::Constraint*> down;
+  for (int i = 0; i < nb_hosts; i++) {
+    up.push_back(b.link(b.uniform(0.5, 1.5) * host_bandwidth, b.random(3) == 0));
+    down.push_back(b.link(b.uniform(0.5, 1.5) * host_bandwidth, b.random(3) == 0));
+  }
+  lmm::Constraint* backbone = b.link(host_bandwidth / 4, true);
+  for (int i = 0; i < nb_flows; i++) {
+    int src = b.random(nb_hosts);
+    int dst = (src + 1 + b.random(nb_hosts - 1)) % nb_hosts;
+    b.flow({up[src], backbone, down[dst]});
+  }
+}
+
+static const std::map<std::string, std::function<void(Builder&, int)>> families = {
+    {"star", build_star},
+    {"alltoall", build_alltoall},
+    {"fattree", build_fattree},
+    {"concurrency", build_concurrency},
+    {"fatpipe", build_fatpipe}};
+
+static const std::map<std::string, std::function<lmm::System*()>> backends = {
+    {"maxmin", []() { return new lmm::System(false); }},
+    {"compact", []() { return new lmm::CompactSystem(false); }},
+    {"bottleneck", []() { return new lmm::FairBottleneck(false); }}};
+
+struct Result {
+  std::string family;
+  std::string backend;
+  int size = 0;
+  size_t constraints = 0;
+  size_t variables   = 0;
+  size_t elements    = 0;
+  double solve_time  = -1; // best of the repetitions, -1 when not measured
+  unsigned long long rounds           = 0;
+  unsigned long long elements_visited = 0;
+};
+
+static Result run_one(const std::string& family, const std::string& backend, int size, int repeat)
+{
+  Result res;
+  res.family  = family;
+  res.backend = backend;
+  res.size    = size;
+  for (int i = 0; i < repeat; i++) {
+    std::unique_ptr<lmm::System> sys(backends.at(backend)());
+    Builder builder(sys.get(), 42); // Same system at each repetition, and for each backend
+    families.at(family)(builder, size);
+    double start = xbt_os_time();
+    sys->solve();
+    double elapsed = xbt_os_time() - start;
+    if (res.solve_time < 0 || elapsed < res.solve_time)
+      res.solve_time = elapsed;
+    res.constraints      = builder.constraints;
+    res.variables        = builder.variables;
+    res.elements         = builder.elements;
+    res.rounds           = sys->get_statistics().rounds;
+    res.elements_visited = sys->get_statistics().elements_visited;
+    sys->variable_free_all();
+  }
+  return res;
+}
+
+static void write_json(FILE* out, const std::vector<Result>& results, bool with_time)
+{
+  fprintf(out, "{\n  \"benchmarks\": [");
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result& r = results[i];
+    fprintf(out, "%s\n    {\"family\": \"%s\", \"backend\": \"%s\", \"size\": %d, \"constraints\": %zu, ",
+            i == 0 ? "" : ",", r.family.c_str(), r.backend.c_str(), r.size, r.constraints);
+    fprintf(out, "\"variables\": %zu, \"elements\": %zu, \"rounds\": %llu, \"elements_visited\": %llu", r.variables,
+            r.elements, r.rounds, r.elements_visited);
+    if (with_time)
+      fprintf(out, ", \"solve_time\": %.9f", r.solve_time);
+    fprintf(out, "}");
+  }
+  fprintf(out, "\n  ]\n}\n");
+}
+
+static std::vector<Result> read_json(const std::string& filename)
+{
+  boost::property_tree::ptree tree;
+  boost::property_tree::read_json(filename, tree);
+  std::vector<Result> results;
+  for (auto const& node : tree.get_child("benchmarks")) {
+    const boost::property_tree::ptree& bench = node.second;
+    Result r;
+    r.family           = bench.get<std::string>("family");
+    r.backend          = bench.get<std::string>("backend");
+    r.size             = bench.get<int>("size");
+    r.rounds           = bench.get<unsigned long long>("rounds");
+    r.elements_visited = bench.get<unsigned long long>("elements_visited");
+    r.solve_time       = bench.get<double>("solve_time", -1.0);
+    results.push_back(r);
+  }
+  return results;
+}
+
+static bool verbose = false;
+
+/* Returns whether current is within threshold of baseline (or too small to be compared) */
+static bool check(const char* metric, const Result& r, double baseline, double current, double min_value,
+                  double threshold)
+{
+  if (baseline < min_value || current < 0)
+    return true;
+  double change = (current - baseline) / baseline;
+  bool ok       = change <= threshold;
+  if (ok && not verbose)
+    return true;
+  printf("%-12s %-10s %8d  %-16s %14.6g %14.6g %+8.1f%%  %s\n", r.family.c_str(), r.backend.c_str(), r.size, metric,
+         baseline, current, 100 * change, ok ? "ok" : "REGRESSION");
+  return ok;
+}
+
+static int compare(const std::string& baseline_file, const std::string& current_file, double threshold,
+                   double min_time)
+{
+  std::vector<Result> baseline = read_json(baseline_file);
+  std::vector<Result> current  = read_json(current_file);
+  int regressions = 0;
+  int compared    = 0;
+  for (Result const& r : current) {
+    auto base = std::find_if(baseline.begin(), baseline.end(), [&r](Result const& b) {
+      return b.family == r.family && b.backend == r.backend && b.size == r.size;
+    });
+    if (base == baseline.end()) {
+      printf("%-12s %-10s %8d  not in the baseline\n", r.family.c_str(), r.backend.c_str(), r.size);
+      continue;
+    }
+    compared++;
+    bool ok = check("rounds", r, base->rounds, r.rounds, 1, threshold);
+    ok      = check("elements_visited", r, base->elements_visited, r.elements_visited, 1, threshold) && ok;
+    ok      = check("solve_time", r, base->solve_time, r.solve_time, min_time, threshold) && ok;
+    if (not ok)
+      regressions++;
+  }
+  printf("%d benchmark(s) compared, %d regression(s) beyond %+.1f%%\n", compared, regressions, 100 * threshold);
+  return regressions > 0 ? 1 : 0;
+}
+
+static std::vector<std::string> split_list(const std::string& list)
+{
+  std::vector<std::string> res;
+  boost::split(res, list, boost::is_any_of(","), boost::token_compress_on);
+  return res;
+}
+
+static int usage(const char* name)
+{
+  fprintf(stderr,
+          "Usage: %s run [--families f1,f2] [--backends b1,b2] [--sizes n1,n2] [--repeat n] [--no-time] [--output "
+          "file]\n"
+          "       %s compare <baseline.json> <current.json> [--threshold ratio] [--min-time seconds] [--verbose]\n"
+          "  Families: alltoall, concurrency, fatpipe, fattree, star (default: all)\n"
+          "  Backends: bottleneck, compact, maxmin (default: maxmin,bottleneck)\n"
+          "  Sizes are amounts of variables (default: 100,1000,10000; up to 1e6 works)\n"
+          "  The compare mode fails when the rounds, the visited elements or the solve time of a benchmark exceed the\n"
+          "  baseline by more than the threshold (default: 0.1). Times below --min-time (default: 1e-3) are ignored.\n"
+          "  Only the regressions are listed, unless --verbose is given.\n",
+          name, name);
+  return 2;
+}
+
+int main(int argc, char** argv)
+{
+  simgrid::s4u::Engine e(&argc, argv);
+
+  if (argc < 2)
+    return usage(argv[0]);
+
+  if (not strcmp(argv[1], "compare")) {
+    if (argc < 4)
+      return usage(argv[0]);
+    double threshold = 0.1;
+    double min_time  = 1e-3;
+    for (int i = 4; i < argc; i++) {
+      if (not strcmp(argv[i], "--threshold") && i + 1 < argc)
+        threshold = std::stod(argv[++i]);
+      else if (not strcmp(argv[i], "--min-time") && i + 1 < argc)
+        min_time = std::stod(argv[++i]);
+      else if (not strcmp(argv[i], "--verbose"))
+        verbose = true;
+      else
+        return usage(argv[0]);
+    }
+    return compare(argv[2], argv[3], threshold, min_time);
+  }
+
+  if (strcmp(argv[1], "run"))
+    return usage(argv[0]);
+
+  std::vector<std::string> family_list;
+  for (auto const& kv : families)
+    family_list.push_back(kv.first);
+  std::vector<std::string> backend_list = {"maxmin", "bottleneck"};
+  std::vector<int> sizes                = {100, 1000, 10000};
+  int repeat                            = 3;
+  bool with_time                        = true;
+  std::string output;
+  for (int i = 2; i < argc; i++) {
+    if (not strcmp(argv[i], "--families") && i + 1 < argc) {
+      family_list = split_list(argv[++i]);
+    } else if (not strcmp(argv[i], "--backends") && i + 1 < argc) {
+      backend_list = split_list(argv[++i]);
+    } else if (not strcmp(argv[i], "--sizes") && i + 1 < argc) {
+      sizes.clear();
+      for (std::string const& size : split_list(argv[++i]))
+        sizes.push_back(static_cast<int>(std::stod(size)));
+    } else if (not strcmp(argv[i], "--repeat") && i + 1 < argc) {
+      repeat = std::max(1, atoi(argv[++i]));
+    } else if (not strcmp(argv[i], "--no-time")) {
+      with_time = false;
+      repeat    = 1;
+    } else if (not strcmp(argv[i], "--output") && i + 1 < argc) {
+      output = argv[++i];
+    } else {
+      return usage(argv[0]);
+    }
+  }
+  for (std::string const& family : family_list)
+    if (families.find(family) == families.end()) {
+      fprintf(stderr, "Unknown family '%s'\n", family.c_str());
+      return usage(argv[0]);
+    }
+  for (std::string const& backend : backend_list)
+    if (backends.find(backend) == backends.end()) {
+      fprintf(stderr, "Unknown backend '%s'\n", backend.c_str());
+      return usage(argv[0]);
+    }
+
+  std::vector<Result> results;
+  for (std::string const& family : family_list)
+    for (int size : sizes)
+      for (std::string const& backend : backend_list)
+        results.push_back(run_one(family, backend, size, repeat));
+
+  FILE* out = output.empty() ? stdout : fopen(output.c_str(), "w");
+  if (out == nullptr) {
+    fprintf(stderr, "Cannot open '%s' for writing\n", output.c_str());
+    return 1;
+  }
+  write_json(out, results, with_time);
+  if (out != stdout)
+    fclose(out);
+  return 0;
+}
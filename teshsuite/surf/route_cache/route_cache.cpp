@@ -0,0 +1,76 @@
+/* Checks that the routes kept in the route cache of the engine give the same communication times */
+
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+/* A sender exchanges messages with a few hosts, and changes the latency of one of the links halfway. The route cache
+ * must not change the communication times, and is flushed on that change of latency. By default, the exchanges take
+ * place on small_platform.xml; the link, the sender and its peers can be given on the command line for other
+ * platforms. */
+
+#include "simgrid/kernel/resource/Model.hpp"
+#include "simgrid/kernel/routing/NetZoneImpl.hpp"
+#include "simgrid/s4u.hpp"
+#include "src/kernel/routing/RouteMemo.hpp"
+#include "src/surf/network_interface.hpp"
+
+#include <string>
+#include <vector>
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(route_cache, "Messages specific for this test");
+
+static std::string modified_link      = "9";
+static std::string sender_host        = "Tremblay";
+static std::vector<std::string> peers = {"Jupiter", "Fafard", "Ginette", "Tremblay"};
+static const int nb_rounds            = 10;
+
+static void receiver()
+{
+  simgrid::s4u::Mailbox* mailbox = simgrid::s4u::Mailbox::by_name(simgrid::s4u::this_actor::get_host()->get_name());
+  for (int i = 0; i < nb_rounds; i++)
+    mailbox->get();
+}
+
+static void sender()
+{
+  static int payload = 42;
+  for (int i = 0; i < nb_rounds; i++) {
+    for (std::string const& peer : peers) {
+      double start = simgrid::s4u::Engine::get_clock();
+      simgrid::s4u::Mailbox::by_name(peer)->put(&payload, 1e5);
+      XBT_DEBUG("Sent to %s in %f", peer.c_str(), simgrid::s4u::Engine::get_clock() - start);
+    }
+    XBT_INFO("Round %d done", i);
+    if (i == nb_rounds / 2 - 1) {
+      XBT_INFO("Multiply the latency of link %s by 10", modified_link.c_str());
+      simgrid::kernel::resource::LinkImpl* link = simgrid::s4u::Link::by_name(modified_link)->get_impl();
+      simgrid::kernel::actor::simcall([link] { link->set_latency(10 * link->get_latency()); });
+    }
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  simgrid::s4u::Engine e(&argc, argv);
+  xbt_assert(argc == 2 || argc >= 5, "Usage: %s platform_file [link sender peer...]\n", argv[0]);
+  e.load_platform(argv[1]);
+  if (argc >= 5) {
+    modified_link = argv[2];
+    sender_host   = argv[3];
+    peers.assign(argv + 4, argv + argc);
+  }
+
+  simgrid::s4u::Actor::create("sender", simgrid::s4u::Host::by_name(sender_host), sender);
+  for (std::string const& peer : peers)
+    simgrid::s4u::Actor::create("receiver", simgrid::s4u::Host::by_name(peer), receiver);
+  e.run();
+
+  for (simgrid::kernel::resource::ModelStatistics const& stats : e.get_model_statistics())
+    if (stats.name.find("Network") != std::string::npos)
+      XBT_INFO("%s: %llu route cache hits, %llu misses", stats.name.c_str(), stats.route_cache_hits,
+               stats.route_cache_misses);
+  XBT_INFO("Route cache: %zu routes", simgrid::kernel::routing::NetZoneImpl::get_route_memo().get_size());
+  return 0;
+}
@@ -281,6 +281,7 @@ set(XBT_SRC
   src/xbt/memory_map.hpp
   src/xbt/OsSemaphore.hpp
   src/xbt/parmap.cpp
+  src/xbt/slab_arena.cpp
   src/xbt/snprintf.c
   src/xbt/string.cpp
   src/xbt/xbt_log_appender_file.cpp
@@ -306,6 +307,7 @@ set(NS3_SRC  src/surf/network_ns3.cpp
              src/surf/ns3/ns3_simulator.cpp )
 
 set(SURF_SRC
+  src/kernel/lmm/compact_system.cpp
   src/kernel/lmm/fair_bottleneck.cpp
   src/kernel/lmm/maxmin.hpp
   src/kernel/lmm/maxmin.cpp
@@ -333,6 +335,10 @@ set(SURF_SRC
   src/kernel/routing/NetZoneImpl.cpp
   src/kernel/routing/TorusZone.cpp
   src/kernel/routing/RoutedZone.cpp
+  src/kernel/routing/RouteMemo.cpp
+  src/kernel/routing/RouteMemo.hpp
+  src/kernel/routing/RouteStore.cpp
+  src/kernel/routing/RouteStore.hpp
   src/kernel/routing/VivaldiZone.cpp
 
   src/kernel/EngineImpl.cpp
@@ -773,6 +779,7 @@ set(headers_to_install
   include/xbt/replay.hpp
   include/xbt/RngStream.h
   include/xbt/signal.hpp
+  include/xbt/slab_arena.hpp
   include/xbt/str.h
   include/xbt/string.hpp
   include/xbt/synchro.h
@@ -1040,6 +1047,7 @@ set(CMAKEFILES_TXT
 
   tools/CMakeLists.txt
   tools/graphicator/CMakeLists.txt
+  tools/profile-converter/CMakeLists.txt
   tools/tesh/CMakeLists.txt
   )
 
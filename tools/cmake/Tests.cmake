@@ -102,9 +102,12 @@ ENDIF()
 # New tests should use the Catch Framework
 set(UNIT_TESTS  src/xbt/unit-tests_main.cpp
                 src/kernel/resource/profile/Profile_test.cpp
+                src/kernel/routing/RouteStore_test.cpp
+                src/surf/cpu_ti_test.cpp
                 src/xbt/config_test.cpp
                 src/xbt/dict_test.cpp
                 src/xbt/dynar_test.cpp
+                src/xbt/slab_arena_test.cpp
                 src/xbt/xbt_str_test.cpp
 		src/kernel/lmm/maxmin_test.cpp)
 if (SIMGRID_HAVE_MC)
@@ -0,0 +1,51 @@
+/* Copyright (c) 2019. The SimGrid Team. All rights reserved.               */
+
+/* This program is free software; you can redistribute it and/or modify it
+ * under the terms of the license (GNU LGPL) which comes with this package. */
+
+/* Converts the textual profiles (availability_file, speed_file, ...) into the binary format, that the simulators map in
+ * memory instead of parsing it. Both formats can be given wherever a profile file is expected.
+ *
+ *   simgrid-profile-converter input.profile output.bin   converts a profile (textual or binary) to the binary format
+ *   simgrid-profile-converter --dump input               prints a profile (textual or binary) in the textual format
+ */
+
+#include "simgrid/s4u/Engine.hpp"
+#include "src/kernel/resource/profile/Profile.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(profile_converter, "Profile converter");
+
+/* The profiles store the delay to the next value, the first one holding the date of the first value */
+static void dump(const simgrid::kernel::profile::Profile* profile)
+{
+  double date = profile->at(0).date_;
+  for (std::size_t i = 1; i < profile->size(); i++) {
+    simgrid::kernel::profile::DatedValue val = profile->at(i);
+    printf("%.15g %.15g\n", date, val.value_);
+    if (i == profile->size() - 1 && val.date_ > 0)
+      printf("LOOPAFTER %.15g\n", val.date_ - profile->at(0).date_);
+    date += val.date_;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  simgrid::s4u::Engine e(&argc, argv);
+
+  bool dump_only = argc == 3 && not strcmp(argv[1], "--dump");
+  xbt_assert(argc == 3, "Usage: %s <input_profile> <output_binary_profile>\n       %s --dump <input_profile>", argv[0],
+             argv[0]);
+
+  const char* input                                = dump_only ? argv[2] : argv[1];
+  const simgrid::kernel::profile::Profile* profile = simgrid::kernel::profile::Profile::from_file(input);
+  if (dump_only) {
+    dump(profile);
+  } else {
+    profile->save_binary(argv[2]);
+    XBT_INFO("%zu values written to %s", profile->size() - 1, argv[2]);
+  }
+  return 0;
+}